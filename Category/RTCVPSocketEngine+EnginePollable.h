@@ -17,4 +17,10 @@
 - (void) disconnectPolling;
 - (void) flushWaitingForPost;
 - (void)sendPollMessage:(NSString *)message withType:(RTCVPSocketEnginePacketType)type withData:(NSArray *)array;
+/// 发送已编码的 Engine.IO 帧（UTF-8 字节，含类型前缀）
+- (void)sendPollEncodedMessage:(NSData *)message withData:(NSArray *)array;
+/// 发送二进制 Engine.IO message（轮询负载中以 base64 编码）
+- (void)sendPollBinaryMessage:(NSData *)message;
+/// 批量发送：帧按顺序放进 postWait 后立即发出，不再等合并窗口（超过 maxPollingPayloadSize 时拆分）
+- (void)sendPollFrames:(NSArray *)frames;
 @end
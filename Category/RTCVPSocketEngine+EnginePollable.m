@@ -8,7 +8,7 @@
 
 #import "RTCVPSocketEngine+EnginePollable.h"
 #import "RTCVPSocketEngine+Private.h"
-#import "RTCVPStringReader.h"
+#import "RTCVPPollingPayloadDecoder.h"
 #import "NSString+RTCVPSocketIO.h"
 #import "RTCVPSocketEngine+EngineWebsocket.h"
 #import "NSString+Random.h"
@@ -16,6 +16,78 @@
 
 typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* response, NSError* error);
 
+/// UTF-8 字节对应的 UTF-16 长度（EIO3 轮询的长度前缀按 JS 字符串长度计算）
+static NSUInteger RTCVPUTF16LengthOfUTF8Data(NSData *data) {
+    const uint8_t *bytes = (const uint8_t *)data.bytes;
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < data.length; i++) {
+        uint8_t byte = bytes[i];
+        if ((byte & 0xC0) != 0x80) {
+            count++; // 每个非续字节开始一个码点
+        }
+        if ((byte & 0xF8) == 0xF0) {
+            count++; // 4 字节序列在 UTF-16 中占一对代理项
+        }
+    }
+    return count;
+}
+
+/// base64 直接编码到 POST 体末尾，不生成中间对象
+static void RTCVPAppendBase64(NSMutableData *buffer, NSData *data) {
+    static const char kBase64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const uint8_t *in = (const uint8_t *)data.bytes;
+    NSUInteger inLength = data.length;
+    NSUInteger start = buffer.length;
+    [buffer increaseLengthBy:(inLength + 2) / 3 * 4];
+    uint8_t *out = (uint8_t *)buffer.mutableBytes + start;
+    
+    NSUInteger i = 0;
+    for (; i + 2 < inLength; i += 3) {
+        uint32_t value = ((uint32_t)in[i] << 16) | ((uint32_t)in[i + 1] << 8) | in[i + 2];
+        *out++ = kBase64Chars[(value >> 18) & 0x3F];
+        *out++ = kBase64Chars[(value >> 12) & 0x3F];
+        *out++ = kBase64Chars[(value >> 6) & 0x3F];
+        *out++ = kBase64Chars[value & 0x3F];
+    }
+    if (i < inLength) {
+        BOOL hasSecond = (i + 1 < inLength);
+        uint32_t value = ((uint32_t)in[i] << 16) | (hasSecond ? ((uint32_t)in[i + 1] << 8) : 0);
+        *out++ = kBase64Chars[(value >> 18) & 0x3F];
+        *out++ = kBase64Chars[(value >> 12) & 0x3F];
+        *out++ = hasSecond ? kBase64Chars[(value >> 6) & 0x3F] : '=';
+        *out++ = '=';
+    }
+}
+
+/// postWait 中一个包在负载里的字符数（二进制包按 b4/b + base64 计算，不含分隔/长度前缀）
+static NSUInteger RTCVPPollPacketLength(id packet) {
+    if ([packet isKindOfClass:[RTCVPPollBinaryPacket class]]) {
+        return 2 + (((RTCVPPollBinaryPacket *)packet).data.length + 2) / 3 * 4;
+    }
+    return ((NSData *)packet).length;
+}
+
+/// 依次发送：前一个请求结束（成功或失败）后才发送下一个，全部结束后让会话失效
+static void RTCVPSendPostsInOrder(NSURLSession *session, NSArray<NSURLRequest *> *requests, NSUInteger index) {
+    if (index >= requests.count) {
+        [session invalidateAndCancel];
+        return;
+    }
+    [[session dataTaskWithRequest:requests[index] completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        RTCVPSendPostsInOrder(session, requests, index + 1);
+    }] resume];
+}
+
+@implementation RTCVPPollBinaryPacket
+
++ (instancetype)packetWithData:(NSData *)data {
+    RTCVPPollBinaryPacket *packet = [[self alloc] init];
+    packet->_data = data;
+    return packet;
+}
+
+@end
+
 @implementation RTCVPSocketEngine (EnginePollable)
 
 #pragma mark - 轮询传输
@@ -58,26 +130,33 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
                     statusCode = ((NSHTTPURLResponse *)response).statusCode;
                 }
                 
-                if (error) {
+                if ((error || statusCode != 200) && strongSelfInQueue.directWebSocket) {
+                    // 直连 WebSocket 仍在竞速，轮询握手失败不算连接失败
+                    RTCVPEngineLog(RTCLogLevelWarning, @"Polling handshake failed: %@", error ? error.localizedDescription : @(statusCode));
+                    strongSelfInQueue.polling = NO;
+                } else if (error) {
                     [strongSelfInQueue log:[NSString stringWithFormat:@"Polling error: %@", error.localizedDescription] level:RTCLogLevelError];
                     [strongSelfInQueue didError:error.localizedDescription];
                 } else if (statusCode != 200) {
                     NSString *errorMsg = [NSString stringWithFormat:@"HTTP %ld", (long)statusCode];
+                    // 握手/会话错误时服务端返回 {"code":..,"message":..}，只在这里解析错误对象
+                    NSDictionary *errorBody = data.length > 0 ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+                    if ([errorBody isKindOfClass:[NSDictionary class]] && [errorBody[@"message"] isKindOfClass:[NSString class]]) {
+                        errorMsg = errorBody[@"message"];
+                    }
                     [strongSelfInQueue log:[NSString stringWithFormat:@"Polling HTTP error: %@", errorMsg] level:RTCLogLevelError];
                     [strongSelfInQueue didError:errorMsg];
                 } else if (!data) {
                     [strongSelfInQueue log:@"Polling received empty data" level:RTCLogLevelError];
                     [strongSelfInQueue didError:@"Empty response"];
                 } else {
-                    NSString *responseString = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-                    if (responseString) {
+#if RTCVP_LOG_DEBUG_ENABLED
+                    if ([strongSelfInQueue isLogEnabledForLevel:RTCLogLevelDebug]) {
+                        NSString *responseString = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
                         [strongSelfInQueue log:[NSString stringWithFormat:@"Polling response: %@", responseString] level:RTCLogLevelDebug];
-                        [strongSelfInQueue parsePollingMessage:responseString];
-                    } else {
-                        [strongSelfInQueue log:@"Polling response not UTF-8" level:RTCLogLevelWarning];
-                        // 尝试处理二进制数据
-                        [strongSelfInQueue parseEngineData:data];
                     }
+#endif
+                    [strongSelfInQueue parsePollingData:data];
                 }
                 
                 // 安全设置实例变量
@@ -100,6 +179,9 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
         });
     }];
     
+    if (!self.connected) {
+        self.handshakeTask = task;
+    }
     [task resume];
 }
 
@@ -115,87 +197,147 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
     [self doLongPoll:request];
 }
 
-- (void)parsePollingMessage:(NSString *)string {
-    if (string.length == 0) {
+/// 在原始响应字节上逐条解码，每条记录只在交给 parseEngineMessage 时转成一次字符串
+- (void)parsePollingData:(NSData *)data {
+    if (data.length == 0) {
         return;
     }
     
-    if (self.config.protocolVersion >= RTCVPSocketIOProtocolVersion3) {
-        // Engine.IO v4 格式：使用 \x1e 分隔多个消息
-        NSArray<NSString *> *messages = [string componentsSeparatedByString:@"\x1e"];
-        for (NSString *message in messages) {
-            if (message.length > 0) {
-                [self parseEngineMessage:message];
-            }
-        }
-    } else {
-        // Engine.IO v3 格式：length:message
-        RTCVPStringReader *reader = [[RTCVPStringReader alloc] init:string];
-        
-        while (reader.hasNext) {
-            NSString *lengthStr = [reader readUntilOccurence:@":"];
-            
-            if ([lengthStr rangeOfCharacterFromSet:[NSCharacterSet decimalDigitCharacterSet]].location != NSNotFound) {
-                NSInteger length = [lengthStr integerValue];
-                if (length > 0) {
-                    NSString *message = [reader read:(int)length];
-                    [self parseEngineMessage:message];
-                }
-            } else {
-                // 没有长度前缀，可能是单个消息
-                [self parseEngineMessage:string];
-                break;
-            }
+    __block NSUInteger parsedCount = 0;
+    __block BOOL binaryPayload = NO;
+    BOOL complete = [RTCVPPollingPayloadDecoder enumerateRecordsInData:data
+                                                       protocolVersion:self.config.protocolVersion
+                                                            usingBlock:^(const uint8_t *bytes, NSUInteger length, BOOL *stop) {
+        NSString *message = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        if (!message) {
+            // 第一条就不是 UTF-8：整个响应按二进制负载处理；否则只跳过这一条
+            binaryPayload = (parsedCount == 0);
+            *stop = binaryPayload;
+            [self log:@"Polling response not UTF-8" level:RTCLogLevelWarning];
+            return;
         }
+        parsedCount++;
+        [self parseEngineMessage:message];
+    }];
+    
+    [self.metrics addValue:data.length toCounter:RTCVPMetricPollingBytesIn];
+    [self.metrics addValue:(binaryPayload ? 1 : parsedCount) toCounter:RTCVPMetricPollingFramesIn];
+    
+    if (binaryPayload) {
+        // 尝试处理二进制数据
+        [self parseEngineData:data];
+    } else if (!complete) {
+        [self log:@"Malformed polling payload" level:RTCLogLevelWarning];
     }
 }
 
 /// 轮训模式发送消息
 - (void)sendPollMessage:(NSString *)message withType:(RTCVPSocketEnginePacketType)type withData:(NSArray *)data {
-    // 构建消息字符串：类型 + 消息内容
-    NSString *fullMessage = [NSString stringWithFormat:@"%ld%@", (long)type, message];
+    // 构建消息：类型 + 消息内容（UTF-8 字节）
+    const char *messageBytes = message.UTF8String ?: "";
+    size_t messageLength = strlen(messageBytes);
+    NSMutableData *fullMessage = [NSMutableData dataWithCapacity:messageLength + 1];
+    const uint8_t typeByte = (uint8_t)('0' + type);
+    [fullMessage appendBytes:&typeByte length:1];
+    [fullMessage appendBytes:messageBytes length:messageLength];
     
-    [self log:[NSString stringWithFormat:@"Sending poll message: %@", fullMessage] level:RTCLogLevelDebug];
+    [self sendPollEncodedMessage:fullMessage withData:data];
+}
+
+- (void)sendPollEncodedMessage:(NSData *)message withData:(NSArray *)data {
+    RTCVPEngineLogDebug(@"Sending poll message: %lu bytes", (unsigned long)message.length);
     
     // 添加到待发送队列
-    [self.postWait addObject:fullMessage];
+    [self.postWait addObject:message];
     
     // 添加二进制数据（如果需要）
     if (self.config.enableBinary && data.count > 0) {
+        // 附件在组装 POST 体时才以 base64 写入（v3：b4<base64>，v4：b<base64>）
         for (NSData *binaryData in data) {
-            NSString *binaryMessage;
-            if (self.config.protocolVersion == RTCVPSocketIOProtocolVersion2){
-                NSString *base64String = [binaryData base64EncodedStringWithOptions:0];
-                binaryMessage = [NSString stringWithFormat:@"b4%@", base64String];
-            }else{
-                binaryMessage = [[NSString alloc]initWithData:binaryData encoding:NSUTF8StringEncoding];
-            }
-            [self.postWait addObject:binaryMessage];
+            [self.postWait addObject:[RTCVPPollBinaryPacket packetWithData:binaryData]];
         }
     }
     
-//    / 重要消息：立即发送，不等待轮询
-    if (type == RTCVPSocketEnginePacketTypeMessage && [message isEqualToString:@"0"]) {
+    // 重要消息：立即发送，不等待合并窗口
+    if (message.length == 2 && memcmp(message.bytes, "40", 2) == 0) {
         // Socket.IO connect packet：立即发送
         [self log:@"📤 立即发送Socket.IO connect packet" level:RTCLogLevelInfo];
         [self flushWaitingForPost];
-    } else if (self.postWait.count > 0 && !self.waitingForPost) {
-        // 其他消息：按照正常逻辑发送
+    } else {
+        [self schedulePostFlush];
+    }
+}
+
+- (void)sendPollBinaryMessage:(NSData *)message {
+    RTCVPEngineLogDebug(@"Sending poll binary message: %lu bytes", (unsigned long)message.length);
+    
+    // Engine.IO v3：b4<base64>；Engine.IO v4：b<base64>，组装 POST 体时再编码
+    [self.postWait addObject:[RTCVPPollBinaryPacket packetWithData:message]];
+    
+    [self schedulePostFlush];
+}
+
+- (void)sendPollFrames:(NSArray *)frames {
+    RTCVPEngineLogDebug(@"Sending poll batch: %lu frames", (unsigned long)frames.count);
+    
+    // 批量本身已经合并好，不需要再等合并窗口；已有 POST 在途时由其完成回调一起带走
+    [self.postWait addObjectsFromArray:frames];
+    [self flushWaitingForPost];
+}
+
+/// 合并窗口：窗口内的消息合并成一个 POST；已有 POST 在途时由其完成回调继续发送
+- (void)schedulePostFlush {
+    if (self.waitingForPost || self.postFlushScheduled) {
+        return;
+    }
+    
+    NSTimeInterval interval = self.config.pollingCoalesceInterval;
+    if (interval <= 0 || [self pendingPostPayloadSize] >= self.config.maxPollingPayloadSize) {
         [self flushWaitingForPost];
+        return;
+    }
+    
+    self.postFlushScheduled = YES;
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), self.engineQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf || !strongSelf.postFlushScheduled) {
+            return;
+        }
+        strongSelf.postFlushScheduled = NO;
+        [strongSelf flushWaitingForPost];
+    });
+}
+
+- (NSUInteger)pendingPostPayloadSize {
+    NSUInteger size = 0;
+    for (id packet in self.postWait) {
+        size += RTCVPPollPacketLength(packet) + 8;
     }
+    return size;
 }
 
 - (void)disconnectPolling {
     if (self.polling && !self.closed) {
         // 添加关闭消息到队列
-        NSString *closeMessage = [NSString stringWithFormat:@"%ld", (long)RTCVPSocketEnginePacketTypeClose];
-        [self.postWait addObject:closeMessage];
+        const uint8_t closeMessage = '0' + RTCVPSocketEnginePacketTypeClose;
+        [self.postWait addObject:[NSData dataWithBytes:&closeMessage length:1]];
         
-        // 发送最后的请求
-        if (self.postWait.count > 0) {
-            NSURLRequest *request = [self createRequestForPostWithPostWait];
-            [[self.session dataTaskWithRequest:request] resume];
+        // 最后的请求（超过负载上限时拆成多个），关闭包在最后一个里
+        NSMutableArray<NSURLRequest *> *requests = [NSMutableArray array];
+        while (self.postWait.count > 0) {
+            [requests addObject:[self createRequestForPostWithPostWait]];
         }
+        [self releaseOutboundBytes:self.postWaitBytes];
+        self.postWaitBytes = 0;
+        
+        // 会话交给这串请求，closeOutEngine 不再取消它；
+        // 等在途的 POST 结束后逐个发送，关闭包不会先于前面的数据到达服务端
+        NSURLSession *session = self.session;
+        self.session = nil;
+        dispatch_group_notify(self.postGroup, self.engineQueue, ^{
+            RTCVPSendPostsInOrder(session, requests, 0);
+        });
     }
 }
 
@@ -209,12 +351,31 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
         return;
     }
     
+    // 同时只有一个 POST 在途，剩余消息由其完成回调继续发送
+    if (self.waitingForPost) {
+        return;
+    }
+    
     self.waitingForPost = YES;
+    self.postFlushScheduled = NO;
     
+    // 超过 maxPollingPayloadSize 时只带走前一部分，剩下的在本次 POST 完成后继续发送
+    NSUInteger pendingSize = [self pendingPostPayloadSize];
     NSURLRequest *request = [self createRequestForPostWithPostWait];
-        
+    
+    // 这次 POST 带走的字节，请求结束（成功或失败）后释放；拆分时按比例计算，最后一次带走余数
+    NSUInteger postBytes = self.postWaitBytes;
+    if (self.postWait.count > 0) {
+        NSUInteger remainingSize = [self pendingPostPayloadSize];
+        postBytes = (NSUInteger)((double)self.postWaitBytes * (double)(pendingSize - remainingSize) / (double)pendingSize);
+    }
+    self.postWaitBytes -= postBytes;
+    
+    dispatch_group_t postGroup = self.postGroup;
+    dispatch_group_enter(postGroup);
     __weak typeof(self) weakSelf = self;
     NSURLSessionDataTask *task = [self.session dataTaskWithRequest:request completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        dispatch_group_leave(postGroup);
         __strong typeof(weakSelf) strongSelf = weakSelf;
         if (!strongSelf) return;
         
@@ -229,6 +390,7 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
             
             // 安全设置实例变量
             strongSelfInQueue.waitingForPost = NO;
+            [strongSelfInQueue releaseOutboundBytes:postBytes];
             
             // 使用局部变量存储状态
             BOOL isPolling = strongSelfInQueue.polling;
@@ -263,8 +425,28 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
     if (!self.url) {
         return nil;
     }
-    // 生成并添加 t 参数（防止缓存）
-    NSString *tParam = [self generateTParameter];
+    
+    // 模板只在 sid 或连接状态变化时重建，每次请求只追加新的 t 参数（防止缓存）
+    NSString *sid = self.sid ?: @"";
+    if (!self.pollingURLTemplate ||
+        self.pollingURLTemplateConnected != self.connected ||
+        ![self.pollingURLTemplateSid isEqualToString:sid]) {
+        NSURL *templateURL = [self buildPollingURLTemplate];
+        if (!templateURL) {
+            return nil;
+        }
+        self.pollingURLTemplate = templateURL.absoluteString;
+        self.pollingURLTemplateSid = sid;
+        self.pollingURLTemplateConnected = self.connected;
+    }
+    
+    NSString *urlTemplate = self.pollingURLTemplate;
+    NSString *separator = [urlTemplate rangeOfString:@"?"].location == NSNotFound ? @"?" : @"&";
+    return [NSURL URLWithString:[NSString stringWithFormat:@"%@%@t=%@", urlTemplate, separator, [self generateTParameter]]];
+}
+
+/// 不含 t 参数的轮询 URL
+- (NSURL *)buildPollingURLTemplate {
     // 如果是连接中且不是v2版本那就按照现有格式拼接
     if (self.config.protocolVersion > RTCVPSocketIOProtocolVersion2 && self.connected) {
         // 使用 NSURLComponents 构建 URL，更安全可靠
@@ -282,7 +464,6 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
         
         // 添加传输方式
         [queryItems addObject:[[NSURLQueryItem alloc] initWithName:@"transport" value:@"polling"]];
-        [queryItems addObject:[[NSURLQueryItem alloc] initWithName:@"t" value:tParam]];
         
         // 添加 sid（如果有）
         if (self.sid.length > 0) {
@@ -306,7 +487,6 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
     if (components.queryItems) {
         [queryItems addObjectsFromArray:components.queryItems];
     }
-    [queryItems addObject:[[NSURLQueryItem alloc] initWithName:@"t" value:tParam]];
     
     // 添加 sid（如果有）
     if (self.sid.length > 0) {
@@ -317,70 +497,91 @@ typedef void (^EngineURLSessionDataTaskCallBack)(NSData* data, NSURLResponse* re
     return components.URL;
 }
 
-/// 生成 t 参数：紧凑的base62时间戳+随机字符串，防止重复
+/// 生成 t 参数：紧凑的base36时间戳+随机字符串，防止重复
 - (NSString *)generateTParameter {
     // 浏览器格式：g96ymem3（类似base64编码的时间戳+随机字符）
-    // 使用base62编码当前时间戳的毫秒值，确保唯一性
-    // 再添加少量随机字符，防止碰撞
-    
-    static NSString *const kBase62Chars = @"0123456789abcdefghijklmnopqrstuvwxyz";
-    const NSUInteger kBase62Count = [kBase62Chars length];
-    
-    NSMutableString *tParam = [NSMutableString stringWithCapacity:10];
-    
-    // 1. 获取当前时间戳（毫秒）作为基础，确保唯一性
-    uint64_t timestamp = (uint64_t)([[NSDate date] timeIntervalSince1970] * 1000);
-    
-    // 2. 转换为base62字符串（紧凑格式）
-    if (timestamp == 0) {
-        [tParam appendString:@"0"];
-    } else {
-        uint64_t value = timestamp;
-        while (value > 0) {
-            uint64_t remainder = value % kBase62Count;
-            [tParam insertString:[NSString stringWithFormat:@"%C", [kBase62Chars characterAtIndex:(NSUInteger)remainder]] atIndex:0];
-            value = value / kBase62Count;
-        }
-    }
+    // 编码当前时间戳的毫秒值确保唯一性，再添加少量随机字符防止碰撞
+    static const char kBase36Chars[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    const uint32_t kBase36Count = sizeof(kBase36Chars) - 1;
     
-    // 3. 生成3-4个随机字符，防止相同时间戳的碰撞
+    // 从后往前写：末尾 4 个随机字符，前面是时间戳
+    char buffer[32];
+    size_t position = sizeof(buffer);
     for (NSInteger i = 0; i < 4; i++) {
-        NSUInteger randomIndex = arc4random_uniform((u_int32_t)kBase62Count);
-        [tParam appendFormat:@"%C", [kBase62Chars characterAtIndex:randomIndex]];
+        buffer[--position] = kBase36Chars[arc4random_uniform(kBase36Count)];
     }
     
-    return tParam;
+    uint64_t timestamp = (uint64_t)([[NSDate date] timeIntervalSince1970] * 1000);
+    do {
+        buffer[--position] = kBase36Chars[timestamp % kBase36Count];
+        timestamp /= kBase36Count;
+    } while (timestamp > 0);
+    
+    return [[NSString alloc] initWithBytes:buffer + position length:sizeof(buffer) - position encoding:NSASCIIStringEncoding];
 }
 
 - (NSURLRequest *)createRequestForPostWithPostWait {
-   // 构建 POST 数据
-    NSMutableString *postData = [NSMutableString string];
+    // 按 maxPollingPayloadSize 取出本次 POST 的包（至少一个），postWait 中已经是 UTF-8 字节，直接拼接
+    NSUInteger maxSize = self.config.maxPollingPayloadSize;
+    NSUInteger count = 0;
+    NSUInteger capacity = 0;
+    for (id packet in self.postWait) {
+        NSUInteger packetSize = RTCVPPollPacketLength(packet) + 8;
+        if (count > 0 && maxSize > 0 && capacity + packetSize > maxSize) {
+            break;
+        }
+        capacity += packetSize;
+        count++;
+    }
+    NSArray *packets = [self.postWait subarrayWithRange:NSMakeRange(0, count)];
+    [self.postWait removeObjectsInRange:NSMakeRange(0, count)];
+    
+    NSMutableData *postData = [NSMutableData dataWithCapacity:capacity];
     
     if (self.config.protocolVersion < RTCVPSocketIOProtocolVersion3) {
-        // Engine.IO v3 格式：length:message
-        for (NSString *packet in self.postWait) {
-            [postData appendFormat:@"%lu:%@", (unsigned long)packet.length, packet];
+        // Engine.IO v3 格式：length:message，length 为 UTF-16 字符数；二进制为 b4<base64>
+        char lengthPrefix[24];
+        for (id packet in packets) {
+            BOOL isBinary = [packet isKindOfClass:[RTCVPPollBinaryPacket class]];
+            NSUInteger length = isBinary ? RTCVPPollPacketLength(packet) : RTCVPUTF16LengthOfUTF8Data(packet);
+            int prefixLength = snprintf(lengthPrefix, sizeof(lengthPrefix), "%lu:", (unsigned long)length);
+            [postData appendBytes:lengthPrefix length:prefixLength];
+            if (isBinary) {
+                [postData appendBytes:"b4" length:2];
+                RTCVPAppendBase64(postData, ((RTCVPPollBinaryPacket *)packet).data);
+            } else {
+                [postData appendData:packet];
+            }
         }
     } else {
-        // Engine.IO v4 格式：直接发送消息，多个消息用\x1e分隔
-        [postData appendString:[self.postWait componentsJoinedByString:@"\x1e"]];
+        // Engine.IO v4 格式：直接发送消息，多个消息用\x1e分隔；二进制为 b<base64>
+        const uint8_t separator = 0x1e;
+        [packets enumerateObjectsUsingBlock:^(id packet, NSUInteger idx, BOOL *stop) {
+            if (idx > 0) {
+                [postData appendBytes:&separator length:1];
+            }
+            if ([packet isKindOfClass:[RTCVPPollBinaryPacket class]]) {
+                [postData appendBytes:"b" length:1];
+                RTCVPAppendBase64(postData, ((RTCVPPollBinaryPacket *)packet).data);
+            } else {
+                [postData appendData:packet];
+            }
+        }];
     }
-    
-    [self.postWait removeAllObjects];
 
     NSURL *url = [self urlPollingWithSid];
     NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
-    NSLog(@"轮训模式POST消息到：%@ body:%@",[url relativeString],postData);
 
     [self addHeadersToRequest:request];
     
     request.HTTPMethod = @"POST";
-    request.HTTPBody = [postData dataUsingEncoding:NSUTF8StringEncoding];
+    request.HTTPBody = postData;
     [request setValue:@"text/plain; charset=UTF-8" forHTTPHeaderField:@"Content-Type"];
-    [request setValue:[NSString stringWithFormat:@"%lu", (unsigned long)request.HTTPBody.length] forHTTPHeaderField:@"Content-Length"];
+    [request setValue:[NSString stringWithFormat:@"%lu", (unsigned long)postData.length] forHTTPHeaderField:@"Content-Length"];
     
-    [self log:[NSString stringWithFormat:@"POST request to: %@", url.absoluteString] level:RTCLogLevelDebug];
-    [self log:[NSString stringWithFormat:@"POST data: %@", postData] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"POST request to: %@ (%lu bytes)", url.absoluteString, (unsigned long)postData.length);
+    [self.metrics addValue:count toCounter:RTCVPMetricPollingFramesOut];
+    [self.metrics addValue:postData.length toCounter:RTCVPMetricPollingBytesOut];
     
     return request;
 }
@@ -13,6 +13,15 @@
 
 -(void)sendWebSocketMessage:(NSString*)message withType:(RTCVPSocketEnginePacketType)type withData:(NSArray*)datas;
 
+/// 发送已编码的 Engine.IO 文本帧（UTF-8 字节），不再经过 NSString
+- (void)sendWebSocketEncodedMessage:(NSData *)message withData:(NSArray *)datas;
+
+/// 发送一个二进制帧（Engine.IO v3 自动加 0x04 前缀）
+- (void)sendWebSocketBinaryMessage:(NSData *)message;
+
+/// 一次写出多帧：NSData 为已编码的文本帧，RTCVPPollBinaryPacket 为二进制帧，所有帧拼成一次写入
+- (void)sendWebSocketFrames:(NSArray *)frames;
+
 /// 探测WebSocket连接
 - (void)probeWebSocket;
 /// 创建WebSocket并连接
@@ -29,4 +38,7 @@
 
 - (void)doFastUpgrade;
 
+/// 发送带时间戳的 WebSocket ping 帧，pong 返回时把往返时延报告给客户端
+- (void)sendWebSocketRTTPing;
+
 @end
@@ -14,6 +14,24 @@
 #import "RTCVPProbe.h"
 #import "RTCVPWebSocketProtocolFixer.h"
 
+/// RTT ping 的负载：4 字节标记 + 8 字节单调时钟纳秒，用来区分服务端主动发来的 pong
+static const char kRTCVPRTTPingTag[4] = {'v', 'p', 'r', 't'};
+
+/// 心跳、升级等 Engine.IO 控制包和命名空间 connect 走控制通道；close 仍按顺序排在已发数据之后
+static RTCJFRWritePriority RTCVPWritePriorityForMessage(RTCVPSocketEnginePacketType type, NSString *message) {
+    switch (type) {
+        case RTCVPSocketEnginePacketTypePing:
+        case RTCVPSocketEnginePacketTypePong:
+        case RTCVPSocketEnginePacketTypeUpgrade:
+        case RTCVPSocketEnginePacketTypeNoop:
+            return RTCJFRWritePriorityControl;
+        case RTCVPSocketEnginePacketTypeMessage:
+            return [message hasPrefix:@"0"] ? RTCJFRWritePriorityControl : RTCJFRWritePriorityNormal;
+        default:
+            return RTCJFRWritePriorityNormal;
+    }
+}
+
 @implementation RTCVPSocketEngine (EngineWebsocket)
 
 #pragma mark - WebSocket 管理
@@ -30,7 +48,7 @@
     }
     
     [self log:@"Creating WebSocket connection..." level:RTCLogLevelDebug];
-    [self log:[NSString stringWithFormat:@"WebSocket URL: %@", url.absoluteString] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"WebSocket URL: %@", url.absoluteString);
     
     self.ws = [[RTCJFRWebSocket alloc] initWithURL:url protocols:@[]];
     self.ws.queue = self.engineQueue;
@@ -39,6 +57,13 @@
     self.ws.voipEnabled = YES;
     self.ws.selfSignedSSL = self.config.allowSelfSignedCertificates;
     self.ws.security = self.config.security;
+    // permessage-deflate
+    self.ws.compressionEnabled = self.config.compressionEnabled;
+    self.ws.compressionThreshold = self.config.compressionThreshold;
+    self.ws.clientMaxWindowBits = self.config.compressionClientMaxWindowBits;
+    self.ws.serverMaxWindowBits = self.config.compressionServerMaxWindowBits;
+    self.ws.clientNoContextTakeover = self.config.compressionClientNoContextTakeover;
+    self.ws.serverNoContextTakeover = self.config.compressionServerNoContextTakeover;
     // 添加 headers
     if (self.config.cookies.count > 0) {
         NSDictionary *headers = [NSHTTPCookie requestHeaderFieldsWithCookies:self.config.cookies];
@@ -131,38 +156,107 @@
     //    例如：@"4{\"msg\":\"hello\"}"
     NSString *fullMessage = [NSString stringWithFormat:@"%ld%@", (long)type, message];
 
-    [self log:[NSString stringWithFormat:@"Sending WebSocket text message: %@", fullMessage]
-         level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"Sending WebSocket text message: %@", fullMessage);
 
     // 3. 发送文本帧
-    //    文本帧用于 Socket.IO/Engine.IO 的主控制消息
-    [self.ws writeString:fullMessage];
+    //    文本帧用于 Socket.IO/Engine.IO 的主控制消息，控制类消息走控制通道，不排在大数据后面
+    [self.ws writeString:fullMessage priority:RTCVPWritePriorityForMessage(type, message)];
+    [self recordWebSocketFrameOut:[fullMessage lengthOfBytesUsingEncoding:NSUTF8StringEncoding]];
 
     // 4. 若附带二进制数据，则逐个发送二进制帧
-    if (self.config.enableBinary && data.count > 0) {
+    [self sendWebSocketBinaryAttachments:data];
+}
 
-        for (NSData *binaryData in data) {
-            NSData *packetData = binaryData;
+- (void)sendWebSocketEncodedMessage:(NSData *)message withData:(NSArray<NSData *> *)data {
+    if (!self.ws || ![self.ws isConnected]) {
+        [self log:@"WebSocket not connected, cannot send message" level:RTCLogLevelWarning];
+        return;
+    }
+    
+    // message 已经是 [EngineType][Payload] 的 UTF-8 字节，直接作为文本帧发送
+    [self.ws writeUTF8Data:message];
+    [self recordWebSocketFrameOut:message.length];
+    [self sendWebSocketBinaryAttachments:data];
+}
 
-            // Engine.IO v3 需要加前缀 0x04
-            // 0x04 表示 binary message（engine binary packet）
-            if (self.config.protocolVersion == RTCVPSocketIOProtocolVersion2) {
-                const Byte binaryPrefix = 0x04;
+- (void)sendWebSocketBinaryAttachments:(NSArray<NSData *> *)data {
+    if (!self.config.enableBinary || data.count == 0) {
+        return;
+    }
+    
+    for (NSData *binaryData in data) {
+        [self writeWebSocketBinaryFrame:binaryData];
+    }
+}
 
-                // 构建 [0x04][binary payload]
-                NSMutableData *mutableData = [NSMutableData dataWithBytes:&binaryPrefix length:1];
-                [mutableData appendData:binaryData];
+- (void)sendWebSocketBinaryMessage:(NSData *)message {
+    if (!self.ws || ![self.ws isConnected]) {
+        [self log:@"WebSocket not connected, cannot send binary message" level:RTCLogLevelWarning];
+        return;
+    }
+    [self writeWebSocketBinaryFrame:message];
+}
 
-                packetData = mutableData;
-            }
+- (void)sendWebSocketFrames:(NSArray *)frames {
+    if (!self.ws || ![self.ws isConnected]) {
+        [self log:@"WebSocket not connected, cannot send message" level:RTCLogLevelWarning];
+        return;
+    }
+    
+    NSMutableArray<NSData *> *messages = [NSMutableArray arrayWithCapacity:frames.count];
+    NSMutableIndexSet *binaryIndexes = [NSMutableIndexSet indexSet];
+    for (id frame in frames) {
+        NSData *payload = frame;
+        if ([frame isKindOfClass:[RTCVPPollBinaryPacket class]]) {
+            [binaryIndexes addIndex:messages.count];
+            payload = [self webSocketBinaryPayload:((RTCVPPollBinaryPacket *)frame).data];
+        }
+        [messages addObject:payload];
+        [self recordWebSocketFrameOut:payload.length];
+    }
+    
+    RTCVPEngineLogDebug(@"Sending WebSocket batch: %lu frames", (unsigned long)messages.count);
+    [self.ws writeBatch:messages binaryIndexes:binaryIndexes];
+}
 
-            [self log:@"Sending WebSocket binary packet" level:RTCLogLevelDebug];
+/// Engine.IO v3 二进制帧需要 0x04 前缀（engine binary packet），v4 原样发送
+- (NSData *)webSocketBinaryPayload:(NSData *)binaryData {
+    if (self.config.protocolVersion != RTCVPSocketIOProtocolVersion2) {
+        return binaryData;
+    }
+    // 构建 [0x04][binary payload]
+    const Byte binaryPrefix = 0x04;
+    NSMutableData *mutableData = [NSMutableData dataWithCapacity:binaryData.length + 1];
+    [mutableData appendBytes:&binaryPrefix length:1];
+    [mutableData appendData:binaryData];
+    return mutableData;
+}
 
-            // Engine.IO v4：发送纯二进制帧
-            // Engine.IO v3：发送 0x04 + payload
-            [self.ws writeData:packetData];
-        }
+- (void)writeWebSocketBinaryFrame:(NSData *)binaryData {
+    NSData *packetData = [self webSocketBinaryPayload:binaryData];
+
+    [self log:@"Sending WebSocket binary packet" level:RTCLogLevelDebug];
+
+    // Engine.IO v4：发送纯二进制帧
+    // Engine.IO v3：发送 0x04 + payload
+    [self.ws writeData:packetData];
+    [self recordWebSocketFrameOut:packetData.length];
+}
+
+- (void)sendWebSocketRTTPing {
+    if (!self.ws.isConnected) {
+        return;
     }
+    // 时间戳放在负载里，pong 原样带回，不需要在引擎里记录未完成的 ping
+    uint64_t sentAt = RTCVPMonotonicNanoseconds();
+    NSMutableData *payload = [NSMutableData dataWithBytes:kRTCVPRTTPingTag length:sizeof(kRTCVPRTTPingTag)];
+    [payload appendBytes:&sentAt length:sizeof(sentAt)];
+    [self.ws writePing:payload];
+}
+
+- (void)recordWebSocketFrameOut:(NSUInteger)length {
+    [self.metrics addValue:1 toCounter:RTCVPMetricWebSocketFramesOut];
+    [self.metrics addValue:length toCounter:RTCVPMetricWebSocketBytesOut];
 }
 
 
@@ -201,6 +295,7 @@
     
     // 取消探测超时
     [self cancelProbeTimeout];
+    [self reportConnectionPhase:RTCVPConnectionPhaseTransportUpgraded atTime:RTCVPMonotonicNanoseconds()];
     
     // 开始心跳
     [self startPingTimer];
@@ -214,10 +309,19 @@
         return;
     }
     
-    [self log:[NSString stringWithFormat:@"Flushing %lu probe wait messages", (unsigned long)self.probeWait.count] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"Flushing %lu probe wait messages", (unsigned long)self.probeWait.count);
     
     for (RTCVPProbe *probe in self.probeWait) {
-        [self sendWebSocketMessage:probe.message withType:probe.type withData:probe.data];
+        if (probe.frames) {
+            [self sendWebSocketFrames:probe.frames];
+        } else if (probe.binaryMessage) {
+            [self sendWebSocketBinaryMessage:probe.binaryMessage];
+        } else if (probe.encodedMessage) {
+            [self sendWebSocketEncodedMessage:probe.encodedMessage withData:probe.data];
+        } else {
+            [self sendWebSocketMessage:probe.message withType:probe.type withData:probe.data];
+        }
+        [self releaseOutboundBytes:probe.byteCount];
     }
     
     [self.probeWait removeAllObjects];
@@ -228,21 +332,28 @@
         return;
     }
     
-    [self log:[NSString stringWithFormat:@"Flushing %lu post wait messages to WebSocket", (unsigned long)self.postWait.count] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"Flushing %lu post wait messages to WebSocket", (unsigned long)self.postWait.count);
     
-    for (NSString *packet in self.postWait) {
-        [self.ws writeString:packet];
-    }
+    // 升级前积压的包整批一次写出
+    [self sendWebSocketFrames:self.postWait];
     
     [self.postWait removeAllObjects];
+    [self releaseOutboundBytes:self.postWaitBytes];
+    self.postWaitBytes = 0;
 }
 
 #pragma mark - RTCJFRWebSocketDelegate
 
 - (void)websocketDidConnect:(RTCJFRWebSocket *)socket {
     [self log:@"WebSocket connected" level:RTCLogLevelInfo];
-    
-    if (self.config.transport == RTCVPSocketIOTransportWebSocket) {
+    [self reportConnectionPhase:RTCVPConnectionPhaseTCPConnected atTime:socket.tcpOpenedAt];
+    [self reportConnectionPhase:RTCVPConnectionPhaseTLSHandshake atTime:socket.tlsCompletedAt];
+    [self reportConnectionPhase:RTCVPConnectionPhaseUpgradeResponse atTime:socket.upgradeCompletedAt];
+    
+    if (self.directWebSocket) {
+        // 直连握手：服务端紧接着发 open 包，收到后才算连接建立
+        [self log:@"Waiting for open packet on WebSocket" level:RTCLogLevelDebug];
+    } else if (self.config.transport == RTCVPSocketIOTransportWebSocket) {
         // 强制 WebSocket 模式，直接使用
         self.websocket = YES;
         self.polling = NO;
@@ -276,11 +387,26 @@
 
 - (void)websocketDidDisconnect:(RTCJFRWebSocket *)socket error:(NSError *)error {
     NSString *errorDescription = error ? error.localizedDescription : @"Disconnected";
-    [self log:[NSString stringWithFormat:@"WebSocket disconnected: %@", errorDescription] level:RTCLogLevelWarning];
+    RTCVPEngineLog(RTCLogLevelWarning, @"WebSocket disconnected: %@", errorDescription);
     
     // 取消探测超时
     [self cancelProbeTimeout];
     
+    if (self.directWebSocket && !self.closed) {
+        self.directWebSocket = NO;
+        self.ws.delegate = nil;
+        self.ws = nil;
+        if (self.config.transport == RTCVPSocketIOTransportAuto) {
+            // 直连失败，立即回退到轮询握手（领先时间已过时轮询握手已在进行）
+            [self cancelWebSocketFallback];
+            [self log:@"Direct WebSocket failed, falling back to polling" level:RTCLogLevelInfo];
+            if (!self.polling) {
+                [self startPollingHandshake];
+            }
+            return;
+        }
+    }
+    
     if (self.closed) {
         [self closeOutEngine:@"WebSocket closed"];
     } else {
@@ -288,11 +414,9 @@
             // WebSocket连接断开
             self.websocket = NO;
             
-            // 如果配置了只使用WebSocket传输，使用延迟重连
+            // 只使用 WebSocket 传输时会话随连接结束，关闭引擎交给客户端重连
             if (self.config.transport == RTCVPSocketIOTransportWebSocket) {
-                [self log:@"WebSocket transport configured, scheduling delayed reconnect..." level:RTCLogLevelInfo];
-                // 使用延迟重连，避免频繁连接尝试
-                [self delayReconnect];
+                [self closeOutEngine:errorDescription];
             } else {
                 // WebSocket 断开，尝试回退到轮询
                 self.polling = YES;
@@ -311,16 +435,20 @@
             [self log:@"WebSocket connection failed" level:RTCLogLevelError];
             if (!self.closed) {
                 [self didError:errorDescription];
-                // 尝试延迟重连
-                [self delayReconnect];
             }
         }
     }
 }
 
 - (void)websocket:(RTCJFRWebSocket *)socket didReceiveMessage:(NSString *)string {
-    // 打印收到的消息字符串
-    [self log:[NSString stringWithFormat:@"📩 Socket层收到字符串数据: %@", string] level:RTCLogLevelInfo];
+    // 打印收到的消息字符串（每条消息都会走到这里，只在调试级别输出）
+    RTCVPEngineLogDebug(@"📩 Socket层收到字符串数据: %@", string);
+    [self.metrics addValue:1 toCounter:RTCVPMetricWebSocketFramesIn];
+    [self.metrics addValue:[string lengthOfBytesUsingEncoding:NSUTF8StringEncoding] toCounter:RTCVPMetricWebSocketBytesIn];
+    if (self.directWebSocket && string.length > 0 && [string characterAtIndex:0] == '0') {
+        [self handleWebSocketOpen:[string substringFromIndex:1]];
+        return;
+    }
     [self parseEngineMessage:string];
 }
 
@@ -330,21 +458,43 @@
         [self log:@"WebSocket received empty binary data" level:RTCLogLevelWarning];
         return;
     }
+    [self.metrics addValue:1 toCounter:RTCVPMetricWebSocketFramesIn];
+    [self.metrics addValue:data.length toCounter:RTCVPMetricWebSocketBytesIn];
     
-    // 分析WebSocket帧
-    NSDictionary *frameInfo = [RTCVPWebSocketProtocolFixer analyzeWebSocketFrame:data];
-    [self log:[NSString stringWithFormat:@"WebSocket帧分析: %@", frameInfo] level:RTCLogLevelDebug];
+    // 分析WebSocket帧（只用于调试日志，日志关闭时不做分析）
+    RTCVPEngineLogDebug(@"WebSocket帧分析: %@", [RTCVPWebSocketProtocolFixer analyzeWebSocketFrame:data]);
     
     // RTCJFRWebSocket 已经正确解析了 WebSocket 帧
     // 我们收到的 data 已经是有效负载（去除了帧头、掩码等）
        
-    [self log:[NSString stringWithFormat:@"📦 收到WebSocket二进制数据，长度: %lu", (unsigned long)data.length]
-            level:RTCLogLevelInfo];
+    RTCVPEngineLogDebug(@"📦 收到WebSocket二进制数据，长度: %lu", (unsigned long)data.length);
        
     // 直接传递给 parseEngineData
     [self parseEngineData:data];
 }
 
+- (void)websocket:(RTCJFRWebSocket *)socket didReceivePong:(NSData *)data {
+    if (socket != self.ws || data.length != sizeof(kRTCVPRTTPingTag) + sizeof(uint64_t) ||
+        memcmp(data.bytes, kRTCVPRTTPingTag, sizeof(kRTCVPRTTPingTag)) != 0) {
+        return;
+    }
+    uint64_t sentAt = 0;
+    [data getBytes:&sentAt range:NSMakeRange(sizeof(kRTCVPRTTPingTag), sizeof(sentAt))];
+    uint64_t now = RTCVPMonotonicNanoseconds();
+    if (sentAt == 0 || sentAt > now) {
+        return;
+    }
+    
+    NSTimeInterval rtt = (double)(now - sentAt) / NSEC_PER_SEC;
+    RTCVPEngineLogDebug(@"WebSocket 往返时延: %.1fms", rtt * 1000);
+    [self reportRoundTrip:rtt];
+}
+
+- (void)websocket:(RTCJFRWebSocket *)socket didUpdateBufferedAmount:(NSUInteger)bufferedAmount {
+    // 入队线程和写队列线程都会回调，快照可能乱序到达，只当作触发，字节数在 bufferedAmount 里实时读取
+    [self socketBufferedAmountDidChange];
+}
+
 // 添加处理WebSocket文本帧的方法
 - (void)handleWebSocketTextFrame:(NSData *)data {
     // 解析WebSocket帧，提取有效负载
@@ -353,7 +503,7 @@
     if (payload) {
         NSString *message = [[NSString alloc] initWithData:payload encoding:NSUTF8StringEncoding];
         if (message) {
-            [self log:[NSString stringWithFormat:@"WebSocket文本消息: %@", message] level:RTCLogLevelDebug];
+            RTCVPEngineLogDebug(@"WebSocket文本消息: %@", message);
             [self parseEngineMessage:message];
         } else {
             [self log:@"无法将WebSocket负载解析为文本" level:RTCLogLevelWarning];
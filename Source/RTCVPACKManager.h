@@ -8,20 +8,58 @@
 
 #import <Foundation/Foundation.h>
 #import "RTCVPSocketPacket.h"
+#import "RTCVPSocketMetrics.h"
+#import "RTCVPRTTEstimator.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// 等待 ACK 的包达到 maxPendingPackets 时的处理方式
+typedef NS_ENUM(NSInteger, RTCVPACKOverflowPolicy) {
+    /// 拒绝新包，包立即以容量错误失败，不发送
+    RTCVPACKOverflowPolicyReject = 0,
+    /// 新包排队等待，有包确认、失败或超时腾出位置后再发送；排队时间计入超时
+    RTCVPACKOverflowPolicyWait
+};
+
+/// 注册结果
+typedef NS_ENUM(NSInteger, RTCVPACKRegistration) {
+    /// 已登记，调用方立即发送
+    RTCVPACKRegistrationAccepted = 0,
+    /// 已排队，腾出位置后由管理器调用 send
+    RTCVPACKRegistrationQueued,
+    /// 已拒绝，包已以错误失败，不要发送
+    RTCVPACKRegistrationRejected
+};
+
+/// ACK 回调错误的 domain
+extern NSString * const RTCVPSocketIOErrorDomain;
+/// 等待 ACK 超时的错误码（-1）
+extern const NSInteger RTCVPACKErrorCodeTimeout;
+/// 容量已满被拒绝时的错误码（-3）
+extern const NSInteger RTCVPACKErrorCodeOverflow;
+/// 发送缓冲超过 config.maxBufferedAmount、事件没有发送时的错误码（-4）
+extern const NSInteger RTCVPSocketIOErrorCodeBufferFull;
+
 @interface RTCVPACKManager : NSObject
 
 #pragma mark - 配置
 @property (nonatomic, assign) NSTimeInterval defaultTimeout;
+/// 同时等待 ACK 的包上限，默认 1024；达到上限后按 overflowPolicy 处理，不会挤掉已登记的包
 @property (nonatomic, assign) NSInteger maxPendingPackets;
+@property (nonatomic, assign) RTCVPACKOverflowPolicy overflowPolicy;
+/// 收到 ACK 时记录发出到确认的耗时（微秒），为 nil 时不记录
+@property (nonatomic, strong, nullable) RTCVPLatencyHistogram *latencyHistogram;
+/// 收到 ACK 时把往返时延加入估算，为 nil 时不采样
+@property (nonatomic, strong, nullable) RTCVPRTTEstimator *rttEstimator;
 
 #pragma mark - 初始化
 - (instancetype)initWithDefaultTimeout:(NSTimeInterval)timeout;
 
 #pragma mark - 包管理
-- (void)registerPacket:(RTCVPSocketPacket *)packet;
+/// 登记等待 ACK 的包。返回 Accepted 时调用方立即发送；
+/// Queued 时 send 会在腾出位置后于管理器队列上调用（send 为 nil 时只登记不发送）
+- (RTCVPACKRegistration)registerPacket:(RTCVPSocketPacket *)packet send:(nullable dispatch_block_t)send;
+- (void)registerPacket:(RTCVPSocketPacket *)packet DEPRECATED_MSG_ATTRIBUTE("Use registerPacket:send: and check the registration result");
 - (BOOL)acknowledgePacketWithId:(NSInteger)packetId data:(nullable NSArray *)data;
 - (BOOL)failPacketWithId:(NSInteger)packetId error:(nullable NSError *)error;
 - (void)removePacketWithId:(NSInteger)packetId;
@@ -29,13 +67,18 @@ NS_ASSUME_NONNULL_BEGIN
 
 #pragma mark - 查询
 - (nullable RTCVPSocketPacket *)packetForId:(NSInteger)packetId;
+/// 已登记（已发送、等待 ACK）的包数，不含排队中的包
 - (NSInteger)activePacketCount;
+/// 排队等待发送的包数
+- (NSInteger)queuedPacketCount;
 - (NSArray<NSNumber *> *)allPacketIds;
 
 #pragma mark - 超时检查
+// 注册后的包挂在时间轮上，到期时以 ACK timeout 失败；没有等待中的包时不唤醒
+/// 立即处理已到期的包
 - (void)checkTimeouts;
-- (void)startPeriodicTimeoutCheckWithInterval:(NSTimeInterval)interval;
-- (void)stopPeriodicTimeoutCheck;
+- (void)startPeriodicTimeoutCheckWithInterval:(NSTimeInterval)interval DEPRECATED_MSG_ATTRIBUTE("Timeouts are driven by the timing wheel, no periodic check is needed");
+- (void)stopPeriodicTimeoutCheck DEPRECATED_MSG_ATTRIBUTE("Timeouts are driven by the timing wheel, no periodic check is needed");
 
 @end
 
@@ -8,13 +8,48 @@
 
 #import "RTCVPACKManager.h"
 #import "RTCDefaultSocketLogger.h"
+#import "RTCVPTimingWheel.h"
+#import "RTCVPPendingAckTable.h"
+#import "RTCVPConnectionTimeline.h"
+
+NSString * const RTCVPSocketIOErrorDomain = @"RTCVPSocketIOErrorDomain";
+const NSInteger RTCVPACKErrorCodeTimeout = -1;
+const NSInteger RTCVPACKErrorCodeOverflow = -3;
+const NSInteger RTCVPSocketIOErrorCodeBufferFull = -4;
+
+// 时间轮精度 100ms，一圈 51.2 秒，更长的超时跨圈
+static const NSTimeInterval kRTCVPACKWheelTick = 0.1;
+static const NSUInteger kRTCVPACKWheelSlots = 512;
+static const NSInteger kRTCVPACKDefaultMaxPending = 1024;
+
+static void *kRTCVPACKManagerQueueKey = &kRTCVPACKManagerQueueKey;
+
+/// 从包创建到现在经过的秒数（单调时钟，系统时间被调整也不会变成负数或跳变）
+static NSTimeInterval RTCVPACKSecondsSince(uint64_t uptime) {
+    return (double)(RTCVPMonotonicNanoseconds() - uptime) / NSEC_PER_SEC;
+}
+
+#pragma mark - 排队项
+
+/// 容量已满、按 Wait 策略排队的包
+@interface RTCVPACKQueuedPacket : NSObject
+@property (nonatomic, strong) RTCVPSocketPacket *packet;
+@property (nonatomic, copy, nullable) dispatch_block_t send;
+@property (nonatomic, strong) RTCVPTimingWheelTimer *deadline;
+@end
+
+@implementation RTCVPACKQueuedPacket
+@end
+
+#pragma mark - 管理器
 
 @interface RTCVPACKManager ()
 
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, RTCVPSocketPacket *> *pendingPackets;
+// 以下状态只在 managerQueue 上访问
+@property (nonatomic, strong) RTCVPPendingAckTable *pendingPackets;
+@property (nonatomic, strong) NSMutableArray<RTCVPACKQueuedPacket *> *queuedPackets;
+@property (nonatomic, strong) RTCVPTimingWheel *timingWheel;
 @property (nonatomic, strong) dispatch_queue_t managerQueue;
-@property (nonatomic, strong) dispatch_source_t timeoutCheckTimer;
-@property (nonatomic, assign) BOOL isCheckingTimeouts;
 
 @end
 
@@ -25,10 +60,16 @@
 - (instancetype)initWithDefaultTimeout:(NSTimeInterval)timeout {
     self = [super init];
     if (self) {
-        _pendingPackets = [NSMutableDictionary dictionary];
         _defaultTimeout = timeout > 0 ? timeout : 10.0;
-        _maxPendingPackets = 100;
+        _maxPendingPackets = kRTCVPACKDefaultMaxPending;
+        _overflowPolicy = RTCVPACKOverflowPolicyReject;
+        _pendingPackets = [[RTCVPPendingAckTable alloc] initWithCapacity:64];
+        _queuedPackets = [NSMutableArray array];
         _managerQueue = dispatch_queue_create("com.socketio.ackmanager.queue", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(_managerQueue, kRTCVPACKManagerQueueKey, kRTCVPACKManagerQueueKey, NULL);
+        _timingWheel = [[RTCVPTimingWheel alloc] initWithQueue:_managerQueue
+                                                  tickInterval:kRTCVPACKWheelTick
+                                                     slotCount:kRTCVPACKWheelSlots];
         
         [RTCDefaultSocketLogger.logger log:@"ACK管理器已初始化" type:@"ACKManager"];
     }
@@ -36,114 +77,194 @@
 }
 
 - (void)dealloc {
-    [self stopPeriodicTimeoutCheck];
+    [_timingWheel invalidate];
     
-    // 在主线程直接清理，避免dispatch_async导致的竞态条件
-    if (_pendingPackets) {
-        for (RTCVPSocketPacket *packet in _pendingPackets.allValues) {
-            [packet cancel];
-        }
-        [_pendingPackets removeAllObjects];
+    // 在当前线程直接清理，避免dispatch_async导致的竞态条件
+    for (RTCVPSocketPacket *packet in [_pendingPackets allPackets]) {
+        [packet cancel];
     }
+    [_pendingPackets removeAllPackets];
+    for (RTCVPACKQueuedPacket *queued in _queuedPackets) {
+        [queued.packet cancel];
+    }
+    [_queuedPackets removeAllObjects];
     
     [RTCDefaultSocketLogger.logger log:@"ACK管理器已释放" type:@"ACKManager"];
 }
 
+/// 在 managerQueue 上同步执行，已在该队列上时直接执行
+- (void)performSync:(dispatch_block_t)block {
+    if (dispatch_get_specific(kRTCVPACKManagerQueueKey)) {
+        block();
+    } else {
+        dispatch_sync(_managerQueue, block);
+    }
+}
+
 #pragma mark - 包管理
 
-- (void)registerPacket:(RTCVPSocketPacket *)packet {
-    if (!packet || packet.packetId < 0) {
-        return;
+- (RTCVPACKRegistration)registerPacket:(RTCVPSocketPacket *)packet send:(nullable dispatch_block_t)send {
+    if (!packet || packet.packetId < 0 || packet.packetId > UINT32_MAX) {
+        [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"无效的ACK ID: %ld", (long)packet.packetId]
+                                      type:@"ACKManager"];
+        return RTCVPACKRegistrationRejected;
     }
     
-    __weak typeof(self) weakSelf = self;
+    // 设置默认超时时间
+    if (packet.timeoutInterval <= 0) {
+        packet.timeoutInterval = self.defaultTimeout;
+    }
     
-    dispatch_async(_managerQueue, ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf) return;
-        
-        // 检查是否达到最大限制
-        if (strongSelf.pendingPackets.count >= strongSelf.maxPendingPackets) {
-            [strongSelf cleanupOldestPackets:5];
+    __block RTCVPACKRegistration registration = RTCVPACKRegistrationAccepted;
+    __block NSString *reason = nil;
+    [self performSync:^{
+        BOOL full = (NSInteger)self.pendingPackets.count >= self.maxPendingPackets;
+        if (full && self.overflowPolicy == RTCVPACKOverflowPolicyReject) {
+            registration = RTCVPACKRegistrationRejected;
+            reason = @"等待ACK的包已达上限";
+            return;
         }
-        
-        NSNumber *packetIdKey = @(packet.packetId);
-        
-        // 检查是否已存在相同ID的包
-        if (strongSelf.pendingPackets[packetIdKey]) {
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"已存在相同ID的包: %ld", (long)packet.packetId]
-                                          type:@"ACKManager"];
+        // 32 位 ID 回绕后仍有同 ID 的包在等待
+        if ([self.pendingPackets packetForId:(uint32_t)packet.packetId] || [self indexOfQueuedPacketWithId:packet.packetId] != NSNotFound) {
+            registration = RTCVPACKRegistrationRejected;
+            reason = @"相同ACK ID的包仍在等待";
             return;
         }
         
-        // 设置默认超时时间
-        if (packet.timeoutInterval <= 0) {
-            packet.timeoutInterval = strongSelf.defaultTimeout;
+        // 超时从包创建时算起，排队的时间也计入
+        RTCVPTimingWheelTimer *deadline = [self scheduleDeadlineForPacket:packet];
+        if (full || self.queuedPackets.count > 0) {
+            // 排在已排队的包后面，保持发送顺序
+            RTCVPACKQueuedPacket *queued = [[RTCVPACKQueuedPacket alloc] init];
+            queued.packet = packet;
+            queued.send = send;
+            queued.deadline = deadline;
+            [self.queuedPackets addObject:queued];
+            registration = RTCVPACKRegistrationQueued;
+            return;
         }
+        [self.pendingPackets setPacket:packet deadline:deadline forId:(uint32_t)packet.packetId];
+    }];
+    
+    switch (registration) {
+        case RTCVPACKRegistrationAccepted:
+            RTCVPLogDebug(@"ACKManager", @"注册包: packetId=%ld", (long)packet.packetId);
+            break;
+        case RTCVPACKRegistrationQueued:
+            RTCVPLogDebug(@"ACKManager", @"容量已满，包排队等待: packetId=%ld", (long)packet.packetId);
+            break;
+        case RTCVPACKRegistrationRejected: {
+            // 回调在队列外执行
+            NSError *overflowError = [NSError errorWithDomain:RTCVPSocketIOErrorDomain
+                                                         code:RTCVPACKErrorCodeOverflow
+                                                     userInfo:@{NSLocalizedDescriptionKey: reason}];
+            [packet failWithError:overflowError];
+            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"拒绝包: packetId=%ld, %@", (long)packet.packetId, reason]
+                                          type:@"ACKManager"];
+            break;
+        }
+    }
+    return registration;
+}
+
+- (void)registerPacket:(RTCVPSocketPacket *)packet {
+    [self registerPacket:packet send:nil];
+}
+
+- (RTCVPTimingWheelTimer *)scheduleDeadlineForPacket:(RTCVPSocketPacket *)packet {
+    NSTimeInterval remaining = packet.timeoutInterval - RTCVPACKSecondsSince(packet.creationUptime);
+    NSInteger packetId = packet.packetId;
+    __weak typeof(self) weakSelf = self;
+    return [self.timingWheel scheduleAfter:remaining handler:^{
+        [weakSelf expirePacketWithId:packetId];
+    }];
+}
+
+/// 从等待表和时间轮上摘下包，并把排队的包补进空出的位置（只在 managerQueue 上调用）
+- (nullable RTCVPSocketPacket *)takePacketWithId:(NSInteger)packetId {
+    if (packetId < 0 || packetId > UINT32_MAX) {
+        return nil;
+    }
+    RTCVPTimingWheelTimer *deadline = nil;
+    RTCVPSocketPacket *packet = [self.pendingPackets removePacketForId:(uint32_t)packetId deadline:&deadline];
+    if (!packet) {
+        return nil;
+    }
+    [self.timingWheel cancelTimer:deadline];
+    [self promoteQueuedPackets];
+    return packet;
+}
+
+- (NSUInteger)indexOfQueuedPacketWithId:(NSInteger)packetId {
+    return [self.queuedPackets indexOfObjectPassingTest:^BOOL(RTCVPACKQueuedPacket *queued, NSUInteger idx, BOOL *stop) {
+        return queued.packet.packetId == packetId;
+    }];
+}
+
+/// 按排队顺序把包移进等待表并发送（只在 managerQueue 上调用）
+- (void)promoteQueuedPackets {
+    while (self.queuedPackets.count > 0 && (NSInteger)self.pendingPackets.count < self.maxPendingPackets) {
+        RTCVPACKQueuedPacket *queued = self.queuedPackets.firstObject;
+        [self.queuedPackets removeObjectAtIndex:0];
+        [self.pendingPackets setPacket:queued.packet deadline:queued.deadline forId:(uint32_t)queued.packet.packetId];
         
-        // 存储包
-        strongSelf.pendingPackets[packetIdKey] = packet;
-        
-        [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"注册包: packetId=%ld", (long)packet.packetId]
-                                      type:@"ACKManager"];
-    });
+        RTCVPLogDebug(@"ACKManager", @"排队的包开始发送: packetId=%ld", (long)queued.packet.packetId);
+        if (queued.send) {
+            queued.send();
+        }
+    }
 }
 
 - (BOOL)acknowledgePacketWithId:(NSInteger)packetId data:(nullable NSArray *)data {
-    __block BOOL acknowledged = NO;
+    __block RTCVPSocketPacket *packet = nil;
     
-    dispatch_sync(_managerQueue, ^{
-        NSNumber *packetIdKey = @(packetId);
-        RTCVPSocketPacket *packet = self.pendingPackets[packetIdKey];
-        
-        if (packet) {
-            [packet acknowledgeWithData:data];
-            [self.pendingPackets removeObjectForKey:packetIdKey];
-            acknowledged = YES;
-            
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"包已确认: packetId=%ld", (long)packetId]
-                                          type:@"ACKManager"];
-        } else {
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"未找到待确认的包: packetId=%ld", (long)packetId]
-                                          type:@"ACKManager"];
-        }
-    });
+    [self performSync:^{
+        packet = [self takePacketWithId:packetId];
+    }];
     
-    return acknowledged;
+    if (!packet) {
+        RTCVPLogDebug(@"ACKManager", @"未找到待确认的包: packetId=%ld", (long)packetId);
+        return NO;
+    }
+    
+    NSTimeInterval latency = RTCVPACKSecondsSince(packet.creationUptime);
+    [self.latencyHistogram recordValue:(uint64_t)(latency * USEC_PER_SEC)];
+    [self.rttEstimator addSample:latency];
+    // 回调在队列外执行，回调里再调用管理器不会死锁
+    [packet acknowledgeWithData:data];
+    
+    RTCVPLogDebug(@"ACKManager", @"包已确认: packetId=%ld", (long)packetId);
+    return YES;
 }
 
 - (BOOL)failPacketWithId:(NSInteger)packetId error:(nullable NSError *)error {
-    __block BOOL failed = NO;
+    __block RTCVPSocketPacket *packet = nil;
     
-    dispatch_sync(_managerQueue, ^{
-        NSNumber *packetIdKey = @(packetId);
-        RTCVPSocketPacket *packet = self.pendingPackets[packetIdKey];
-        
-        if (packet) {
-            [packet failWithError:error];
-            [self.pendingPackets removeObjectForKey:packetIdKey];
-            failed = YES;
-            
-            NSString *errorMsg = error ? error.localizedDescription : @"未知错误";
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"包失败: packetId=%ld, error=%@", (long)packetId, errorMsg]
-                                          type:@"ACKManager"];
-        }
-    });
+    [self performSync:^{
+        packet = [self takePacketWithId:packetId];
+    }];
+    
+    if (!packet) {
+        return NO;
+    }
+    
+    [packet failWithError:error];
     
-    return failed;
+    RTCVPLogDebug(@"ACKManager", @"包失败: packetId=%ld, error=%@", (long)packetId, error ? error.localizedDescription : @"未知错误");
+    return YES;
 }
 
 - (void)removePacketWithId:(NSInteger)packetId {
     dispatch_async(_managerQueue, ^{
-        NSNumber *packetIdKey = @(packetId);
-        RTCVPSocketPacket *packet = self.pendingPackets[packetIdKey];
+        RTCVPSocketPacket *packet = [self takePacketWithId:packetId];
+        if (!packet) {
+            packet = [self takeQueuedPacketWithId:packetId];
+        }
         
         if (packet) {
             [packet cancel];
-            [self.pendingPackets removeObjectForKey:packetIdKey];
             
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"包已移除: packetId=%ld", (long)packetId]
-                                          type:@"ACKManager"];
+            RTCVPLogDebug(@"ACKManager", @"包已移除: packetId=%ld", (long)packetId);
         }
     });
 }
@@ -152,27 +273,47 @@
     __weak typeof(self) weakSelf = self;
     dispatch_async(_managerQueue, ^{        
         __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf || !strongSelf.pendingPackets) {
+        if (!strongSelf) {
             return;
         }
-        for (RTCVPSocketPacket *packet in strongSelf.pendingPackets.allValues) {
+        for (RTCVPSocketPacket *packet in [strongSelf.pendingPackets allPackets]) {
             [packet cancel];
         }
+        for (RTCVPACKQueuedPacket *queued in strongSelf.queuedPackets) {
+            [queued.packet cancel];
+        }
         
-        [strongSelf.pendingPackets removeAllObjects];
+        [strongSelf.pendingPackets removeAllPackets];
+        [strongSelf.queuedPackets removeAllObjects];
+        [strongSelf.timingWheel cancelAll];
         
         [RTCDefaultSocketLogger.logger log:@"所有包已移除" type:@"ACKManager"];
     });
 }
 
+/// 从排队队列里摘下包（只在 managerQueue 上调用）
+- (nullable RTCVPSocketPacket *)takeQueuedPacketWithId:(NSInteger)packetId {
+    NSUInteger index = [self indexOfQueuedPacketWithId:packetId];
+    if (index == NSNotFound) {
+        return nil;
+    }
+    RTCVPACKQueuedPacket *queued = self.queuedPackets[index];
+    [self.queuedPackets removeObjectAtIndex:index];
+    [self.timingWheel cancelTimer:queued.deadline];
+    return queued.packet;
+}
+
 #pragma mark - 查询
 
 - (nullable RTCVPSocketPacket *)packetForId:(NSInteger)packetId {
+    if (packetId < 0 || packetId > UINT32_MAX) {
+        return nil;
+    }
     __block RTCVPSocketPacket *packet = nil;
     
-    dispatch_sync(_managerQueue, ^{
-        packet = self.pendingPackets[@(packetId)];
-    });
+    [self performSync:^{
+        packet = [self.pendingPackets packetForId:(uint32_t)packetId];
+    }];
     
     return packet;
 }
@@ -180,131 +321,68 @@
 - (NSInteger)activePacketCount {
     __block NSInteger count = 0;
     
-    dispatch_sync(_managerQueue, ^{
+    [self performSync:^{
         count = self.pendingPackets.count;
-    });
+    }];
+    
+    return count;
+}
+
+- (NSInteger)queuedPacketCount {
+    __block NSInteger count = 0;
+    
+    [self performSync:^{
+        count = self.queuedPackets.count;
+    }];
     
     return count;
 }
 
 - (NSArray<NSNumber *> *)allPacketIds {
-    __block NSArray<NSNumber *> *ids = nil;
+    __block NSMutableArray<NSNumber *> *ids = nil;
     
-    dispatch_sync(_managerQueue, ^{
-        ids = self.pendingPackets.allKeys;
-    });
+    [self performSync:^{
+        NSArray<RTCVPSocketPacket *> *packets = [self.pendingPackets allPackets];
+        ids = [NSMutableArray arrayWithCapacity:packets.count];
+        for (RTCVPSocketPacket *packet in packets) {
+            [ids addObject:@(packet.packetId)];
+        }
+    }];
     
     return ids;
 }
 
 #pragma mark - 超时检查
 
+/// 时间轮到期回调，在 managerQueue 上执行；排队中的包同样会超时
+- (void)expirePacketWithId:(NSInteger)packetId {
+    RTCVPSocketPacket *packet = [self takePacketWithId:packetId];
+    if (!packet) {
+        packet = [self takeQueuedPacketWithId:packetId];
+    }
+    if (!packet) {
+        return;
+    }
+    
+    NSError *timeoutError = [NSError errorWithDomain:RTCVPSocketIOErrorDomain
+                                                code:RTCVPACKErrorCodeTimeout
+                                            userInfo:@{NSLocalizedDescriptionKey: @"ACK timeout"}];
+    [packet failWithError:timeoutError];
+    
+    RTCVPLogDebug(@"ACKManager", @"包超时: packetId=%ld", (long)packetId);
+}
+
 - (void)checkTimeouts {
     dispatch_async(_managerQueue, ^{
-        if (self.isCheckingTimeouts) {
-            return;
-        }
-        
-        self.isCheckingTimeouts = YES;
-        
-        NSDate *now = [NSDate date];
-        NSMutableArray<NSNumber *> *timeoutPacketIds = [NSMutableArray array];
-        
-        // 找出所有超时的包
-        [self.pendingPackets enumerateKeysAndObjectsUsingBlock:^(NSNumber *packetId, RTCVPSocketPacket *packet, BOOL *stop) {
-            if (packet.timeoutInterval > 0) {
-                NSTimeInterval elapsed = [now timeIntervalSinceDate:packet.creationDate];
-                if (elapsed > packet.timeoutInterval && packet.isPending) {
-                    [timeoutPacketIds addObject:packetId];
-                }
-            }
-        }];
-        
-        // 处理超时的包
-        for (NSNumber *packetId in timeoutPacketIds) {
-            RTCVPSocketPacket *packet = self.pendingPackets[packetId];
-            if (packet) {
-                NSError *timeoutError = [NSError errorWithDomain:@"RTCVPSocketIOErrorDomain"
-                                                            code:-1
-                                                        userInfo:@{NSLocalizedDescriptionKey: @"ACK timeout"}];
-                [packet failWithError:timeoutError];
-                [self.pendingPackets removeObjectForKey:packetId];
-                
-                [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"包超时: packetId=%ld", (long)packetId.integerValue]
-                                              type:@"ACKManager"];
-            }
-        }
-        
-        if (timeoutPacketIds.count > 0) {
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"超时检查: 发现 %ld 个超时的包", (long)timeoutPacketIds.count]
-                                          type:@"ACKManager"];
-        }
-        
-        self.isCheckingTimeouts = NO;
+        [self.timingWheel advance];
     });
 }
 
 - (void)startPeriodicTimeoutCheckWithInterval:(NSTimeInterval)interval {
-    [self stopPeriodicTimeoutCheck];
-    
-    if (interval <= 0) {
-        interval = 1.0; // 默认1秒检查一次
-    }
-    
-    __weak typeof(self) weakSelf = self;
-    
-    _timeoutCheckTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _managerQueue);
-    dispatch_source_set_timer(_timeoutCheckTimer,
-                              dispatch_time(DISPATCH_TIME_NOW, interval * NSEC_PER_SEC),
-                              interval * NSEC_PER_SEC,
-                              0.1 * NSEC_PER_SEC);
-    
-    dispatch_source_set_event_handler(_timeoutCheckTimer, ^{
-        [weakSelf checkTimeouts];
-    });
-    
-    dispatch_resume(_timeoutCheckTimer);
-    
-    [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"启动定期超时检查，间隔: %.1f秒", interval]
-                                  type:@"ACKManager"];
+    // 超时由时间轮按需唤醒，不再需要定期扫描
 }
 
 - (void)stopPeriodicTimeoutCheck {
-    if (_timeoutCheckTimer) {
-        dispatch_source_cancel(_timeoutCheckTimer);
-        _timeoutCheckTimer = nil;
-        
-        [RTCDefaultSocketLogger.logger log:@"停止定期超时检查" type:@"ACKManager"];
-    }
-}
-
-#pragma mark - 清理旧包
-
-- (void)cleanupOldestPackets:(NSInteger)count {
-    if (count <= 0) return;
-    
-    // 按创建时间排序
-    NSArray<RTCVPSocketPacket *> *sortedPackets = [self.pendingPackets.allValues
-        sortedArrayUsingComparator:^NSComparisonResult(RTCVPSocketPacket *packet1, RTCVPSocketPacket *packet2) {
-            return [packet1.creationDate compare:packet2.creationDate];
-        }];
-    
-    NSInteger cleanupCount = MIN(count, sortedPackets.count);
-    for (NSInteger i = 0; i < cleanupCount; i++) {
-        RTCVPSocketPacket *packet = sortedPackets[i];
-        NSNumber *packetId = @(packet.packetId);
-        
-        // 通知包已因清理而失败
-        NSError *cleanupError = [NSError errorWithDomain:@"RTCVPSocketIOErrorDomain"
-                                                    code:-2
-                                                userInfo:@{NSLocalizedDescriptionKey: @"包因管理器容量限制被清理"}];
-        [packet failWithError:cleanupError];
-        
-        [self.pendingPackets removeObjectForKey:packetId];
-        
-        [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"清理旧包: packetId=%ld", (long)packet.packetId]
-                                      type:@"ACKManager"];
-    }
 }
 
 #pragma mark - 调试信息
@@ -312,26 +390,29 @@
 - (NSString *)debugDescription {
     __block NSString *description = nil;
     
-    dispatch_sync(_managerQueue, ^{
+    [self performSync:^{
+        NSArray<RTCVPSocketPacket *> *packets = [self.pendingPackets allPackets];
         NSMutableString *debug = [NSMutableString stringWithString:@"RTCVPACKManager {\n"];
         [debug appendFormat:@"  defaultTimeout: %.1f,\n", self.defaultTimeout];
         [debug appendFormat:@"  maxPendingPackets: %ld,\n", (long)self.maxPendingPackets];
-        [debug appendFormat:@"  pendingPacketsCount: %ld,\n", (long)self.pendingPackets.count];
+        [debug appendFormat:@"  overflowPolicy: %ld,\n", (long)self.overflowPolicy];
+        [debug appendFormat:@"  pendingPacketsCount: %lu,\n", (unsigned long)packets.count];
+        [debug appendFormat:@"  queuedPacketsCount: %lu,\n", (unsigned long)self.queuedPackets.count];
         [debug appendString:@"  packets: ["];
         
-        for (RTCVPSocketPacket *packet in self.pendingPackets.allValues) {
+        for (RTCVPSocketPacket *packet in packets) {
             [debug appendFormat:@"\n    {id: %ld, state: %lu, event: %@}",
              (long)packet.packetId, (unsigned long)packet.state, packet.event];
         }
         
-        if (self.pendingPackets.count > 0) {
+        if (packets.count > 0) {
             [debug appendString:@"\n  "];
         }
         
         [debug appendString:@"]\n}"];
         
         description = [debug copy];
-    });
+    }];
     
     return description;
 }
@@ -18,6 +18,14 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, strong) NSString *message;
 @property (nonatomic) RTCVPSocketEnginePacketType type;
 @property (nonatomic, strong) NSArray *data;
+/// 已编码的完整 Engine.IO 帧，存在时优先于 message/type
+@property (nonatomic, strong, nullable) NSData *encodedMessage;
+/// 二进制 Engine.IO message，存在时整包作为二进制帧发送
+@property (nonatomic, strong, nullable) NSData *binaryMessage;
+/// 批量发送的帧（NSData 为文本帧，RTCVPPollBinaryPacket 为二进制帧），存在时整批一次写出
+@property (nonatomic, strong, nullable) NSArray *frames;
+/// 计入发送缓冲的字节数，发出后释放
+@property (nonatomic, assign) NSUInteger byteCount;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -22,6 +22,25 @@ typedef enum : NSUInteger{
 } RTCVPSocketEnginePacketType;
 
 
+// 引擎日志宏：同时遵循 config.loggingEnabled / config.logLevel，关闭时不格式化消息
+#define RTCVPEngineLog(lvl, fmt, ...) do { \
+    if ([self isLogEnabledForLevel:(lvl)]) { \
+        [self log:[NSString stringWithFormat:(fmt), ##__VA_ARGS__] level:(lvl)]; \
+    } \
+} while (0)
+
+#if RTCVP_LOG_DEBUG_ENABLED
+#define RTCVPEngineLogDebug(fmt, ...) RTCVPEngineLog(RTCLogLevelDebug, fmt, ##__VA_ARGS__)
+#else
+#define RTCVPEngineLogDebug(fmt, ...) do {} while (0)
+#endif
+
+/// postWait 中的二进制包，组装 POST 体时才以 base64 写入（v3：b4<base64>，v4：b<base64>）
+@interface RTCVPPollBinaryPacket : NSObject
+@property (nonatomic, strong, readonly) NSData *data;
++ (instancetype)packetWithData:(NSData *)data;
+@end
+
 @class RTCVPTimer;
 @class RTCVPTimeoutManager;
 @class RTCVPProbe;
@@ -38,21 +57,39 @@ typedef enum : NSUInteger{
 @property (nonatomic, assign) BOOL fastUpgrade;
 @property (nonatomic, assign) BOOL waitingForPoll;
 @property (nonatomic, assign) BOOL waitingForPost;
+/// 合并窗口内已安排了一次 POST
+@property (nonatomic, assign) BOOL postFlushScheduled;
+/// 在途的 POST，断开时关闭包等它们完成后再发送
+@property (nonatomic, strong) dispatch_group_t postGroup;
+/// 当前 ws 是不带 sid 的直连握手，open 包还没收到
+@property (nonatomic, assign) BOOL directWebSocket;
 
 @property (nonatomic, strong) NSString *sid;
 @property (nonatomic, strong) NSURL *url;
 @property (nonatomic, strong) NSURL *urlPolling;
 @property (nonatomic, strong) NSURL *urlWebSocket;
+/// 缓存的轮询 URL（不含 t 参数），sid 或连接状态变化时重建
+@property (nonatomic, copy) NSString *pollingURLTemplate;
+@property (nonatomic, copy) NSString *pollingURLTemplateSid;
+@property (nonatomic, assign) BOOL pollingURLTemplateConnected;
 
 @property (nonatomic, strong) NSURLSession *session;
-@property (nonatomic, strong) RTCJFRWebSocket *ws;
-@property (nonatomic, strong) NSMutableArray<NSString *> *postWait;
+/// 进行中的轮询握手请求，直连 WebSocket 先完成时取消
+@property (nonatomic, strong) NSURLSessionDataTask *handshakeTask;
+/// atomic：bufferedAmount 会在任意线程读取它
+@property (atomic, strong) RTCJFRWebSocket *ws;
+/// 等待 POST 的 Engine.IO 包：NSData 为已带类型前缀的 UTF-8 字节，RTCVPPollBinaryPacket 为二进制包
+@property (nonatomic, strong) NSMutableArray *postWait;
 @property (nonatomic, strong) NSMutableArray<RTCVPProbe *> *probeWait;
+/// postWait 中计入发送缓冲的字节数（只在 engineQueue 上访问）
+@property (nonatomic, assign) NSUInteger postWaitBytes;
 
 @property (nonatomic, assign) NSInteger pingInterval;
 @property (nonatomic, assign) NSInteger pingTimeout;
 @property (nonatomic, assign) NSInteger pongsMissed;
 @property (nonatomic, assign) NSInteger pongsMissedMax;
+/// Engine.IO v3 最近一次心跳 ping 的发送时间（单调时钟纳秒），收到 pong 后清零；只在 engineQueue 上访问
+@property (nonatomic, assign) uint64_t pingSentAt;
 
 @property (nonatomic, strong) RTCVPSocketIOConfig *config;
 
@@ -71,6 +108,7 @@ typedef enum : NSUInteger{
 @property (nonatomic, strong) RTCVPTimer *connectionTimeoutTimer;
 @property (nonatomic, copy) NSString *probeTimeoutTaskId;
 @property (nonatomic, copy) NSString *connectionTimeoutTaskId;
+@property (nonatomic, copy) NSString *websocketFallbackTaskId;
 
 
 // 线程安全锁，保护共享状态变量
@@ -91,6 +129,19 @@ typedef enum : NSUInteger{
 
 - (void)handlePong:(NSString *)message;
 
+// 发送已编码的 Engine.IO 帧
+- (void)writeEncoded:(NSData *)message withData:(NSArray *)data;
+// 发送二进制 Engine.IO message
+- (void)writeBinaryMessage:(NSData *)message;
+
+
+// 发送缓冲计数：写入时计入，交给 WebSocket 写队列或 POST 完成后释放
+- (void)retainOutboundBytes:(NSUInteger)length;
+- (void)releaseOutboundBytes:(NSUInteger)length;
+/// WebSocket 写队列字节数变化，只作为检查 drain 的触发
+- (void)socketBufferedAmountDidChange;
+/// 丢弃 postWait/probeWait 并释放其计数（engineQueue 上调用）
+- (void)discardOutboundBuffers;
 
 // 错误处理
 - (void)didError:(NSString *)reason;
@@ -112,10 +163,23 @@ typedef enum : NSUInteger{
 - (void)cancelConnectionTimeout;
 - (void)handleConnectionTimeout;
 
+// 直连 WebSocket 与轮询握手竞速
+- (void)startPollingHandshake;
+- (void)cancelWebSocketFallback;
+/// 直连 WebSocket 第一帧的 open 包
+- (void)handleWebSocketOpen:(NSString *)openData;
+
+/// 把连接阶段时间点交给客户端（timestamp 为单调时钟纳秒，0 表示未到达，忽略）
+- (void)reportConnectionPhase:(RTCVPConnectionPhase)phase atTime:(uint64_t)timestamp;
+
+/// 把一次往返时延（秒）交给客户端，用于 RTT 估算
+- (void)reportRoundTrip:(NSTimeInterval)rtt;
+
 - (void)log:(NSString *)message level:(RTCLogLevel)level;
 
 - (void)log:(NSString *)message type:(NSString *)type level:(RTCLogLevel)level;
 
-/// 延迟重连
-- (void)delayReconnect;
+/// 该级别日志是否会输出，供 RTCVPEngineLog 宏在格式化前判断
+- (BOOL)isLogEnabledForLevel:(RTCLogLevel)level;
+
 @end
@@ -9,6 +9,7 @@
 #import <Foundation/Foundation.h>
 #import "RTCVPSocketEngineProtocol.h"
 #import "RTCVPSocketIOConfig.h"
+#import "RTCVPSocketMetrics.h"
 
 
 @interface RTCVPSocketEngine : NSObject<RTCVPSocketEngineProtocol>
@@ -16,6 +17,9 @@
 /// 配置对象
 @property (nonatomic, strong, readonly) RTCVPSocketIOConfig *config;
 
+/// 传输层计数器（各传输的收发字节数和包数），无锁更新
+@property (nonatomic, strong, readonly) RTCVPSocketMetrics *metrics;
+
 /// 创建引擎
 + (instancetype)engineWithClient:(id<RTCVPSocketEngineClient>)client
                              url:(NSURL *)url
@@ -31,4 +35,7 @@
 
 /// 获取当前传输类型
 - (NSString *)currentTransport;
+
+/// 采样 postWait/probeWait 的深度（在 engineQueue 上读取，可在任意线程调用）
+- (void)getPostWaitDepth:(NSUInteger *)postWaitDepth probeWaitDepth:(NSUInteger *)probeWaitDepth;
 @end
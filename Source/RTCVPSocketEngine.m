@@ -8,19 +8,31 @@
 
 #import "RTCVPSocketEngine.h"
 #import "NSString+RTCVPSocketIO.h"
-#import "RTCVPStringReader.h"
 #import "RTCDefaultSocketLogger.h"
 #import "RTCVPSocketEngine+Private.h"
 #import "RTCVPSocketEngine+EnginePollable.h"
 #import "RTCVPSocketEngine+EngineWebsocket.h"
 #import "RTCVPSocketIOConfig.h"
+#import "RTCVPSocketPacket.h"
 #import "RTCVPProbe.h"
 #import "RTCVPTimeoutManager.h"
 #import "RTCVPTimer.h"
+#import <stdatomic.h>
 
+/// 附件总字节数，计入发送缓冲
+static NSUInteger RTCVPAttachmentsLength(NSArray<NSData *> *data) {
+    NSUInteger length = 0;
+    for (NSData *binary in data) {
+        length += binary.length;
+    }
+    return length;
+}
 
 @interface RTCVPSocketEngine()<RTCJFRWebSocketDelegate,
-NSURLSessionDelegate>
+NSURLSessionDelegate> {
+    atomic_llong _queuedBytes;          // 引擎持有的待发字节（engineQueue 排队、probeWait、postWait、POST 中）
+    atomic_bool _needsDrain;            // 超过高水位后等待回落
+}
 
 
 @property (nonatomic, strong) NSString *socketPath;
@@ -29,8 +41,6 @@ NSURLSessionDelegate>
 
 @property (nonatomic, assign) int protocolVersion;
 
-@property(nonatomic, assign)NSUInteger reconnectAttempts;
-
 @end
 
 
@@ -65,6 +75,8 @@ NSURLSessionDelegate>
         _client = client;
         _url = url;
         _config = config ?: [RTCVPSocketIOConfig defaultConfig];
+        atomic_init(&_queuedBytes, 0);
+        atomic_init(&_needsDrain, false);
         
         // 设置日志
         if (self.config.logger) {
@@ -119,6 +131,8 @@ NSURLSessionDelegate>
     _sid = @"";
     _postWait = [NSMutableArray array];
     _probeWait = [NSMutableArray array];
+    _postGroup = dispatch_group_create();
+    _metrics = [[RTCVPSocketMetrics alloc] init];
     
     // 设置心跳参数
     _pingInterval = self.config.pingInterval * 1000; // 转换为毫秒
@@ -126,8 +140,6 @@ NSURLSessionDelegate>
     _pongsMissed = 0;
     _pongsMissedMax = MAX(1, _pingTimeout / _pingInterval);
     
-    self.reconnectAttempts = 0;
-    
 //    dispatch_queue_t networkQueue = dispatch_queue_create("com.vpsocketio.network", DISPATCH_QUEUE_CONCURRENT);
     
     NSOperationQueue *sessionQueue = [[NSOperationQueue alloc] init];
@@ -136,11 +148,13 @@ NSURLSessionDelegate>
     sessionQueue.name = @"com.vpsocketio.session.queue";
     
     NSURLSessionConfiguration *sessionConfig = [NSURLSessionConfiguration defaultSessionConfiguration];
-    sessionConfig.HTTPMaximumConnectionsPerHost = 4;
+    // 轮询同时只有一个 GET 和一个 POST，各占一条保活连接；
+    // 不用 HTTP pipelining，否则 POST 会排在挂起的长轮询 GET 后面
+    sessionConfig.HTTPMaximumConnectionsPerHost = 2;
     sessionConfig.timeoutIntervalForRequest = 30;
     sessionConfig.timeoutIntervalForResource = 300;
     sessionConfig.requestCachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
-    sessionConfig.HTTPShouldUsePipelining = YES;
+    sessionConfig.HTTPShouldUsePipelining = NO;
     
     _session = [NSURLSession sessionWithConfiguration:sessionConfig
                                              delegate:self.config.sessionDelegate ?: self
@@ -227,8 +241,8 @@ NSURLSessionDelegate>
     _urlPolling = pollingComponents.URL;
     _urlWebSocket = websocketComponents.URL;
     
-    [self log:[NSString stringWithFormat:@"Polling URL: %@", _urlPolling] level:RTCLogLevelDebug];
-    [self log:[NSString stringWithFormat:@"WebSocket URL: %@", _urlWebSocket] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"Polling URL: %@", _urlPolling);
+    RTCVPEngineLogDebug(@"WebSocket URL: %@", _urlWebSocket);
 }
 
 - (NSString *)buildQueryString:(NSDictionary *)params {
@@ -265,6 +279,14 @@ NSURLSessionDelegate>
     [self log:message type:self.logType level:level];
 }
 
+- (BOOL)isLogEnabledForLevel:(RTCLogLevel)level {
+    if (!self.config.loggingEnabled || level > self.config.logLevel) {
+        return NO;
+    }
+    RTCVPSocketLogger *logger = self.config.logger ?: RTCDefaultSocketLogger.logger;
+    return [logger isEnabledForLevel:level];
+}
+
 - (void)log:(NSString *)message type:(NSString *)type level:(RTCLogLevel)level {
     if (self.config.loggingEnabled && level <= self.config.logLevel) {
         if (self.config.logger) {
@@ -297,11 +319,15 @@ NSURLSessionDelegate>
                                                  queue:self.engineQueue
                                                  block:^{ 
         __strong typeof(weakSelf) strongSelf = weakSelf;
-        // 只检测pong超时，不主动发送ping
-        // Engine.IO协议规定：只有服务器能发送ping，客户端只回复pong
+        // 检测pong超时；Engine.IO v4 只有服务器发送ping，客户端只回复pong
         if (strongSelf.pongsMissed >= strongSelf.pongsMissedMax) {
             [strongSelf log:@"Ping timeout (no pong received), closing connection" level:RTCLogLevelError];
             [strongSelf disconnect:@"ping timeout"];
+            return;
+        }
+        // Engine.IO v3 的心跳由客户端发起
+        if (strongSelf.config.protocolVersion == RTCVPSocketIOProtocolVersion2) {
+            [strongSelf sendPing];
         }
     }];
     
@@ -318,38 +344,15 @@ NSURLSessionDelegate>
     }
 }
 
-// 删除 sendPing 方法，客户端不应该主动发送ping（Engine.IO协议要求）
-// 只有服务器才能发送ping，客户端只负责回复pong
-/*
+/// Engine.IO v3 心跳：客户端发 ping，服务端回 pong；记下发送时间，收到 pong 时得到一次往返时延
 - (void)sendPing {
-    if (self.pongsMissed >= self.pongsMissedMax) {
-        [self log:@"Ping timeout, closing connection" level:RTCLogLevelError];
-        [self disconnect:@"ping timeout"];
-        return;
-    }
-    
     self.pongsMissed++;
+    self.pingSentAt = RTCVPMonotonicNanoseconds();
     
-    [self log:[NSString stringWithFormat:@"发送心跳，错过次数: %ld/%ld",
-               (long)self.pongsMissed, (long)self.pongsMissedMax]
-         level:RTCLogLevelDebug];
-    
-    // 发送Engine.IO心跳
-    NSString *pingMessage = @"";
-    if (self.config.protocolVersion >= RTCVPSocketIOProtocolVersion3) {
-        pingMessage = @"2"; // Engine.IO 4.x ping
-    }
-    [self write:pingMessage withType:RTCVPSocketEnginePacketTypePing withData:@[]];
+    RTCVPEngineLogDebug(@"发送心跳，错过次数: %ld/%ld", (long)self.pongsMissed, (long)self.pongsMissedMax);
     
-    // 同时发送WebSocket协议心跳（如果使用WebSocket）
-    if (self.websocket && self.ws && [self.ws isConnected]) {
-        if (self.config.protocolVersion >= RTCVPSocketIOProtocolVersion3) {
-            pingMessage = [NSString stringWithFormat:@"%@%@",@(RTCVPSocketEnginePacketTypePing),pingMessage]; // Engine.IO 4.x ping
-        }
-        
-        [self.ws writePing:[NSData dataWithBytes:[pingMessage UTF8String] length:[pingMessage length]]]; // 发送空的WebSocket Ping
-    }
-}*/
+    [self write:@"" withType:RTCVPSocketEnginePacketTypePing withData:@[]];
+}
 
 
 
@@ -385,6 +388,9 @@ NSURLSessionDelegate>
             [self log:@"WebSocket probe timeout" level:RTCLogLevelWarning];
             self.probing = NO;
             // 清理探测等待队列
+            for (RTCVPProbe *probe in self.probeWait) {
+                [self releaseOutboundBytes:probe.byteCount];
+            }
             [self.probeWait removeAllObjects];
         }
     });
@@ -425,6 +431,39 @@ NSURLSessionDelegate>
     });
 }
 
+#pragma mark - WebSocket 直连回退
+
+- (void)startWebSocketFallback {
+    [self cancelWebSocketFallback];
+    
+    __weak typeof(self) weakSelf = self;
+    self.websocketFallbackTaskId = [[RTCVPTimeoutManager sharedManager]
+                                   scheduleTimeout:MAX(self.config.websocketFallbackDelay, 0)
+                                   identifier:@"WebSocketFallback"
+                                   timeoutBlock:^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        [strongSelf handleWebSocketFallback];
+    }];
+}
+
+- (void)cancelWebSocketFallback {
+    if (self.websocketFallbackTaskId) {
+        [[RTCVPTimeoutManager sharedManager] cancelTask:self.websocketFallbackTaskId];
+        self.websocketFallbackTaskId = nil;
+    }
+}
+
+- (void)handleWebSocketFallback {
+    dispatch_async(self.engineQueue, ^{
+        self.websocketFallbackTaskId = nil;
+        // WebSocket 直连迟迟没有 open 包（代理拦截、握手慢），并行发起轮询握手
+        if (self.directWebSocket && !self.connected && !self.closed && !self.polling) {
+            [self log:@"WebSocket handshake slow, racing polling handshake" level:RTCLogLevelInfo];
+            [self startPollingHandshake];
+        }
+    });
+}
+
 #pragma mark - 连接管理
 
 - (void)connect {
@@ -444,7 +483,7 @@ NSURLSessionDelegate>
         [self resetEngine];
     }
     
-    [self log:[NSString stringWithFormat:@"Starting connection to: %@", self.url.absoluteString] level:RTCLogLevelInfo];
+    RTCVPEngineLog(RTCLogLevelInfo, @"Starting connection to: %@", self.url.absoluteString);
     
     // 开始连接超时计时
     [self startConnectionTimeout];
@@ -453,65 +492,40 @@ NSURLSessionDelegate>
     switch (self.config.transport) {
         case RTCVPSocketIOTransportWebSocket:{
             [self log:@"Using WebSocket transport" level:RTCLogLevelInfo];
+            // 直接以 transport=websocket 握手，open 包是第一帧
             self.polling = NO;
-            self.websocket = YES;
-            
-            // 创建并连接WebSocket
+            self.directWebSocket = YES;
             [self createWebSocketAndConnect];
         }
             break;
             
         case RTCVPSocketIOTransportPolling:{
             [self log:@"Using Polling transport" level:RTCLogLevelInfo];
-            // 开始轮询握手
-            NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:self.urlPolling];
-            request.timeoutInterval = self.config.connectTimeout;
-            [self addHeadersToRequest:request];
-            
-            [self doLongPoll:request];
+            [self startPollingHandshake];
         }
             break;
             
         case RTCVPSocketIOTransportAuto: {
             [self log:@"Using Auto transport" level:RTCLogLevelInfo];
-            // 自动协商传输方式，默认使用轮询握手
-            NSMutableURLRequest *autoRequest = [NSMutableURLRequest requestWithURL:self.urlPolling];
-            autoRequest.timeoutInterval = self.config.connectTimeout;
-            [self addHeadersToRequest:autoRequest];
-            
-            [self doLongPoll:autoRequest];
+            // WebSocket 直连先行，领先时间内没完成（或直接失败）才发起轮询握手
+            self.polling = NO;
+            self.directWebSocket = YES;
+            [self createWebSocketAndConnect];
+            [self startWebSocketFallback];
         }
             break;
     }
 }
 
-/// 延迟重连
-- (void)delayReconnect {
-    // 计算指数退避延迟
-    NSTimeInterval delay = [self calculateReconnectDelay];
-    
-    [self log:[NSString stringWithFormat:@"计划在 %.1f 秒后重连...", delay] level:RTCLogLevelInfo];
+/// 轮询握手：GET transport=polling，open 包在响应里
+- (void)startPollingHandshake {
+    self.polling = YES;
     
-    // 使用定时器延迟重连
-    __weak typeof(self) weakSelf = self;
-    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)),
-                  self.engineQueue, ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (strongSelf && !strongSelf.closed && !strongSelf.connected) {
-            strongSelf.reconnectAttempts ++;
-            [strongSelf log:@"执行重连..." level:RTCLogLevelInfo];
-            [strongSelf connect];
-        }
-    });
-}
-
-- (NSTimeInterval)calculateReconnectDelay {
-    // 指数退避算法：base * 2^(attempt-1)，最大60秒
-    NSTimeInterval baseDelay = 2.0;
-    NSTimeInterval maxDelay = 60.0;
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:self.urlPolling];
+    request.timeoutInterval = self.config.connectTimeout;
+    [self addHeadersToRequest:request];
     
-    NSTimeInterval delay = baseDelay * pow(2, self.reconnectAttempts - 1);
-    return MIN(delay, maxDelay);
+    [self doLongPoll:request];
 }
 
 - (void)disconnect:(NSString *)reason {
@@ -529,7 +543,7 @@ NSURLSessionDelegate>
         return;
     }
     
-    [self log:[NSString stringWithFormat:@"Disconnecting: %@", reason] level:RTCLogLevelInfo];
+    RTCVPEngineLog(RTCLogLevelInfo, @"Disconnecting: %@", reason);
     
     // 发送关闭消息
     if (isConnected && !isClosed) {
@@ -550,6 +564,7 @@ NSURLSessionDelegate>
     [self stopPingTimer];
     [self cancelProbeTimeout];
     [self cancelConnectionTimeout];
+    [self cancelWebSocketFallback];
     
     self.closed = NO;
     self.connected = NO;
@@ -557,10 +572,14 @@ NSURLSessionDelegate>
     self.polling = YES;
     self.websocket = NO;
     self.probing = NO;
+    self.directWebSocket = NO;
     self.invalidated = NO;
     self.sid = @"";
     self.waitingForPoll = NO;
     self.waitingForPost = NO;
+    self.postFlushScheduled = NO;
+    self.pollingURLTemplate = nil;
+    self.handshakeTask = nil;
     
     // 清理现有连接
     if (self.ws) {
@@ -574,8 +593,7 @@ NSURLSessionDelegate>
         self.session = nil;
     }
     
-    [self.postWait removeAllObjects];
-    [self.probeWait removeAllObjects];
+    [self discardOutboundBuffers];
     
     // 重新创建 URLSession
     [self setupEngine];
@@ -590,7 +608,7 @@ NSURLSessionDelegate>
         return;
     }
     
-    [self log:[NSString stringWithFormat:@"Got binary data, length: %lu", (unsigned long)data.length] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"Got binary data, length: %lu", (unsigned long)data.length);
     
     // 直接处理数据作为有效负载，因为WebSocket帧的有效负载已经在EngineWebsocket分类中提取过了
     [self processEngineBinaryPayload:data];
@@ -602,7 +620,7 @@ NSURLSessionDelegate>
         return;
     }
     
-    [self log:[NSString stringWithFormat:@"Processing binary payload, length: %lu", (unsigned long)payload.length] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"Processing binary payload, length: %lu", (unsigned long)payload.length);
     
     // 根据协议版本处理二进制数据
     if (self.config.protocolVersion == RTCVPSocketIOProtocolVersion2) {
@@ -615,19 +633,19 @@ NSURLSessionDelegate>
             if (firstByte == 0x04) {
                 // 提取实际的二进制数据
                 NSData *actualData = [payload subdataWithRange:NSMakeRange(1, payload.length - 1)];
-                [self log:[NSString stringWithFormat:@"Engine.IO 3.x binary data, length: %lu", (unsigned long)actualData.length] level:RTCLogLevelDebug];
+                RTCVPEngineLogDebug(@"Engine.IO 3.x binary data, length: %lu", (unsigned long)actualData.length);
                 
                 // 传递给客户端处理
                 if (self.client) {
                     [self.client parseEngineBinaryData:actualData];
                 }
             } else {
-                [self log:[NSString stringWithFormat:@"Unknown binary packet type: 0x%02X", firstByte] level:RTCLogLevelWarning];
+                RTCVPEngineLog(RTCLogLevelWarning, @"Unknown binary packet type: 0x%02X", firstByte);
             }
         }
     } else {
         // Engine.IO 4.x+ 协议：直接是二进制数据
-        [self log:[NSString stringWithFormat:@"Engine.IO 4.x binary data, length: %lu", (unsigned long)payload.length] level:RTCLogLevelDebug];
+        RTCVPEngineLogDebug(@"Engine.IO 4.x binary data, length: %lu", (unsigned long)payload.length);
         
         // 直接传递给客户端处理
         if (self.client) {
@@ -637,17 +655,17 @@ NSURLSessionDelegate>
 }
 
 /// 处理 Base64 编码的二进制数据
-- (void)handleBase64:(NSString *)message {
-    if (message.length <= 2) {
+- (void)handleBase64:(NSString *)message prefixLength:(NSUInteger)prefixLength {
+    if (message.length <= prefixLength) {
         [self log:@"Invalid base64 message, too short" level:RTCLogLevelWarning];
         return;
     }
     
-    NSString *base64String = [message substringFromIndex:2];
+    NSString *base64String = [message substringFromIndex:prefixLength];
     NSData *data = [[NSData alloc] initWithBase64EncodedString:base64String options:NSDataBase64DecodingIgnoreUnknownCharacters];
     
     if (data) {
-        [self log:[NSString stringWithFormat:@"Decoded base64 data, length: %lu", (unsigned long)data.length] level:RTCLogLevelDebug];
+        RTCVPEngineLogDebug(@"Decoded base64 data, length: %lu", (unsigned long)data.length);
         
         if (self.client) {
             [self.client parseEngineBinaryData:data];
@@ -657,6 +675,20 @@ NSURLSessionDelegate>
     }
 }
 
+/// 直连 WebSocket 收到 open 包：WebSocket 赢得竞速，取消轮询握手
+- (void)handleWebSocketOpen:(NSString *)openData {
+    [self cancelWebSocketFallback];
+    self.directWebSocket = NO;
+    [self.handshakeTask cancel];
+    self.handshakeTask = nil;
+    self.waitingForPoll = NO;
+    self.polling = NO;
+    self.websocket = YES;
+    
+    [self handleOpen:openData];
+    [self startPingTimer];
+}
+
 /// 处理打开消息
 - (void)handleOpen:(NSString *)openData {
     NSDictionary *json = [openData toDictionary];
@@ -672,8 +704,21 @@ NSURLSessionDelegate>
         return;
     }
     
+    [self reportConnectionPhase:RTCVPConnectionPhaseEngineOpen atTime:RTCVPMonotonicNanoseconds()];
+    
     // 连接成功，取消连接超时
     [self cancelConnectionTimeout];
+    self.handshakeTask = nil;
+    
+    if (self.directWebSocket) {
+        // 轮询握手先完成：直连的 WebSocket 在服务端是另一个会话，直接放弃
+        [self log:@"Polling handshake won the race, dropping direct WebSocket" level:RTCLogLevelInfo];
+        [self cancelWebSocketFallback];
+        self.directWebSocket = NO;
+        self.ws.delegate = nil;
+        [self.ws disconnect];
+        self.ws = nil;
+    }
     
     self.sid = sid;
     self.connected = YES;
@@ -696,27 +741,32 @@ NSURLSessionDelegate>
         self.pongsMissedMax = MAX(1, self.pingTimeout / self.pingInterval);
     }
     
-    [self log:[NSString stringWithFormat:@"Connected with sid: %@", self.sid] level:RTCLogLevelInfo];
-    [self log:[NSString stringWithFormat:@"Ping interval: %ldms, timeout: %ldms", (long)self.pingInterval, (long)self.pingTimeout] level:RTCLogLevelDebug];
+    RTCVPEngineLog(RTCLogLevelInfo, @"Connected with sid: %@", self.sid);
+    RTCVPEngineLogDebug(@"Ping interval: %ldms, timeout: %ldms", (long)self.pingInterval, (long)self.pingTimeout);
     
     // 决定是否使用 WebSocket
     BOOL shouldUseWebSocket = NO;
     
-    switch (self.config.transport) {
-        case RTCVPSocketIOTransportWebSocket:
-            // 强制WebSocket，直接使用
-            shouldUseWebSocket = YES;
-            break;
+    if (self.websocket) {
+        // open 包来自直连 WebSocket（服务端此时给的 upgrades 为空）
+        shouldUseWebSocket = YES;
+    } else {
+        switch (self.config.transport) {
+            case RTCVPSocketIOTransportWebSocket:
+                // 强制WebSocket，直接使用
+                shouldUseWebSocket = YES;
+                break;
             
-        case RTCVPSocketIOTransportAuto:
-            // 自动模式，根据服务器支持决定
-            shouldUseWebSocket = canUpgradeToWebSocket;
-            break;
+            case RTCVPSocketIOTransportAuto:
+                // 自动模式，根据服务器支持决定
+                shouldUseWebSocket = canUpgradeToWebSocket;
+                break;
             
-        case RTCVPSocketIOTransportPolling:
-            // 强制轮询，不使用WebSocket
-            shouldUseWebSocket = NO;
-            break;
+            case RTCVPSocketIOTransportPolling:
+                // 强制轮询，不使用WebSocket
+                shouldUseWebSocket = NO;
+                break;
+        }
     }
     
     if (shouldUseWebSocket) {
@@ -750,29 +800,83 @@ NSURLSessionDelegate>
 }
 
 - (void)__sendConnectToServer{
-    // V2 客户端不用发
-    if (_config.protocolVersion < RTCVPSocketIOProtocolVersion3) {
-        return;
+    id<RTCVPSocketEngineClient> client = self.client;
+    BOOL v2 = _config.protocolVersion < RTCVPSocketIOProtocolVersion3;
+    NSArray<NSString *> *namespaces = nil;
+    if ([client respondsToSelector:@selector(engineNamespacesToConnect)]) {
+        // 多命名空间共用引擎：所有命名空间的 connect 包一起发出
+        namespaces = [client engineNamespacesToConnect];
+    } else {
+        // V2 客户端不用发
+        if (v2) {
+            return;
+        }
+        namespaces = @[self.config.namespace ?: @"/"];
     }
-    // 在handleOpen方法末尾添加命名空间加入逻辑
+    
     // 发送命名空间加入请求（Socket.IO connect packet）
     // 格式：Engine.IO消息类型4 + Socket.IO连接类型0
-    NSString *namespace = self.config.namespace ?: @"/";
-    if ([namespace isEqualToString:@"/"]) {
-        // 加入默认命名空间，发送Socket.IO connect packet: "0"
-        [self write:@"0" withType:RTCVPSocketEnginePacketTypeMessage withData:@[]];
-        [self log:@"📤 已发送默认命名空间加入请求: 0" level:RTCLogLevelInfo];
-    } else {
-        // 加入自定义命名空间，发送Socket.IO connect packet: "0/namespace"
-        NSString *joinMessage = [NSString stringWithFormat:@"0%@", namespace];
-        [self write:joinMessage withType:RTCVPSocketEnginePacketTypeMessage withData:@[]];
-        [self log:[NSString stringWithFormat:@"📤 已发送命名空间加入请求: %@", joinMessage] level:RTCLogLevelInfo];
+    BOOL encodesToBinary = self.config.parser.encodesToBinary;
+    NSMutableArray<NSData *> *messages = [NSMutableArray arrayWithCapacity:namespaces.count];
+    NSUInteger length = 0;
+    for (NSString *namespace in namespaces) {
+        // V2 服务端自动加入默认命名空间
+        if (v2 && [namespace isEqualToString:@"/"]) {
+            continue;
+        }
+        // 连接状态恢复：客户端保存的 pid/offset 放在 connect 包负载里
+        NSDictionary *payload = nil;
+        if ([client respondsToSelector:@selector(engineConnectPayloadForNamespace:)]) {
+            payload = [client engineConnectPayloadForNamespace:namespace];
+        }
+        RTCVPSocketPacket *packet = [[RTCVPSocketPacket alloc] initWithType:RTCVPPacketTypeConnect
+                                                                       data:payload ? @[payload] : @[]
+                                                                   packetId:-1
+                                                                        nsp:namespace
+                                                               placeholders:0
+                                                                     binary:@[]];
+        NSMutableData *message = [NSMutableData data];
+        if (encodesToBinary) {
+            // 二进制编码格式：connect 包同样由解析器编码成一个二进制帧
+            [self.config.parser encodePacket:packet intoBuffer:message];
+        } else {
+            // 默认命名空间为 "40"，自定义命名空间为 "40/namespace,"，带恢复参数时追加 JSON 负载
+            const uint8_t enginePrefix = '0' + RTCVPSocketEnginePacketTypeMessage;
+            [message appendBytes:&enginePrefix length:1];
+            [message appendData:[packet.packetString dataUsingEncoding:NSUTF8StringEncoding]];
+        }
+        [messages addObject:message];
+        length += message.length;
+        RTCVPEngineLog(RTCLogLevelInfo, @"📤 已发送命名空间加入请求: %@", namespace);
+    }
+    if (messages.count == 0) {
+        return;
     }
+    
+    if (self.websocket || self.probing) {
+        // WebSocket 帧本来就按顺序连续写出
+        for (NSData *message in messages) {
+            if (encodesToBinary) {
+                [self writeBinaryMessage:message];
+            } else {
+                [self writeEncoded:message withData:@[]];
+            }
+        }
+        return;
+    }
+    
+    // 轮询：全部放进同一个 POST，而不是第一个 connect 包单独发出、其余等它完成
+    [self retainOutboundBytes:length];
+    self.postWaitBytes += length;
+    for (NSData *message in messages) {
+        [self.postWait addObject:encodesToBinary ? [RTCVPPollBinaryPacket packetWithData:message] : message];
+    }
+    [self flushWaitingForPost];
 }
 
 /// 处理普通消息
 - (void)handleMessage:(NSString *)message {
-    [self log:[NSString stringWithFormat:@"Handling message: %@", message] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"Handling message: %@", message);
     
     if (self.client) {
         [self.client parseEngineMessage:message];
@@ -806,8 +910,7 @@ NSURLSessionDelegate>
 
 // 修改 handlePong 方法，处理两种心跳响应
 - (void)handlePong:(NSString *)message {
-    [self log:[NSString stringWithFormat:@"收到心跳响应: %@", message]
-         level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"收到心跳响应: %@", message);
     
     // 重置心跳计数器
     self.pongsMissed = 0;
@@ -816,6 +919,17 @@ NSURLSessionDelegate>
     if ([message isEqualToString:@"probe"]) {
         [self log:@"收到WebSocket探测响应，升级传输" level:RTCLogLevelInfo];
         [self upgradeTransport];
+        return;
+    }
+    
+    // Engine.IO v3 心跳的 pong：从发出 ping 到现在是一次往返，WebSocket 和轮询都适用
+    uint64_t sentAt = self.pingSentAt;
+    self.pingSentAt = 0;
+    uint64_t now = RTCVPMonotonicNanoseconds();
+    if (sentAt != 0 && now > sentAt) {
+        NSTimeInterval rtt = (double)(now - sentAt) / NSEC_PER_SEC;
+        RTCVPEngineLogDebug(@"心跳往返时延: %.1fms", rtt * 1000);
+        [self reportRoundTrip:rtt];
     }
 }
 
@@ -826,7 +940,7 @@ NSURLSessionDelegate>
         self.fastUpgrade = YES;
         
         // 无论是Engine.IO 3.x还是4.x，都发送 "2probe" 作为探测包
-        [self.ws writeString:@"2probe"];
+        [self.ws writeString:@"2probe" priority:RTCJFRWritePriorityControl];
         [self log:@"Sent WebSocket probe: 2probe" level:RTCLogLevelDebug];
     } else {
         [self log:@"Cannot upgrade, WebSocket not connected" level:RTCLogLevelWarning];
@@ -836,7 +950,7 @@ NSURLSessionDelegate>
 #pragma mark - 错误处理
 
 - (void)didError:(NSString *)reason {
-    [self log:[NSString stringWithFormat:@"Engine error: %@", reason] level:RTCLogLevelError];
+    RTCVPEngineLog(RTCLogLevelError, @"Engine error: %@", reason);
     
     if (self.client && !self.closed) {
         [self.client engineDidError:reason];
@@ -844,6 +958,9 @@ NSURLSessionDelegate>
     
     if (self.connected) {
         [self disconnect:reason];
+    } else if (!self.closed) {
+        // 握手阶段失败：关闭引擎，何时重试由客户端的重连调度器决定
+        [self closeOutEngine:reason];
     }
 }
 
@@ -1013,86 +1130,104 @@ NSURLSessionDelegate>
         
         [self write:ackMessage withType:RTCVPSocketEnginePacketTypeMessage withData:data];
         
-        [self log:[NSString stringWithFormat:@"Sent ACK response: %@", ackMessage] level:RTCLogLevelDebug];
+        RTCVPEngineLogDebug(@"Sent ACK response: %@", ackMessage);
     });
 }
 
 #pragma mark - 消息解析（增强版）
 
 /// 解析原始引擎消息（增强版，支持ACK）
+/// 只看第一个字符分发，'4' 开头的 Socket.IO 负载原样交给客户端，不做任何 JSON 解析
 - (void)parseEngineMessage:(NSString *)message {
     if (message.length == 0) {
         [self log:@"Received empty message" level:RTCLogLevelWarning];
         return;
     }
     
-    [self log:[NSString stringWithFormat:@"parseEngineMessage Got message: %@", message] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"parseEngineMessage Got message: %@", message);
+    
+    unichar firstChar = [message characterAtIndex:0];
     
     // 检查是否为二进制消息前缀
-    if ([message hasPrefix:@"b4"]) {
-        [self handleBase64:message];
+    // Engine.IO v3 轮询：b4<base64>；Engine.IO v4 轮询：b<base64>
+    if (firstChar == 'b') {
+        if (self.config.protocolVersion == RTCVPSocketIOProtocolVersion2) {
+            if ([message hasPrefix:@"b4"]) {
+                [self handleBase64:message prefixLength:2];
+            } else {
+                [self log:@"Unsupported binary message prefix" level:RTCLogLevelWarning];
+            }
+        } else {
+            [self handleBase64:message prefixLength:1];
+        }
         return;
     }
     
-    // 检查是否为错误消息
-    NSDictionary *errorDict = [message toDictionary];
-    if (errorDict && errorDict[@"message"]) {
-        [self didError:errorDict[@"message"]];
+    // 引擎包都以类型数字开头，只有服务端错误对象（{"code":..,"message":..}）以 '{' 开头
+    if (firstChar == '{') {
+        NSDictionary *errorDict = [message toDictionary];
+        NSString *errorMessage = errorDict[@"message"];
+        if ([errorMessage isKindOfClass:[NSString class]]) {
+            [self didError:errorMessage];
+        } else {
+            // 可能是字符串消息（没有类型前缀）
+            [self handleMessage:message];
+        }
+        return;
+    }
+    
+    if (firstChar < '0' || firstChar > '9') {
+        // 可能是字符串消息（没有类型前缀）
+        [self handleMessage:message];
         return;
     }
     
     // 解析消息类型
-    if (message.length > 0) {
-        unichar firstChar = [message characterAtIndex:0];
-        if (firstChar >= '0' && firstChar <= '9') {
-            RTCVPSocketEnginePacketType type = firstChar - '0';
-            NSString *content = [message substringFromIndex:1];
+    RTCVPSocketEnginePacketType type = firstChar - '0';
+    NSString *content = [message substringFromIndex:1];
+    
+    switch (type) {
+        case RTCVPSocketEnginePacketTypeMessage:
+            // 最常见的包放在最前：直接传递消息给客户端，由客户端处理ACK
+            [self handleMessage:content];
+            break;
+        case RTCVPSocketEnginePacketTypeOpen:
+            [self handleOpen:content];
+            break;
+        case RTCVPSocketEnginePacketTypeClose:
+            [self handleClose:content];
+            break;
+        case RTCVPSocketEnginePacketTypePing:
+            // 服务器发送的 ping，必须立即回复 pong
+            RTCVPEngineLog(RTCLogLevelInfo, @"📩 收到Engine.IO ping消息，立即回复pong");
             
-            switch (type) {
-                case RTCVPSocketEnginePacketTypeOpen:
-                    [self handleOpen:content];
-                    break;
-                case RTCVPSocketEnginePacketTypeClose:
-                    [self handleClose:content];
-                    break;
-                case RTCVPSocketEnginePacketTypePing:
-                    // 服务器发送的 ping，必须立即回复 pong
-                    [self log:[NSString stringWithFormat:@"📩 收到Engine.IO ping消息，立即回复pong"] level:RTCLogLevelInfo];
-                    
-                    // 直接同步发送pong响应，不使用sendWebSocketMessage避免重复添加类型前缀
-                    if (self.websocket && self.ws && [self.ws isConnected]) {
-                        // 直接发送pong消息: "3"，不使用sendWebSocketMessage避免重复添加类型前缀
-                        [self.ws writeString:@"3"];
-                        [self log:@"📤 已立即发送pong响应: 3" level:RTCLogLevelInfo];
-                    } else {
-                        // 那就是轮训发送消息
-                        [self.postWait addObject:@"3"];
-                        //强制刷新
-                        [self flushWaitingForPost];
-                        [self log:@"📤 使用异步队列发送pong响应" level:RTCLogLevelInfo];
-                    }
-                    break;
-                case RTCVPSocketEnginePacketTypePong:
-                    [self handlePong:content];
-                    break;
-                case RTCVPSocketEnginePacketTypeMessage:
-                    // 直接传递消息给客户端，由客户端处理ACK
-                    [self handleMessage:content];
-                    break;
-                case RTCVPSocketEnginePacketTypeUpgrade:
-                    [self handleUpgrade];
-                    break;
-                case RTCVPSocketEnginePacketTypeNoop:
-                    [self handleNoop];
-                    break;
-                default:
-                    [self log:[NSString stringWithFormat:@"Unknown packet type: %c", firstChar] level:RTCLogLevelWarning];
-                    break;
+            // 直接同步发送pong响应，不使用sendWebSocketMessage避免重复添加类型前缀
+            if (self.websocket && self.ws && [self.ws isConnected]) {
+                // 直接发送pong消息: "3"，走控制通道，不排在大数据后面
+                [self.ws writeString:@"3" priority:RTCJFRWritePriorityControl];
+                [self log:@"📤 已立即发送pong响应: 3" level:RTCLogLevelInfo];
+                // Engine.IO v4 的心跳由服务端发起，客户端测不到往返时延，借这个时机发一个 WebSocket ping
+                [self sendWebSocketRTTPing];
+            } else {
+                // 那就是轮训发送消息
+                [self.postWait addObject:[NSData dataWithBytes:"3" length:1]];
+                //强制刷新
+                [self flushWaitingForPost];
+                [self log:@"📤 使用异步队列发送pong响应" level:RTCLogLevelInfo];
             }
-        } else {
-            // 可能是字符串消息（没有类型前缀）
-            [self handleMessage:message];
-        }
+            break;
+        case RTCVPSocketEnginePacketTypePong:
+            [self handlePong:content];
+            break;
+        case RTCVPSocketEnginePacketTypeUpgrade:
+            [self handleUpgrade];
+            break;
+        case RTCVPSocketEnginePacketTypeNoop:
+            [self handleNoop];
+            break;
+        default:
+            RTCVPEngineLog(RTCLogLevelWarning, @"Unknown packet type: %c", firstChar);
+            break;
     }
 }
 
@@ -1113,20 +1248,24 @@ NSURLSessionDelegate>
         return;
     }
     
-    [self log:[NSString stringWithFormat:@"Closing engine: %@", reason] level:RTCLogLevelInfo];
+    RTCVPEngineLog(RTCLogLevelInfo, @"Closing engine: %@", reason);
     
     // 停止所有定时器
     [self stopPingTimer];
     [self cancelProbeTimeout];
     [self cancelConnectionTimeout];
+    [self cancelWebSocketFallback];
     
     // 保护状态变量修改
     [self.stateLock lock];
     self.closed = YES;
     self.connected = NO;
     self.invalidated = YES;
+    self.directWebSocket = NO;
     self.pongsMissed = 0;
+    self.pingSentAt = 0;
     [self.stateLock unlock];
+    self.handshakeTask = nil;
     
     // 清理资源
     if (self.ws) {
@@ -1141,8 +1280,7 @@ NSURLSessionDelegate>
     }
     
     // 清理缓冲区
-    [self.postWait removeAllObjects];
-    [self.probeWait removeAllObjects];
+    [self discardOutboundBuffers];
     
     // 通知客户端
     if (self.client) {
@@ -1153,35 +1291,254 @@ NSURLSessionDelegate>
 #pragma mark - 发送消息
 
 - (void)write:(NSString *)msg withType:(RTCVPSocketEnginePacketType)type withData:(NSArray *)data {
+    NSUInteger length = [msg lengthOfBytesUsingEncoding:NSUTF8StringEncoding] + RTCVPAttachmentsLength(data);
+    [self retainOutboundBytes:length];
     dispatch_async(self.engineQueue, ^{
         if (!self.connected || self.closed) {
             [self log:@"Cannot write, engine not connected" level:RTCLogLevelWarning];
+            [self releaseOutboundBytes:length];
             return;
         }
         
         if (self.websocket) {
             [self sendWebSocketMessage:msg withType:type withData:data];
+            [self releaseOutboundBytes:length];
         } else if (self.probing) {
             // 在探测期间，缓存消息
             RTCVPProbe *probe = [[RTCVPProbe alloc] init];
             probe.message = msg;
             probe.type = type;
             probe.data = data;
+            probe.byteCount = length;
             [self.probeWait addObject:probe];
         } else {
+            self.postWaitBytes += length;
             [self sendPollMessage:msg withType:type withData:data];
         }
     });
 }
 
 
+- (void)writeEncoded:(NSData *)message withData:(NSArray *)data {
+    NSUInteger length = message.length + RTCVPAttachmentsLength(data);
+    [self retainOutboundBytes:length];
+    dispatch_async(self.engineQueue, ^{
+        if (!self.connected || self.closed) {
+            [self log:@"Cannot write, engine not connected" level:RTCLogLevelWarning];
+            [self releaseOutboundBytes:length];
+            return;
+        }
+        
+        if (self.websocket) {
+            [self sendWebSocketEncodedMessage:message withData:data];
+            [self releaseOutboundBytes:length];
+        } else if (self.probing) {
+            // 在探测期间，缓存消息
+            RTCVPProbe *probe = [[RTCVPProbe alloc] init];
+            probe.encodedMessage = message;
+            probe.type = RTCVPSocketEnginePacketTypeMessage;
+            probe.data = data;
+            probe.byteCount = length;
+            [self.probeWait addObject:probe];
+        } else {
+            self.postWaitBytes += length;
+            [self sendPollEncodedMessage:message withData:data];
+        }
+    });
+}
+
+- (void)writeBinaryMessage:(NSData *)message {
+    NSUInteger length = message.length;
+    [self retainOutboundBytes:length];
+    dispatch_async(self.engineQueue, ^{
+        if (!self.connected || self.closed) {
+            [self log:@"Cannot write, engine not connected" level:RTCLogLevelWarning];
+            [self releaseOutboundBytes:length];
+            return;
+        }
+        
+        if (self.websocket) {
+            [self sendWebSocketBinaryMessage:message];
+            [self releaseOutboundBytes:length];
+        } else if (self.probing) {
+            // 在探测期间，缓存消息
+            RTCVPProbe *probe = [[RTCVPProbe alloc] init];
+            probe.binaryMessage = message;
+            probe.type = RTCVPSocketEnginePacketTypeMessage;
+            probe.byteCount = length;
+            [self.probeWait addObject:probe];
+        } else {
+            self.postWaitBytes += length;
+            [self sendPollBinaryMessage:message];
+        }
+    });
+}
+
+/// 批量写出：统一成 postWait 的表示（NSData 文本帧，RTCVPPollBinaryPacket 二进制帧），整批只进一次 engineQueue
+- (void)writeMessages:(NSArray<NSData *> *)messages binary:(BOOL)binary withData:(NSArray<NSArray<NSData *> *> *)data {
+    NSMutableArray *frames = [NSMutableArray arrayWithCapacity:messages.count];
+    NSUInteger length = 0;
+    for (NSUInteger i = 0; i < messages.count; i++) {
+        NSData *message = messages[i];
+        [frames addObject:binary ? [RTCVPPollBinaryPacket packetWithData:message] : message];
+        length += message.length;
+        if (self.config.enableBinary && i < data.count) {
+            for (NSData *attachment in data[i]) {
+                [frames addObject:[RTCVPPollBinaryPacket packetWithData:attachment]];
+                length += attachment.length;
+            }
+        }
+    }
+    if (frames.count == 0) {
+        return;
+    }
+    
+    [self retainOutboundBytes:length];
+    dispatch_async(self.engineQueue, ^{
+        if (!self.connected || self.closed) {
+            [self log:@"Cannot write, engine not connected" level:RTCLogLevelWarning];
+            [self releaseOutboundBytes:length];
+            return;
+        }
+        
+        if (self.websocket) {
+            [self sendWebSocketFrames:frames];
+            [self releaseOutboundBytes:length];
+        } else if (self.probing) {
+            // 在探测期间，整批缓存，升级后仍一次写出
+            RTCVPProbe *probe = [[RTCVPProbe alloc] init];
+            probe.frames = frames;
+            probe.type = RTCVPSocketEnginePacketTypeMessage;
+            probe.byteCount = length;
+            [self.probeWait addObject:probe];
+        } else {
+            self.postWaitBytes += length;
+            [self sendPollFrames:frames];
+        }
+    });
+}
+
+#pragma mark - 指标
+
+- (void)getPostWaitDepth:(NSUInteger *)postWaitDepth probeWaitDepth:(NSUInteger *)probeWaitDepth {
+    __block NSUInteger postWait = 0;
+    __block NSUInteger probeWait = 0;
+    dispatch_block_t read = ^{
+        postWait = self.postWait.count;
+        probeWait = self.probeWait.count;
+    };
+    // 引擎回调里（engineQueue 上）取快照时直接读，避免同步到自身死锁
+    if (dispatch_get_specific((__bridge const void *)(self.engineQueue))) {
+        read();
+    } else {
+        dispatch_sync(self.engineQueue, read);
+    }
+    if (postWaitDepth) {
+        *postWaitDepth = postWait;
+    }
+    if (probeWaitDepth) {
+        *probeWaitDepth = probeWait;
+    }
+}
+
+#pragma mark - 连接阶段
+
+- (void)reportConnectionPhase:(RTCVPConnectionPhase)phase atTime:(uint64_t)timestamp {
+    if (timestamp == 0) {
+        return;
+    }
+    id<RTCVPSocketEngineClient> client = self.client;
+    if ([client respondsToSelector:@selector(engineDidReachConnectionPhase:atTime:)]) {
+        [client engineDidReachConnectionPhase:phase atTime:timestamp];
+    }
+}
+
+- (void)reportRoundTrip:(NSTimeInterval)rtt {
+    id<RTCVPSocketEngineClient> client = self.client;
+    if ([client respondsToSelector:@selector(engineDidMeasureRoundTrip:)]) {
+        [client engineDidMeasureRoundTrip:rtt];
+    }
+}
+
+#pragma mark - 发送缓冲
+
+- (NSUInteger)bufferedAmount {
+    long long queued = atomic_load_explicit(&_queuedBytes, memory_order_relaxed);
+    // WebSocket 写队列的字节直接读 jetfire 的原子计数；回调里带的快照来自入队线程和写线程，
+    // 到达顺序与计数顺序不一致，存下来会留住过期的大值
+    return (NSUInteger)MAX(queued, 0) + self.ws.bufferedAmount;
+}
+
+- (void)retainOutboundBytes:(NSUInteger)length {
+    atomic_fetch_add_explicit(&_queuedBytes, (long long)length, memory_order_relaxed);
+    if (self.bufferedAmount > self.config.highWaterMark) {
+        atomic_store_explicit(&_needsDrain, true, memory_order_relaxed);
+    }
+}
+
+- (void)releaseOutboundBytes:(NSUInteger)length {
+    if (length == 0) {
+        return;
+    }
+    atomic_fetch_sub_explicit(&_queuedBytes, (long long)length, memory_order_relaxed);
+    [self checkDrain];
+}
+
+- (void)socketBufferedAmountDidChange {
+    [self checkDrain];
+}
+
+/// 超过高水位后回落到低水位以下时只通知一次
+- (void)checkDrain {
+    if (!atomic_load_explicit(&_needsDrain, memory_order_relaxed)) {
+        return;
+    }
+    if (self.bufferedAmount > self.config.lowWaterMark) {
+        return;
+    }
+    bool expected = true;
+    if (atomic_compare_exchange_strong(&_needsDrain, &expected, false)) {
+        id<RTCVPSocketEngineClient> client = self.client;
+        if ([client respondsToSelector:@selector(engineDidDrain)]) {
+            [client engineDidDrain];
+        }
+    }
+}
+
+- (void)discardOutboundBuffers {
+    // 连接已关闭，丢弃的数据不算发送完成，不触发 drain
+    atomic_store_explicit(&_needsDrain, false, memory_order_relaxed);
+    
+    NSUInteger discarded = self.postWaitBytes;
+    for (RTCVPProbe *probe in self.probeWait) {
+        discarded += probe.byteCount;
+    }
+    self.postWaitBytes = 0;
+    [self.postWait removeAllObjects];
+    [self.probeWait removeAllObjects];
+    
+    [self releaseOutboundBytes:discarded];
+}
+
 #pragma mark - 发送消息
 
 - (void)send:(NSString *)msg withData:(NSArray<NSData *> *)data {
-    [self log:[NSString stringWithFormat:@"发送消息: %@ (原始Socket.IO包)", msg] level:RTCLogLevelDebug];
+    RTCVPEngineLogDebug(@"发送消息: %@ (原始Socket.IO包)", msg);
     [self write:msg withType:RTCVPSocketEnginePacketTypeMessage withData:data];
 }
 
+- (void)sendEncodedMessage:(NSData *)message withData:(NSArray<NSData *> *)data {
+    [self writeEncoded:message withData:data];
+}
+
+- (void)sendBinaryMessage:(NSData *)message {
+    [self writeBinaryMessage:message];
+}
+
+- (void)sendEncodedMessages:(NSArray<NSData *> *)messages binary:(BOOL)binary withData:(NSArray<NSArray<NSData *> *> *)data {
+    [self writeMessages:messages binary:binary withData:data];
+}
+
 - (void)sendRawData:(NSData *)data {
     dispatch_async(self.engineQueue, ^{
         if (self.websocket && self.ws) {
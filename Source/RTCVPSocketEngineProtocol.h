@@ -10,6 +10,7 @@
 #define RTCVPSocketEngineProtocol_H
 
 #import <Foundation/Foundation.h>
+#import "RTCVPConnectionTimeline.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -37,6 +38,8 @@ typedef void (^RTCVPSocketAckCallback)(NSArray * _Nullable response);
 @property (nonatomic, readonly) BOOL closed;
 @property (nonatomic, readonly) BOOL connected;
 @property (nonatomic, readonly) NSString *sid;
+/// 已交给引擎但尚未写出的字节数（含 WebSocket 写队列和未完成的 POST）
+@property (nonatomic, readonly) NSUInteger bufferedAmount;
 
 /// 连接状态回调
 @property (nonatomic, copy, nullable) void (^onConnect)(void);
@@ -59,6 +62,13 @@ typedef void (^RTCVPSocketAckCallback)(NSArray * _Nullable response);
 
 ///// 发送消息和数据
 - (void)send:(NSString*)msg withData:(NSArray<NSData*>*) data;
+/// 发送已编码的 Engine.IO 文本帧（含类型前缀的 UTF-8 字节）和二进制附件
+- (void)sendEncodedMessage:(NSData *)message withData:(NSArray<NSData*>*)data;
+/// 发送一个完整的二进制 Engine.IO message（二进制编码格式的 Socket.IO 包）
+- (void)sendBinaryMessage:(NSData *)message;
+/// 一次发送多条 Engine.IO message：WebSocket 下所有帧（含附件）拼成一次写入，轮询下立即合并成一个 POST
+/// binary 为 NO 时 messages 是含类型前缀的文本帧，data[i] 为第 i 条的附件；为 YES 时每条是一个二进制 message
+- (void)sendEncodedMessages:(NSArray<NSData *> *)messages binary:(BOOL)binary withData:(nullable NSArray<NSArray<NSData *> *> *)data;
 ///// 发送消息（可选ACK）
 //- (void)send:(NSString *)msg ack:(RTCVPSocketAckCallback)ack;
 ///// 发送消息和数据（可选ACK）
@@ -97,6 +107,22 @@ typedef void (^RTCVPSocketAckCallback)(NSArray * _Nullable response);
 /// 心跳超时
 - (void)enginePingTimeout;
 
+/// 发送缓冲超过高水位后回落到低水位以下，可在任意线程回调
+- (void)engineDidDrain;
+
+/// 命名空间 CONNECT 包携带的负载（如连接状态恢复的 pid/offset），在 engineQueue 上回调
+- (nullable NSDictionary *)engineConnectPayloadForNamespace:(NSString *)nsp;
+
+/// 引擎打开后要加入的命名空间（多命名空间共用一个引擎时实现），在 engineQueue 上回调；
+/// 未实现时只加入 config.namespace
+- (NSArray<NSString *> *)engineNamespacesToConnect;
+
+/// 连接阶段时间点（单调时钟纳秒），在 engineQueue 上回调
+- (void)engineDidReachConnectionPhase:(RTCVPConnectionPhase)phase atTime:(uint64_t)timestamp;
+
+/// 测得一次传输层往返时延（秒，WebSocket ping/pong），在 engineQueue 上回调
+- (void)engineDidMeasureRoundTrip:(NSTimeInterval)rtt;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -20,3 +20,4 @@ FOUNDATION_EXPORT const unsigned char RTCVPSocketIOVersionString[];
 #import "RTCVPSocketIOClientProtocol.h"
 #import "RTCVPSocketLogger.h"
 
+#import "RTCVPSocketManager.h"
@@ -0,0 +1,58 @@
+//
+//  RTCVPSocketIOClient+Private.h
+//  RTCVPSocketIO
+//
+//  供 RTCVPSocketManager 使用的客户端内部接口
+//
+
+#import "RTCVPSocketIOClient.h"
+#import "RTCVPSocketEngineProtocol.h"
+#import "RTCVPSocketPacket.h"
+#import "RTCVPSocketManager.h"
+#import "RTCVPSocketMetrics.h"
+
+@class RTCVPSocketEngine;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface RTCVPSocketIOClient () <RTCVPSocketEngineClient>
+
+@property (nonatomic, strong, nullable) RTCVPSocketEngine *engine;
+/// 所属的 manager；不为 nil 时引擎、连接和重连都由 manager 负责
+@property (nonatomic, weak, nullable) RTCVPSocketManager *manager;
+/// 本命名空间的事件/重连计数和 ACK 延迟
+@property (nonatomic, strong, readonly) RTCVPSocketMetrics *metrics;
+
+/// manager 创建的命名空间 socket，共享 manager 的引擎、处理队列和重连
+- (instancetype)initWithManager:(RTCVPSocketManager *)manager namespace:(NSString *)nsp;
+
+/// 只设置配置、ACK 管理和处理队列：不创建重连调度、不启动网络监控、不改全局日志设置，
+/// 其他初始化方法都经过它
+- (instancetype)initWithSocketURL:(NSURL *)socketURL
+                           config:(RTCVPSocketIOConfig *)config
+                      handleQueue:(dispatch_queue_t)handleQueue;
+
+// 以下方法只在 handleQueue 上调用
+- (void)handlePacket:(RTCVPSocketPacket *)packet;
+- (void)parseBinaryData:(NSData *)data;
+- (void)handleClientEvent:(NSString *)event withData:(NSArray *)data;
+- (void)sendNamespacePacket:(RTCVPPacketType)type;
+- (void)didDisconnect:(NSString *)reason;
+
+/// 开始新一次连接的时间线（manager 重连时调用）
+- (void)startConnectionTimeline;
+
+/// 共享引擎关闭：状态回到未连接，等待 manager 重连
+- (void)managerDidClose:(NSString *)reason;
+
+@end
+
+@interface RTCVPSocketManager ()
+
+/// socket 调用 connect/断开时通知 manager
+- (void)openSocket:(RTCVPSocketIOClient *)socket;
+- (void)closeSocket:(RTCVPSocketIOClient *)socket;
+
+@end
+
+NS_ASSUME_NONNULL_END
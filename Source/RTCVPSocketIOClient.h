@@ -2,6 +2,9 @@
 #import <Foundation/Foundation.h>
 #import "RTCVPSocketIOClientProtocol.h"
 #import "RTCVPSocketIOConfig.h"
+#import "RTCVPConnectionTimeline.h"
+#import "RTCVPSocketMetrics.h"
+#import "RTCVPRTTEstimator.h"
 
 // 事件类型
 typedef NS_ENUM(NSUInteger, RTCVPSocketClientEvent) {
@@ -11,6 +14,7 @@ typedef NS_ENUM(NSUInteger, RTCVPSocketClientEvent) {
     RTCVPSocketClientEventReconnect,
     RTCVPSocketClientEventReconnectAttempt,
     RTCVPSocketClientEventStatusChange,
+    RTCVPSocketClientEventDrain,
 };
 
 // 客户端状态
@@ -29,6 +33,7 @@ extern NSString * _Nullable const RTCVPSocketEventError;
 extern NSString * _Nullable const RTCVPSocketEventReconnect;
 extern NSString * _Nullable const RTCVPSocketEventReconnectAttempt;
 extern NSString * _Nullable const RTCVPSocketEventStatusChange;
+extern NSString * _Nullable const RTCVPSocketEventDrain;
 
 // 状态字符串常量
 extern NSString * _Nullable const RTCVPSocketStatusNotConnected;
@@ -72,6 +77,36 @@ typedef void (^RTCVPSocketAnyEventHandler)(RTCVPSocketAnyEvent* _Nonnull event);
 typedef void (^RTCVPSocketAckHandler)(id _Nullable data, NSError * _Nullable error);
 typedef void (^RTCVPSocketConnectHandler)(BOOL connected, NSError * _Nullable error);
 
+@class RTCVPSocketIOClient;
+
+/// emitBatch: 中的一个事件
+@interface RTCVPSocketBatchEvent : NSObject
+
+@property (nonatomic, copy, readonly) NSString *_Nonnull event;
+@property (nonatomic, copy, readonly) NSArray *_Nullable items;
+/// 不为 nil 时事件带 ACK，回调在 handleQueue 上
+@property (nonatomic, copy, readonly) void(^_Nullable ackBlock)(NSArray * _Nullable data, NSError * _Nullable error);
+/// ACK 超时，<= 0 时与 emitWithAck 相同按配置计算
+@property (nonatomic, assign) NSTimeInterval timeout;
+
++ (instancetype _Nonnull)eventWithName:(NSString *_Nonnull)event items:(NSArray *_Nullable)items;
++ (instancetype _Nonnull)eventWithName:(NSString *_Nonnull)event
+                                 items:(NSArray *_Nullable)items
+                              ackBlock:(void(^_Nullable)(NSArray * _Nullable data, NSError * _Nullable error))ackBlock;
+
+@end
+
+/// 客户端代理，回调都在 handleQueue 上
+@protocol RTCVPSocketIOClientDelegate <NSObject>
+
+@optional
+/// 本次连接到达新阶段，timeline 为当时的快照，可用 dictionaryRepresentation 上报
+- (void)socketClient:(RTCVPSocketIOClient *_Nonnull)client
+didReachConnectionPhase:(RTCVPConnectionPhase)phase
+            timeline:(RTCVPConnectionTimeline *_Nonnull)timeline;
+
+@end
+
 @interface RTCVPSocketIOClient : NSObject<RTCVPSocketIOClientProtocol>
 
 /// 客户端状态
@@ -94,6 +129,21 @@ typedef void (^RTCVPSocketConnectHandler)(BOOL connected, NSError * _Nullable er
 @property (nonatomic, strong, readonly) dispatch_queue_t _Nonnull handleQueue;
 /// 命名空间
 @property (nonatomic, strong, readonly) NSString* _Nullable nsp;
+/// 已发出但尚未写到网络的字节数，超过 config.highWaterMark 后等待 drain 事件再继续发送
+@property (nonatomic, readonly) NSUInteger bufferedAmount;
+/// 最近一次连接是否恢复了之前的会话（Socket.IO 4.6+ 连接状态恢复，服务端开启 connectionStateRecovery）
+/// 为 YES 时断线期间错过的事件会由服务端补发，无需重新同步
+@property (nonatomic, readonly) BOOL recovered;
+/// 代理
+@property (nonatomic, weak) id<RTCVPSocketIOClientDelegate> _Nullable delegate;
+/// 最近一次连接（含重连）的阶段时间线快照，还没连接过时为 nil
+@property (nonatomic, readonly) RTCVPConnectionTimeline * _Nullable connectionTimeline;
+/// 往返时延估算，由 ACK 往返、Engine.IO v3 心跳和 WebSocket ping/pong 采样；config.adaptiveAckTimeout 开启时据此计算 ACK 超时
+@property (nonatomic, strong, readonly) RTCVPRTTEstimator * _Nonnull rttEstimator;
+
+/// 运行时指标快照：各传输收发字节/包数、事件速率、队列深度、重连次数和 ACK 延迟分布
+/// 计数器无锁更新，可在任意线程定期调用；速率按距上一次调用的时间计算
+- (RTCVPSocketMetricsSnapshot *_Nonnull)metricsSnapshot;
 
 #pragma mark - 初始化方法
 
@@ -129,20 +179,32 @@ typedef void (^RTCVPSocketConnectHandler)(BOOL connected, NSError * _Nullable er
 /// 发送事件（可变参数版本）
 - (void)emit:(NSString *_Nonnull)event withArgs:(id _Nullable)arg1, ... NS_REQUIRES_NIL_TERMINATION;
 
-/// 发送事件
+/// 发送事件，发送缓冲超过 config.maxBufferedAmount 时丢弃
 - (void)emit:(NSString *_Nonnull)event items:(NSArray *_Nullable)items;
 
+/// 发送可丢弃的事件：未连接或发送缓冲超过高水位时直接丢弃，不缓存
+/// @return 是否已交给引擎发送
+- (BOOL)emitVolatile:(NSString *_Nonnull)event items:(NSArray *_Nullable)items;
+
 /// 增强的emitWithAck方法，直接传递回调block
+/// 发送缓冲超过 config.maxBufferedAmount 时不发送，以 RTCVPSocketIOErrorCodeBufferFull（-4）回调
 - (void)emitWithAck:(NSString *_Nonnull)event
               items:(NSArray *_Nullable)items
 ackBlock:(void(^_Nonnull)(NSArray * _Nullable data, NSError * _Nullable error))ackBlock;
 
 /// 增强的emitWithAck方法，直接传递回调block，带超时时间
+/// timeout <= 0 时使用 config.ackTimeout，开启 config.adaptiveAckTimeout 后按往返时延计算
 - (void)emitWithAck:(NSString *_Nonnull)event
               items:(NSArray *_Nullable)items
            ackBlock:(void(^_Nonnull)(NSArray * _Nullable data, NSError * _Nullable error))ackBlock
             timeout:(NSTimeInterval)timeout;
 
+/// 批量发送：所有事件（含附件）编码后一次交给引擎，WebSocket 下一次写入，轮询下合并成一个 POST
+/// 带 ackBlock 的事件与 emitWithAck 一样分配 ACK ID；ACK 等待数已满时按 config.ackOverflowPolicy 处理，
+/// 排队的事件有位置后单独发送。与 emit 一样在 Connected 或 Opened 状态下发送，其他状态逐个按 emit / emitWithAck 的规则缓存或回调错误
+/// 发送缓冲超过 config.maxBufferedAmount 时整批拒绝，带 ackBlock 的事件以 RTCVPSocketIOErrorCodeBufferFull（-4）回调
+- (void)emitBatch:(NSArray<RTCVPSocketBatchEvent *> *_Nonnull)events;
+
 #pragma mark - 事件监听
 
 /// 注册事件监听器
@@ -7,15 +7,18 @@
 //
 
 #import "RTCVPSocketIOClient.h"
+#import "RTCVPSocketIOClient+Private.h"
+#import "RTCVPSocketManager.h"
 #import "RTCVPSocketEngine.h"
 #import "RTCVPSocketPacket.h"
 #import "RTCVPACKManager.h"
 #import "RTCDefaultSocketLogger.h"
-#import "RTCVPStringReader.h"
 #import "NSString+RTCVPSocketIO.h"
-#import "RTCVPAFNetworkReachabilityManager.h"
 #import "RTCVPTimer.h"
 #import "RTCVPSocketIOConfig.h"
+#import "RTCVPSocketJSONParser.h"
+#import "RTCVPReconnectDriver.h"
+#import <stdatomic.h>
 
 #pragma mark - 常量定义
 
@@ -25,6 +28,7 @@ NSString *const RTCVPSocketEventError = @"error";
 NSString *const RTCVPSocketEventReconnect = @"reconnect";
 NSString *const RTCVPSocketEventReconnectAttempt = @"reconnectAttempt";
 NSString *const RTCVPSocketEventStatusChange = @"statusChange";
+NSString *const RTCVPSocketEventDrain = @"drain";
 
 // ACK发射器常量定义
 NSString *const kRTCVPSocketAckEmitterErrorDomain = @"RTCVPSocketAckEmitterErrorDomain";
@@ -91,6 +95,26 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 
 @end
 
+#pragma mark - 批量事件类
+
+@implementation RTCVPSocketBatchEvent
+
++ (instancetype)eventWithName:(NSString *)event items:(NSArray *)items {
+    return [self eventWithName:event items:items ackBlock:nil];
+}
+
++ (instancetype)eventWithName:(NSString *)event
+                        items:(NSArray *)items
+                     ackBlock:(void(^)(NSArray * _Nullable data, NSError * _Nullable error))ackBlock {
+    RTCVPSocketBatchEvent *batchEvent = [[self alloc] init];
+    batchEvent->_event = [event copy];
+    batchEvent->_items = [items copy];
+    batchEvent->_ackBlock = [ackBlock copy];
+    return batchEvent;
+}
+
+@end
+
 #pragma mark - 全局事件类
 
 @interface RTCVPSocketAnyEvent : NSObject
@@ -126,21 +150,26 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 
 #pragma mark - 客户端私有接口
 
-@interface RTCVPSocketIOClient() <RTCVPSocketEngineClient> {
-    BOOL _reconnecting;
-    NSInteger _currentAck;
+@interface RTCVPSocketIOClient() <RTCVPSocketEngineClient, RTCVPReconnectDriverDelegate> {
+    atomic_uint _nextAckId;     // 下一个 ACK ID，32 位单调递增
     RTCVPSocketAnyEventHandler _anyHandler;
 }
 
 @property (nonatomic, strong) NSString *logType;
-@property (nonatomic, strong) RTCVPSocketEngine *engine;
 @property (nonatomic, strong) NSMutableArray<RTCVPSocketEventHandler *> *handlers;
 @property (nonatomic, strong) NSMutableArray<RTCVPSocketPacket *> *waitingPackets;
-@property (nonatomic, strong) RTCVPAFNetworkReachabilityManager *networkManager;
-@property (nonatomic, assign) RTCVPAFNetworkReachabilityStatus currentNetworkStatus;
 @property (nonatomic, strong) NSMutableArray<RTCVPSocketIOClientCacheData *> *dataCache;
-@property (nonatomic, assign) NSInteger currentReconnectAttempt;
 @property (nonatomic, strong) RTCVPACKManager *ackHandlers;
+// 重连和网络监控；manager 创建的 socket 没有，由 manager 负责
+@property (nonatomic, strong, nullable) RTCVPReconnectDriver *reconnectDriver;
+// 当前连接的阶段时间线，引擎回调在 engineQueue，其余在 handleQueue
+@property (atomic, strong) RTCVPConnectionTimeline *timeline;
+// 上一次指标快照，用于计算速率，@synchronized(self) 保护
+@property (nonatomic, strong) RTCVPSocketMetricsSnapshot *lastMetricsSnapshot;
+
+// 连接状态恢复：服务端 CONNECT 响应里的 pid 和最后收到的广播偏移量，@synchronized(self) 保护
+@property (nonatomic, copy) NSString *sessionPid;
+@property (nonatomic, copy) NSString *lastOffset;
 
 // 事件映射字典
 @property (nonatomic, strong, readonly) NSDictionary *eventMap;
@@ -162,12 +191,9 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 }
 
 - (instancetype)initWithSocketURL:(NSURL *)socketURL config:(RTCVPSocketIOConfig *)config {
-    self = [super init];
+    config = config ?: [RTCVPSocketIOConfig defaultConfig];
+    self = [self initWithSocketURL:socketURL config:config handleQueue:config.handleQueue ?: dispatch_get_main_queue()];
     if (self) {
-        [self setDefaultValues];
-        _socketURL = socketURL;
-        _config = config ?: [RTCVPSocketIOConfig defaultConfig];
-        
         // 设置日志
         if (self.config.logger) {
             [RTCDefaultSocketLogger setCoustomLogger:self.config.logger];
@@ -175,23 +201,16 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
         [RTCDefaultSocketLogger setEnabled:self.config.loggingEnabled];
         [RTCDefaultSocketLogger setLogLevel:self.config.logLevel];
         
-        // 配置重连参数
-        _reconnects = self.config.reconnectionEnabled;
-        _reconnectAttempts = self.config.reconnectionAttempts;
-        _reconnectWait = self.config.reconnectionDelay;
-        _nsp = self.config.namespace ?: @"/";
-        
-        // 设置处理队列
-        _handleQueue = dispatch_get_main_queue();
-        if (self.config.handleQueue) {
-            _handleQueue = self.config.handleQueue;
-        }
-        
         // 设置命名空间
         if (self.config.namespace) {
             _nsp = self.config.namespace;
         }
         
+        // 重连调度（退避参数取自配置）
+        _reconnectDriver = [RTCVPReconnectDriver driverWithConfig:self.config queue:_handleQueue];
+        _reconnectDriver.delegate = self;
+        _reconnectDriver.logType = self.logType;
+        
         // 启动网络监控
         if (self.config.enableNetworkMonitoring) {
             [self startNetworkMonitoring];
@@ -203,6 +222,34 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     return self;
 }
 
+- (instancetype)initWithManager:(RTCVPSocketManager *)manager namespace:(NSString *)nsp {
+    self = [self initWithSocketURL:manager.socketURL config:manager.config handleQueue:manager.handleQueue];
+    if (self) {
+        _manager = manager;
+        _nsp = nsp;
+    }
+    return self;
+}
+
+- (instancetype)initWithSocketURL:(NSURL *)socketURL config:(RTCVPSocketIOConfig *)config handleQueue:(dispatch_queue_t)handleQueue {
+    self = [super init];
+    if (self) {
+        [self setDefaultValues];
+        _socketURL = socketURL;
+        _config = config;
+        _handleQueue = handleQueue;
+        
+        // 配置重连参数
+        _reconnects = self.config.reconnectionEnabled;
+        _reconnectAttempts = self.config.reconnectionAttempts;
+        _reconnectWait = self.config.reconnectionDelay;
+        _ackHandlers.defaultTimeout = self.config.ackTimeout;
+        _ackHandlers.maxPendingPackets = self.config.maxPendingAcks;
+        _ackHandlers.overflowPolicy = self.config.ackOverflowPolicy;
+    }
+    return self;
+}
+
 - (instancetype)initWithSocketURL:(NSURL *)socketURL configDictionary:(NSDictionary *)configDictionary {
     RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:configDictionary];
     return [self initWithSocketURL:socketURL config:config];
@@ -210,7 +257,9 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 
 - (void)dealloc {
     [RTCDefaultSocketLogger.logger log:@"Client is being released" type:self.logType];
-    [self.engine disconnect:@"Client Deinit"];
+    if (!_manager) {
+        [self.engine disconnect:@"Client Deinit"];
+    }
     [self stopNetworkMonitoring];
     [self.ackHandlers removeAllPackets];
 }
@@ -225,18 +274,17 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     _reconnects = YES;
     _reconnectWait = 10;
     _reconnectAttempts = -1;
-    _currentReconnectAttempt = 0;
-    _reconnecting = NO;
-    _currentAck = -1;
+    atomic_init(&_nextAckId, 0);
     
     // 使用新的ACK管理器
     _ackHandlers = [[RTCVPACKManager alloc] initWithDefaultTimeout:10.0];
     _handlers = [[NSMutableArray alloc] init];
     _waitingPackets = [[NSMutableArray alloc] init];
     _dataCache = [[NSMutableArray alloc] init];
-    
-    // 启动定期超时检查
-    [_ackHandlers startPeriodicTimeoutCheckWithInterval:1.0];
+    _metrics = [[RTCVPSocketMetrics alloc] init];
+    _rttEstimator = [[RTCVPRTTEstimator alloc] init];
+    _ackHandlers.latencyHistogram = _metrics.ackLatency;
+    _ackHandlers.rttEstimator = _rttEstimator;
 }
 
 #pragma mark - 映射字典懒加载
@@ -251,7 +299,8 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
             @(RTCVPSocketClientEventError): RTCVPSocketEventError,
             @(RTCVPSocketClientEventReconnect): RTCVPSocketEventReconnect,
             @(RTCVPSocketClientEventReconnectAttempt): RTCVPSocketEventReconnectAttempt,
-            @(RTCVPSocketClientEventStatusChange): RTCVPSocketEventStatusChange
+            @(RTCVPSocketClientEventStatusChange): RTCVPSocketEventStatusChange,
+            @(RTCVPSocketClientEventDrain): RTCVPSocketEventDrain
         };
     });
     return _eventMap;
@@ -280,8 +329,7 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
         
         switch (status) {
             case RTCVPSocketIOClientStatusConnected:
-                _reconnecting = NO;
-                _currentReconnectAttempt = 0;
+                [_reconnectDriver stop];
                 break;
             default:
                 break;
@@ -294,10 +342,51 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     }
 }
 
+- (void)setReconnectWait:(NSTimeInterval)reconnectWait {
+    _reconnectWait = reconnectWait;
+    self.reconnectDriver.baseDelay = reconnectWait;
+}
+
+- (void)setReconnectAttempts:(NSInteger)reconnectAttempts {
+    _reconnectAttempts = reconnectAttempts;
+    self.reconnectDriver.maxAttempts = reconnectAttempts;
+}
+
+- (NSInteger)currentReconnectAttempt {
+    return self.reconnectDriver.currentAttempt;
+}
+
+- (NSUInteger)bufferedAmount {
+    return self.engine.bufferedAmount;
+}
+
 - (NSString *)logType {
     return @"RTCVPSocketIOClient";
 }
 
+- (RTCVPConnectionTimeline *)connectionTimeline {
+    return [self.timeline copy];
+}
+
+- (RTCVPSocketMetricsSnapshot *)metricsSnapshot {
+    NSUInteger gauges[RTCVPMetricGaugeCount] = {0};
+    RTCVPSocketEngine *engine = self.engine;
+    [engine getPostWaitDepth:&gauges[RTCVPMetricPostWaitDepth] probeWaitDepth:&gauges[RTCVPMetricProbeWaitDepth]];
+    // 数组只在 handleQueue 上修改，这里只读 count，采样值允许略有滞后
+    gauges[RTCVPMetricWaitingPacketsDepth] = self.waitingPackets.count;
+    gauges[RTCVPMetricDataCacheDepth] = self.dataCache.count;
+    gauges[RTCVPMetricPendingAckDepth] = (NSUInteger)[self.ackHandlers activePacketCount];
+    
+    NSArray<RTCVPSocketMetrics *> *metrics = engine ? @[self.metrics, engine.metrics] : @[self.metrics];
+    @synchronized (self) {
+        RTCVPSocketMetricsSnapshot *snapshot = [[RTCVPSocketMetricsSnapshot alloc] initWithMetrics:metrics
+                                                                                             gauges:gauges
+                                                                                           previous:self.lastMetricsSnapshot];
+        self.lastMetricsSnapshot = snapshot;
+        return snapshot;
+    }
+}
+
 #pragma mark - 工具方法
 
 - (NSString *)eventStringForEvent:(RTCVPSocketClientEvent)event {
@@ -319,13 +408,20 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 - (void)connectWithTimeoutAfter:(NSTimeInterval)timeout withHandler:(RTCVPSocketIOVoidHandler)handler {
     if (_status != RTCVPSocketIOClientStatusConnected) {
         self.status = RTCVPSocketIOClientStatusConnecting;
+        [self startConnectionTimeline];
         
-        if (self.engine == nil || self.forceNew) {
-            [self addEngine];
+        RTCVPSocketManager *manager = self.manager;
+        if (manager) {
+            // 共用 manager 的引擎
+            [manager openSocket:self];
+        } else {
+            if (self.engine == nil || self.forceNew) {
+                [self addEngine];
+            }
+            
+            [self.engine connect];
         }
         
-        [self.engine connect];
-        
         if (timeout > 0) {
             __weak typeof(self) weakSelf = self;
             dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeout * NSEC_PER_SEC)),
@@ -350,6 +446,11 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 - (void)disconnect {
     [RTCDefaultSocketLogger.logger log:@"Closing socket" type:self.logType];
     _reconnects = NO;
+    // 主动断开不再恢复旧会话
+    @synchronized (self) {
+        self.sessionPid = nil;
+        self.lastOffset = nil;
+    }
     [self didDisconnect:@"Disconnect"];
 }
 
@@ -361,9 +462,12 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 }
 
 - (void)reconnect {
-    if (!_reconnecting) {
-        [self tryReconnect:@"manual reconnect"];
+    if (self.manager) {
+        // 重连由 manager 统一调度，这里只重新加入
+        [self connect];
+        return;
     }
+    [self.reconnectDriver startWithReason:@"manual reconnect" immediately:YES];
 }
 
 #pragma mark - 私有方法
@@ -402,14 +506,20 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     if (_status != RTCVPSocketIOClientStatusDisconnected) {
         [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"断开连接: %@", reason] type:self.logType];
         
-        _reconnecting = NO;
+        // 取消等待中的重连
+        [self.reconnectDriver stop];
         self.status = RTCVPSocketIOClientStatusDisconnected;
         
         // 清理所有ACK包
         [self.ackHandlers removeAllPackets];
         
-        // 确保引擎关闭
-        [self.engine disconnect:reason];
+        // 确保引擎关闭；共用引擎时只离开自己的命名空间
+        RTCVPSocketManager *manager = self.manager;
+        if (manager) {
+            [manager closeSocket:self];
+        } else {
+            [self.engine disconnect:reason];
+        }
         [self handleClientEvent:RTCVPSocketEventDisconnect withData:@[reason]];
     }
 }
@@ -429,12 +539,42 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 
 #pragma mark - ACK管理
 
+/// 32 位无符号递增，约 43 亿次后才回绕；回绕后与仍在等待的 ID 冲突时由 ACK 管理器拒绝
 - (NSInteger)generateNextAck {
-    _currentAck += 1;
-    if (_currentAck >= 1000) { // 循环使用，避免溢出
-        _currentAck = 0;
+    return (NSInteger)atomic_fetch_add_explicit(&_nextAckId, 1, memory_order_relaxed);
+}
+
+/// 登记等待 ACK 的包，不发送：返回 Accepted 时由调用方发送；
+/// 排队的包在 ACK 管理器腾出位置后于 handleQueue 上单独发送，被拒绝的包已回调错误
+- (RTCVPACKRegistration)registerPacketAwaitingAck:(RTCVPSocketPacket *)packet {
+    __weak typeof(self) weakSelf = self;
+    return [self.ackHandlers registerPacket:packet send:^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf) {
+            dispatch_async(strongSelf.handleQueue, ^{
+                [strongSelf sendPacket:packet];
+            });
+        }
+    }];
+}
+
+/// 登记等待 ACK 的包：登记成功立即发送，排队时等 ACK 管理器腾出位置再发送，被拒绝时不发送
+- (void)sendPacketAwaitingAck:(RTCVPSocketPacket *)packet {
+    if ([self registerPacketAwaitingAck:packet] == RTCVPACKRegistrationAccepted) {
+        [self sendPacket:packet];
     }
-    return _currentAck;
+}
+
+/// 发送缓冲是否超过硬上限；超过时普通事件也不再交给引擎，避免内存无限增长
+- (BOOL)outboundBufferFull {
+    NSUInteger maxBufferedAmount = self.config.maxBufferedAmount;
+    return maxBufferedAmount > 0 && self.bufferedAmount >= maxBufferedAmount;
+}
+
+- (NSError *)outboundBufferFullError {
+    return [NSError errorWithDomain:RTCVPSocketIOErrorDomain
+                               code:RTCVPSocketIOErrorCodeBufferFull
+                           userInfo:@{NSLocalizedDescriptionKey: @"发送缓冲已满"}];
 }
 
 #pragma mark - 事件发射
@@ -467,6 +607,22 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     [self emit:event items:items ack:-1];
 }
 
+- (BOOL)emitVolatile:(NSString *)event items:(NSArray *)items {
+    if (_status != RTCVPSocketIOClientStatusConnected) {
+        RTCVPLogDebug(self.logType, @"Socket未连接，丢弃volatile事件: %@", event);
+        return NO;
+    }
+    
+    NSUInteger bufferedAmount = self.bufferedAmount;
+    if (bufferedAmount > self.config.highWaterMark) {
+        RTCVPLogDebug(self.logType, @"发送缓冲 %lu 字节超过高水位，丢弃volatile事件: %@", (unsigned long)bufferedAmount, event);
+        return NO;
+    }
+    
+    [self emit:event items:items ack:-1];
+    return YES;
+}
+
 - (void)emit:(NSString *)event items:(NSArray *)items ack:(int)ack {
     // 构建事件数据数组
     NSMutableArray *dataArray = [NSMutableArray array];
@@ -489,6 +645,11 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
         return;
     }
     
+    if ([self outboundBufferFull]) {
+        RTCVPLog(RTCLogLevelWarning, self.logType, @"发送缓冲 %lu 字节超过上限，丢弃事件: %@", (unsigned long)self.bufferedAmount, event);
+        return;
+    }
+    
     // 创建包
     RTCVPSocketPacket *packet = [RTCVPSocketPacket eventPacketWithEvent:event
                                                                   items:items
@@ -501,32 +662,30 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
         __weak typeof(self) weakSelf = self;
         [packet setupAckCallbacksWithSuccess:^(NSArray * _Nullable response) {
             __strong typeof(weakSelf) strongSelf = weakSelf;
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"ACK回调执行: %@, 响应: %@", @(ack), response]
-                                          type:strongSelf.logType];
+            RTCVPLogDebug(strongSelf.logType, @"ACK回调执行: %@, 响应: %@", @(ack), response);
         } error:^(NSError * _Nullable error) {
             __strong typeof(weakSelf) strongSelf = weakSelf;
             if (error) {
                 [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"ACK错误: %@, 错误: %@", @(ack), error.localizedDescription]
                                               type:strongSelf.logType];
             }
-        } timeout:10.0];
+        } timeout:[self ackTimeoutForRequestedTimeout:0]];
+        
+        RTCVPLogDebug(self.logType, @"发送事件: %@", event);
         
-        // 注册到ACK管理器
-        [self.ackHandlers registerPacket:packet];
+        [self sendPacketAwaitingAck:packet];
+        return;
     }
     
-    NSString *str = packet.packetString;
-    
-    [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"发送事件: %@", str] type:self.logType];
+    RTCVPLogDebug(self.logType, @"发送事件: %@", event);
     
-    // 发送消息
-    [self.engine send:str withData:packet.binary];
+    [self sendPacket:packet];
 }
 
 - (void)emitWithAck:(NSString *)event
               items:(NSArray *)items
            ackBlock:(void(^)(NSArray * _Nullable data, NSError * _Nullable error))ackBlock {
-    [self emitWithAck:event items:items ackBlock:ackBlock timeout:10.0];
+    [self emitWithAck:event items:items ackBlock:ackBlock timeout:0];
 }
 
 - (void)emitWithAck:(NSString *)event
@@ -536,7 +695,7 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     
     if (!event) {
         if (ackBlock) {
-            NSError *error = [NSError errorWithDomain:@"RTCVPSocketIOErrorDomain"
+            NSError *error = [NSError errorWithDomain:RTCVPSocketIOErrorDomain
                                                  code:-1
                                              userInfo:@{NSLocalizedDescriptionKey: @"事件名不能为空"}];
             dispatch_async(self.handleQueue, ^{
@@ -548,7 +707,7 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     
     if (_status != RTCVPSocketIOClientStatusConnected) {
         if (ackBlock) {
-            NSError *error = [NSError errorWithDomain:@"RTCVPSocketIOErrorDomain"
+            NSError *error = [NSError errorWithDomain:RTCVPSocketIOErrorDomain
                                                  code:-2
                                              userInfo:@{NSLocalizedDescriptionKey: @"Socket未连接"}];
             dispatch_async(self.handleQueue, ^{
@@ -558,6 +717,29 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
         return;
     }
     
+    if ([self outboundBufferFull]) {
+        RTCVPLog(RTCLogLevelWarning, self.logType, @"发送缓冲 %lu 字节超过上限，拒绝事件: %@", (unsigned long)self.bufferedAmount, event);
+        if (ackBlock) {
+            NSError *error = [self outboundBufferFullError];
+            dispatch_async(self.handleQueue, ^{
+                ackBlock(nil, error);
+            });
+        }
+        return;
+    }
+    
+    RTCVPSocketPacket *packet = [self ackPacketWithEvent:event items:items ackBlock:ackBlock timeout:timeout];
+    
+    RTCVPLogDebug(self.logType, @"发送带ACK的事件: %@ (ackId: %@)", event, @(packet.packetId));
+    
+    [self sendPacketAwaitingAck:packet];
+}
+
+/// 分配 ACK ID 并创建带回调的事件包，回调转到 handleQueue
+- (RTCVPSocketPacket *)ackPacketWithEvent:(NSString *)event
+                                    items:(NSArray *)items
+                                 ackBlock:(void(^)(NSArray * _Nullable data, NSError * _Nullable error))ackBlock
+                                  timeout:(NSTimeInterval)timeout {
     // 生成ACK ID
     NSInteger ackId = [self generateNextAck];
     
@@ -584,33 +766,105 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
                 ackBlock(nil, error);
             });
         }
-    } timeout:timeout];
+    } timeout:[self ackTimeoutForRequestedTimeout:timeout]];
     
-    // 注册到ACK管理器
-    [self.ackHandlers registerPacket:packet];
+    return packet;
+}
+
+- (void)emitBatch:(NSArray<RTCVPSocketBatchEvent *> *)events {
+    if (events.count == 0) {
+        return;
+    }
     
-    NSString *str = packet.packetString;
+    // 与 emit 相同的状态判断：未连接时逐个处理，普通事件缓存，带 ACK 的事件回调错误
+    if (_status != RTCVPSocketIOClientStatusConnected && _status != RTCVPSocketIOClientStatusOpened) {
+        for (RTCVPSocketBatchEvent *batchEvent in events) {
+            if (batchEvent.ackBlock) {
+                [self emitWithAck:batchEvent.event items:batchEvent.items ackBlock:batchEvent.ackBlock timeout:batchEvent.timeout];
+            } else {
+                [self emit:batchEvent.event items:batchEvent.items];
+            }
+        }
+        return;
+    }
     
-    [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"发送带ACK的事件: %@ (ackId: %@)", str, @(ackId)]
-                                  type:self.logType];
+    // 超过硬上限时整批拒绝：普通事件丢弃，带 ACK 的事件回调错误
+    if ([self outboundBufferFull]) {
+        RTCVPLog(RTCLogLevelWarning, self.logType, @"发送缓冲 %lu 字节超过上限，拒绝批量事件: %lu 个", (unsigned long)self.bufferedAmount, (unsigned long)events.count);
+        NSError *error = [self outboundBufferFullError];
+        for (RTCVPSocketBatchEvent *batchEvent in events) {
+            void (^ackBlock)(NSArray *, NSError *) = batchEvent.ackBlock;
+            if (ackBlock) {
+                dispatch_async(self.handleQueue, ^{
+                    ackBlock(nil, error);
+                });
+            }
+        }
+        return;
+    }
     
-    // 发送消息
-    [self.engine send:str withData:packet.binary];
+    NSMutableArray<RTCVPSocketPacket *> *packets = [NSMutableArray arrayWithCapacity:events.count];
+    for (RTCVPSocketBatchEvent *batchEvent in events) {
+        if (!batchEvent.ackBlock) {
+            [packets addObject:[RTCVPSocketPacket eventPacketWithEvent:batchEvent.event
+                                                                 items:batchEvent.items
+                                                              packetId:-1
+                                                                   nsp:self.nsp
+                                                           requiresAck:NO]];
+            continue;
+        }
+        
+        RTCVPSocketPacket *packet = [self ackPacketWithEvent:batchEvent.event
+                                                       items:batchEvent.items
+                                                    ackBlock:batchEvent.ackBlock
+                                                     timeout:batchEvent.timeout];
+        // 排队的包由 ACK 管理器腾出位置后单独发送，被拒绝的包已回调错误
+        if ([self registerPacketAwaitingAck:packet] == RTCVPACKRegistrationAccepted) {
+            [packets addObject:packet];
+        }
+    }
+    if (packets.count == 0) {
+        return;
+    }
+    
+    id<RTCVPSocketParser> parser = self.config.parser ?: [RTCVPSocketJSONParser parser];
+    NSMutableArray<NSData *> *messages = [NSMutableArray arrayWithCapacity:packets.count];
+    NSMutableArray<NSArray<NSData *> *> *attachments = [NSMutableArray arrayWithCapacity:packets.count];
+    for (RTCVPSocketPacket *packet in packets) {
+        [messages addObject:[self encodedMessageForPacket:packet parser:parser]];
+        [attachments addObject:parser.encodesToBinary ? @[] : (packet.binary ?: @[])];
+    }
+    [self.metrics addValue:packets.count toCounter:RTCVPMetricEmits];
+    
+    RTCVPLogDebug(self.logType, @"批量发送事件: %lu 个", (unsigned long)packets.count);
+    
+    [self.engine sendEncodedMessages:messages binary:parser.encodesToBinary withData:attachments];
+}
+
+/// 调用方没有指定超时（<= 0）时：自适应模式按往返时延估算，否则用配置的固定值
+- (NSTimeInterval)ackTimeoutForRequestedTimeout:(NSTimeInterval)timeout {
+    if (timeout > 0) {
+        return timeout;
+    }
+    if (!self.config.adaptiveAckTimeout) {
+        return self.config.ackTimeout;
+    }
+    return [self.rttEstimator timeoutWithFallback:self.config.ackTimeout
+                                          minimum:self.config.minAckTimeout
+                                          maximum:self.config.maxAckTimeout];
 }
 
 #pragma mark - 处理ACK响应
 
 - (void)handleAck:(NSInteger)ack withData:(NSArray *)data {
     if (_status == RTCVPSocketIOClientStatusConnected) {
-        [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"处理ACK响应: %@, 数据: %@", @(ack), data]
-                                      type:self.logType];
+        RTCVPLogDebug(self.logType, @"处理ACK响应: %@, 数据: %@", @(ack), data);
         
         // 使用ACK管理器处理ACK响应
         BOOL handled = [self.ackHandlers acknowledgePacketWithId:ack data:data];
         
         if (!handled) {
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"未找到对应的ACK包: %@", @(ack)]
-                                          type:self.logType];
+            RTCVPLogDebug(self.logType, @"未找到对应的ACK包: %@", @(ack));
         }
     }
 }
@@ -626,13 +880,143 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     // 创建ACK响应包
     RTCVPSocketPacket *packet = [RTCVPSocketPacket ackPacketWithId:ackId items:data nsp:self.nsp];
     
-    NSString *str = packet.packetString;
-    
-    [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"发送ACK响应: %@ (ackId: %@)", str, @(ackId)]
-                                  type:self.logType];
+    RTCVPLogDebug(self.logType, @"发送ACK响应 (ackId: %@)", @(ackId));
     
     // 发送ACK响应
-    [self.engine send:str withData:packet.binary];
+    [self sendPacket:packet];
+}
+
+#pragma mark - 包发送
+
+/// 按配置的解析器编码：文本格式发送 '4' + 包 + 附件帧，二进制格式整包一个二进制帧
+- (void)sendPacket:(RTCVPSocketPacket *)packet {
+    if (packet.type == RTCVPPacketTypeEvent || packet.type == RTCVPPacketTypeBinaryEvent) {
+        [self.metrics addValue:1 toCounter:RTCVPMetricEmits];
+    }
+    id<RTCVPSocketParser> parser = self.config.parser ?: [RTCVPSocketJSONParser parser];
+    NSData *message = [self encodedMessageForPacket:packet parser:parser];
+    
+    if (parser.encodesToBinary) {
+        [self.engine sendBinaryMessage:message];
+        return;
+    }
+    [self.engine sendEncodedMessage:message withData:packet.binary];
+}
+
+/// 二进制格式为整包的二进制 message；文本格式为 '4' + 包，附件另外发送
+- (NSData *)encodedMessageForPacket:(RTCVPSocketPacket *)packet parser:(id<RTCVPSocketParser>)parser {
+    NSMutableData *message = [NSMutableData dataWithCapacity:64];
+    if (!parser.encodesToBinary) {
+        // Engine.IO message 类型前缀 '4'
+        const uint8_t enginePrefix = '4';
+        [message appendBytes:&enginePrefix length:1];
+    }
+    [parser encodePacket:packet intoBuffer:message];
+    return message;
+}
+
+/// 命名空间的 connect/disconnect 包
+- (void)sendNamespacePacket:(RTCVPPacketType)type {
+    NSDictionary *payload = type == RTCVPPacketTypeConnect ? [self engineConnectPayloadForNamespace:self.nsp] : nil;
+    RTCVPSocketPacket *packet = [[RTCVPSocketPacket alloc] initWithType:type
+                                                                   data:payload ? @[payload] : @[]
+                                                               packetId:-1
+                                                                    nsp:self.nsp
+                                                           placeholders:0
+                                                                 binary:@[]];
+    if (self.config.parser.encodesToBinary) {
+        [self sendPacket:packet];
+    } else {
+        [self.engine send:packet.packetString withData:@[]];
+    }
+}
+
+#pragma mark - 连接状态恢复
+
+- (nullable NSDictionary *)engineConnectPayloadForNamespace:(NSString *)nsp {
+    @synchronized (self) {
+        if (self.sessionPid.length == 0) {
+            return nil;
+        }
+        // 与 socket.io-client 一致：{pid, offset}，还没收到过广播时不带 offset
+        NSMutableDictionary *payload = [NSMutableDictionary dictionaryWithObject:self.sessionPid forKey:@"pid"];
+        if (self.lastOffset) {
+            payload[@"offset"] = self.lastOffset;
+        }
+        return payload;
+    }
+}
+
+/// 服务端 CONNECT 响应：{"sid":..,"pid":..}，pid 与上次相同说明会话已恢复
+- (void)updateRecoveryWithConnectPayload:(id)payload {
+    NSString *pid = [payload isKindOfClass:[NSDictionary class]] ? payload[@"pid"] : nil;
+    if (![pid isKindOfClass:[NSString class]]) {
+        pid = nil;
+    }
+    @synchronized (self) {
+        _recovered = pid != nil && [pid isEqualToString:self.sessionPid];
+        if (![pid isEqualToString:self.sessionPid]) {
+            // 新会话（或服务端未开启恢复），旧偏移量作废
+            self.lastOffset = nil;
+        }
+        self.sessionPid = pid;
+    }
+    if (_recovered) {
+        [RTCDefaultSocketLogger.logger log:@"会话已恢复，服务端将补发断线期间的事件" type:self.logType];
+    }
+}
+
+/// 开启恢复时服务端广播的事件最后一个参数是偏移量；没有监听者的事件参数未解析，从原始负载末尾读取
+- (void)recordOffsetOfPacket:(RTCVPSocketPacket *)packet {
+    @synchronized (self) {
+        if (!self.sessionPid) {
+            return;
+        }
+        NSString *offset = packet.trailingStringArgument;
+        if (offset) {
+            self.lastOffset = offset;
+        }
+    }
+}
+
+#pragma mark - 连接时间线
+
+/// 每次连接（含重连）一条新的时间线
+- (void)startConnectionTimeline {
+    self.timeline = [[RTCVPConnectionTimeline alloc] init];
+    [self recordConnectionPhase:RTCVPConnectionPhaseStart atTime:RTCVPMonotonicNanoseconds()];
+}
+
+- (void)recordConnectionPhase:(RTCVPConnectionPhase)phase atTime:(uint64_t)timestamp {
+    RTCVPConnectionTimeline *timeline = self.timeline;
+    if (![timeline markPhase:phase atTime:timestamp]) {
+        return;
+    }
+    
+    if (phase == RTCVPConnectionPhaseNamespaceConnected) {
+        RTCVPLogDebug(self.logType, @"连接时间线: %@", [timeline dictionaryRepresentation]);
+    }
+    
+    id<RTCVPSocketIOClientDelegate> delegate = self.delegate;
+    if (![delegate respondsToSelector:@selector(socketClient:didReachConnectionPhase:timeline:)]) {
+        return;
+    }
+    RTCVPConnectionTimeline *snapshot = [timeline copy];
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.handleQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf) {
+            [strongSelf.delegate socketClient:strongSelf didReachConnectionPhase:phase timeline:snapshot];
+        }
+    });
+}
+
+- (void)engineDidReachConnectionPhase:(RTCVPConnectionPhase)phase atTime:(uint64_t)timestamp {
+    [self recordConnectionPhase:phase atTime:timestamp];
+}
+
+- (void)engineDidMeasureRoundTrip:(NSTimeInterval)rtt {
+    [self.rttEstimator addSample:rtt];
 }
 
 #pragma mark - RTCVPSocketIOClientProtocol
@@ -657,9 +1041,7 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
             [RTCDefaultSocketLogger.logger error:[NSString stringWithFormat:@"Socket error: %@", data.firstObject]
                                             type:self.logType];
         } else {
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"处理事件: %@, 数据: %@, ack: %@",
-                                                event, data, @(ack)]
-                                          type:self.logType];
+            RTCVPLogDebug(self.logType, @"处理事件: %@, 数据: %@, ack: %@", event, data, @(ack));
         }
         
         // 调用全局事件处理器
@@ -696,10 +1078,14 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 #pragma mark - 命名空间管理
 
 - (void)leaveNamespace {
+    if (self.manager) {
+        [RTCDefaultSocketLogger.logger error:@"Socket from manager cannot leave namespace, use disconnect instead" type:self.logType];
+        return;
+    }
     if (![self.nsp isEqualToString:@"/"]) {
         // 使用新的引擎接口发送离开命名空间消息
         if (self.engine) {
-            [self.engine send:[NSString stringWithFormat:@"1%@", self.nsp] withData:@[]];
+            [self sendNamespacePacket:RTCVPPacketTypeDisconnect];
             _nsp = @"/";
             [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"Left namespace, now in: %@", self.nsp] type:self.logType];
         } else {
@@ -713,13 +1099,17 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
         [RTCDefaultSocketLogger.logger error:@"Namespace is empty or nil" type:self.logType];
         return;
     }
+    if (self.manager) {
+        [RTCDefaultSocketLogger.logger error:@"Socket from manager cannot join namespace, use socketForNamespace: instead" type:self.logType];
+        return;
+    }
     
     _nsp = namespace;
     if (![self.nsp isEqualToString:@"/"]) {
         [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"Joining namespace: %@", self.nsp] type:self.logType];
         // 使用新的引擎接口发送加入命名空间消息
         if (self.engine) {
-            [self.engine send:[NSString stringWithFormat:@"0%@", self.nsp] withData:@[]];
+            [self sendNamespacePacket:RTCVPPacketTypeConnect];
         } else {
             [RTCDefaultSocketLogger.logger error:@"Cannot join namespace, engine is nil" type:self.logType];
         }
@@ -807,117 +1197,42 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 
 #pragma mark - 重连管理
 
-- (void)tryReconnect:(NSString *)reason {
-    if (!_reconnecting) {
-        [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"Starting reconnect: %@", reason] type:self.logType];
-        [self handleClientEvent:RTCVPSocketEventReconnect withData:@[reason]];
-        _reconnecting = YES;
-        self.currentReconnectAttempt = 0;
-        [self _tryReconnect];
-    }
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver didStartWithReason:(NSString *)reason {
+    [self handleClientEvent:RTCVPSocketEventReconnect withData:@[reason]];
 }
 
-- (void)_tryReconnect {
-    if (self.reconnects && _reconnecting && _status != RTCVPSocketIOClientStatusDisconnected) {
-        if (self.reconnectAttempts != -1 && self.currentReconnectAttempt >= self.reconnectAttempts) {
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"Reconnect failed after %ld attempts", (long)self.currentReconnectAttempt] type:self.logType];
-            return [self didDisconnect:@"Reconnect Failed"];
-        } else {
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"Trying to reconnect (attempt %ld/%ld)",
-                                                (long)self.currentReconnectAttempt + 1,
-                                                self.reconnectAttempts == -1 ? LONG_MAX : (long)self.reconnectAttempts]
-                                      type:self.logType];
-            
-            [self handleClientEvent:RTCVPSocketEventReconnectAttempt
-                           withData:@[@(self.currentReconnectAttempt + 1)]];
-            
-            self.currentReconnectAttempt += 1;
-            [self connect];
-            
-            [self setReconnectTimer];
-        }
-    }
+- (BOOL)reconnectDriverShouldAttempt:(RTCVPReconnectDriver *)driver {
+    return self.reconnects &&
+           _status != RTCVPSocketIOClientStatusDisconnected &&
+           _status != RTCVPSocketIOClientStatusConnected;
 }
 
-- (void)setReconnectTimer {
-    __weak typeof(self) weakSelf = self;
-    
-    // 指数退避策略：baseDelay * (2 ^ (attempt - 1))，但不超过最大值60秒
-    NSTimeInterval delay = MIN(self.reconnectWait * pow(2, self.currentReconnectAttempt - 1), 60.0);
-    
-    [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"Setting reconnect timer for %.1f seconds", delay] type:self.logType];
-    
-    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)),
-                  self.handleQueue, ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (strongSelf) {
-            if (strongSelf.reconnects && strongSelf->_reconnecting) {
-                if (strongSelf.status != RTCVPSocketIOClientStatusConnected) {
-                    [strongSelf _tryReconnect];
-                } else {
-                    [RTCDefaultSocketLogger.logger log:@"Reconnect timer fired but already connected" type:self.logType];
-                    strongSelf->_reconnecting = NO;
-                }
-            } else {
-                [RTCDefaultSocketLogger.logger log:@"Reconnect timer fired but reconnect is disabled" type:self.logType];
-            }
-        }
-    });
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver attempt:(NSInteger)attempt {
+    [self handleClientEvent:RTCVPSocketEventReconnectAttempt withData:@[@(attempt)]];
+    [self.metrics addValue:1 toCounter:RTCVPMetricReconnects];
+    [self connect];
 }
 
-#pragma mark - 网络监控
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver didFailAfterAttempts:(NSInteger)attempts {
+    [self didDisconnect:@"Reconnect Failed"];
+}
 
-- (void)startNetworkMonitoring {
-    if (!self.networkManager) {
-        self.networkManager = [RTCVPAFNetworkReachabilityManager sharedManager];
-        [self.networkManager startMonitoring];
-        self.currentNetworkStatus = RTCVPAFNetworkReachabilityStatusUnknown;
-        
-        __weak typeof(self) weakSelf = self;
-        [self.networkManager setReachabilityStatusChangeBlock:^(RTCVPAFNetworkReachabilityStatus status) {
-            __strong typeof(weakSelf) strongSelf = weakSelf;
-            [strongSelf handleNetworkStatusChange:status];
-        }];
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver networkDidChange:(NSString *)reason linkChanged:(BOOL)linkChanged {
+    if (linkChanged) {
+        // 换了链路，旧的往返时延不再适用
+        [self.rttEstimator reset];
     }
+    [self.engine disconnect:reason];
 }
 
-- (void)stopNetworkMonitoring {
-    if (self.networkManager) {
-        [self.networkManager stopMonitoring];
-        self.networkManager = nil;
-    }
+#pragma mark - 网络监控
+
+- (void)startNetworkMonitoring {
+    [self.reconnectDriver startNetworkMonitoring];
 }
 
-- (void)handleNetworkStatusChange:(RTCVPAFNetworkReachabilityStatus)status {
-    if (self.currentNetworkStatus == RTCVPAFNetworkReachabilityStatusUnknown) {
-        self.currentNetworkStatus = status;
-        return;
-    }
-    
-    switch (status) {
-        case RTCVPAFNetworkReachabilityStatusUnknown:
-        case RTCVPAFNetworkReachabilityStatusNotReachable: {
-            [RTCDefaultSocketLogger.logger log:@"ERROR ==========No network===========" type:self.logType];
-            [self.engine disconnect:@"No network or not reachable"];
-            break;
-        }
-        case RTCVPAFNetworkReachabilityStatusReachableViaWWAN: {
-            if (self.currentNetworkStatus == RTCVPAFNetworkReachabilityStatusReachableViaWiFi) {
-                [RTCDefaultSocketLogger.logger log:@"ERROR ==========Network changed: WiFi to 4G===========" type:self.logType];
-                [self.engine disconnect:@"Network changed: WiFi to 4G"];
-            }
-            break;
-        }
-        case RTCVPAFNetworkReachabilityStatusReachableViaWiFi: {
-            if (self.currentNetworkStatus == RTCVPAFNetworkReachabilityStatusReachableViaWWAN) {
-                [RTCDefaultSocketLogger.logger log:@"ERROR ==========Network changed: 4G to WiFi===========" type:self.logType];
-                [self.engine disconnect:@"Network changed: 4G to WiFi"];
-            }
-            break;
-        }
-    }
-    
-    self.currentNetworkStatus = status;
+- (void)stopNetworkMonitoring {
+    [self.reconnectDriver stopNetworkMonitoring];
 }
 
 - (void)emitAck:(int)ack withItems:(NSArray *)items isEvent:(BOOL)isEvent {
@@ -931,6 +1246,7 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 
 - (void)didConnect:(NSString *)namespace {
     [RTCDefaultSocketLogger.logger log:@"Socket已连接" type:self.logType];
+    [self recordConnectionPhase:RTCVPConnectionPhaseNamespaceConnected atTime:RTCVPMonotonicNanoseconds()];
     self.status = RTCVPSocketIOClientStatusConnected;
     
     // 发送缓存的数据
@@ -988,19 +1304,33 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 - (void)_engineDidClose:(NSString *)reason {
     [self.waitingPackets removeAllObjects];
     if (_status == RTCVPSocketIOClientStatusDisconnected || !self.reconnects) {
+        [self.reconnectDriver stop];
         [self didDisconnect:reason];
     } else {
         self.status = RTCVPSocketIOClientStatusNotConnected;
-        if (!_reconnecting) {
-            _reconnecting = YES;
-            [self tryReconnect:reason];
-        }
+        [self.reconnectDriver connectionDidClose:reason];
     }
 }
 
+- (void)managerDidClose:(NSString *)reason {
+    [self.waitingPackets removeAllObjects];
+    if (_status != RTCVPSocketIOClientStatusDisconnected) {
+        self.status = RTCVPSocketIOClientStatusNotConnected;
+    }
+}
+
+- (void)engineDidDrain {
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.handleQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf) {
+            [strongSelf handleClientEvent:RTCVPSocketEventDrain withData:@[]];
+        }
+    });
+}
+
 - (void)parseEngineMessage:(NSString *)msg {
-    [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"Should parse message: %@", msg]
-                                  type:self.logType];
+    RTCVPLogDebug(self.logType, @"Should parse message: %@", msg);
     
     __weak typeof(self) weakSelf = self;
     dispatch_async(self.handleQueue, ^{
@@ -1023,29 +1353,45 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 
 - (void)handleEngineAck:(NSInteger)ackId withData:(nonnull NSArray *)data {
     // 处理引擎ACK
-    [self handleAck:(int)ackId withData:data];
+    [self handleAck:ackId withData:data];
 }
 
 #pragma mark - 消息解析
 
 - (void)parseSocketMessage:(NSString *)message {
     if (message.length > 0) {
-        [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"解析消息: %@", message]
-                                      type:@"SocketParser"];
+        RTCVPLogDebug(@"SocketParser", @"解析消息: %@", message);
         
-        // 使用新的包解析方法
-        RTCVPSocketPacket *packet = [RTCVPSocketPacket packetFromString:message];
+        // 使用新的包解析方法，按配置延迟解析事件参数
+        NSError *error = nil;
+        id<RTCVPSocketParser> parser = self.config.parser ?: [RTCVPSocketJSONParser parser];
+        RTCVPSocketPacket *packet = [parser decodeString:message
+                                          deferArguments:self.config.lazyEventDecoding
+                                                   error:&error];
         if (packet) {
-            [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"解析为包: %@", packet.description]
-                                          type:@"SocketParser"];
+            RTCVPLogDebug(@"SocketParser", @"解析为包: %@", packet.description);
             [self handlePacket:packet];
         } else {
-            [RTCDefaultSocketLogger.logger error:@"无效的消息格式" type:@"SocketParser"];
+            [RTCDefaultSocketLogger.logger error:[NSString stringWithFormat:@"无效的消息格式: %@", error.localizedDescription]
+                                            type:@"SocketParser"];
         }
     }
 }
 
 - (void)parseBinaryData:(NSData *)data {
+    // 二进制编码格式：每个二进制帧就是一个完整的包
+    if (self.config.parser.encodesToBinary) {
+        NSError *error = nil;
+        RTCVPSocketPacket *packet = [self.config.parser decodeData:data error:&error];
+        if (packet) {
+            [self handlePacket:packet];
+        } else {
+            [RTCDefaultSocketLogger.logger error:[NSString stringWithFormat:@"无效的二进制包: %@", error.localizedDescription]
+                                            type:@"SocketParser"];
+        }
+        return;
+    }
+    
     if (self.waitingPackets.count > 0) {
         RTCVPSocketPacket *lastPacket = self.waitingPackets.lastObject;
         BOOL success = [lastPacket addBinaryData:data];
@@ -1057,6 +1403,7 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
                          withData:lastPacket.args
                 isInternalMessage:NO
                           withAck:lastPacket.packetId];
+                [self recordOffsetOfPacket:lastPacket];
             } else if (lastPacket.type == RTCVPPacketTypeBinaryAck) {
                 [self handleAck:lastPacket.packetId withData:lastPacket.args];
             }
@@ -1070,17 +1417,41 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
     return [nsp isEqualToString:self.nsp];
 }
 
+/// 是否有处理器需要这个事件的参数（onAny 需要所有事件）
+- (BOOL)hasHandlerForEvent:(NSString *)event {
+    if (_anyHandler) {
+        return YES;
+    }
+    for (RTCVPSocketEventHandler *handler in self.handlers) {
+        if ([handler.event isEqualToString:event]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
 - (void)handlePacket:(RTCVPSocketPacket *)packet {
     switch (packet.type) {
         case RTCVPPacketTypeEvent: {
-            if ([self isCorrectNamespace:packet.nsp]) {
+            BOOL correctNamespace = [self isCorrectNamespace:packet.nsp];
+            if (correctNamespace) {
+                [self recordConnectionPhase:RTCVPConnectionPhaseFirstEvent atTime:RTCVPMonotonicNanoseconds()];
+                [self.metrics addValue:1 toCounter:RTCVPMetricEvents];
+            }
+            if (![self hasHandlerForEvent:packet.event]) {
+                // 没有监听者，参数无需解析
+                RTCVPLogDebug(@"SocketParser", @"跳过无监听者的事件: %@", packet.event);
+            } else if (correctNamespace) {
                 [self handleEvent:packet.event
                          withData:packet.args
                 isInternalMessage:NO
                           withAck:packet.packetId];
             } else {
-                [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"命名空间不匹配的包: %@", packet.description]
-                                              type:@"SocketParser"];
+                RTCVPLogDebug(@"SocketParser", @"命名空间不匹配的包: %@", packet.description);
+            }
+            if (correctNamespace) {
+                // 分发后参数已解析；没有监听者时只读负载末尾，不解析参数
+                [self recordOffsetOfPacket:packet];
             }
             break;
         }
@@ -1089,8 +1460,7 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
             if ([self isCorrectNamespace:packet.nsp]) {
                 [self handleAck:packet.packetId withData:packet.args];
             } else {
-                [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"命名空间不匹配的ACK包: %@", packet.description]
-                                              type:@"SocketParser"];
+                RTCVPLogDebug(@"SocketParser", @"命名空间不匹配的ACK包: %@", packet.description);
             }
             break;
         }
@@ -1098,16 +1468,19 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
         case RTCVPPacketTypeBinaryEvent:
         case RTCVPPacketTypeBinaryAck: {
             if ([self isCorrectNamespace:packet.nsp]) {
+                if (packet.type == RTCVPPacketTypeBinaryEvent) {
+                    [self recordConnectionPhase:RTCVPConnectionPhaseFirstEvent atTime:RTCVPMonotonicNanoseconds()];
+                    [self.metrics addValue:1 toCounter:RTCVPMetricEvents];
+                }
                 [self.waitingPackets addObject:packet];
             } else {
-                [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"命名空间不匹配的二进制包: %@", packet.description]
-                                              type:@"SocketParser"];
+                RTCVPLogDebug(@"SocketParser", @"命名空间不匹配的二进制包: %@", packet.description);
             }
             break;
         }
             
         case RTCVPPacketTypeConnect: {
-            [self handleConnect:packet.nsp];
+            [self handleConnect:packet.nsp payload:packet.data.firstObject];
             break;
         }
             
@@ -1133,10 +1506,11 @@ NSString *const RTCVPSocketStatusConnected = @"connected";
 }
 
 
-- (void)handleConnect:(NSString *)packetNamespace {
+- (void)handleConnect:(NSString *)packetNamespace payload:(id)payload {
     if ([packetNamespace isEqualToString:@"/"] && ![self.nsp isEqualToString:@"/"]) {
         [self joinNamespace:self.nsp];
     } else {
+        [self updateRecoveryWithConnectPayload:payload];
         [self didConnect:packetNamespace];
     }
 }
@@ -9,6 +9,8 @@
 // RTCVPSocketIOConfig.h
 #import <Foundation/Foundation.h>
 #import "RTCVPSocketIOProtocolVersion.h"
+#import "RTCVPSocketParser.h"
+#import "RTCVPACKManager.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -37,8 +39,13 @@ typedef NS_ENUM(NSInteger, RTCVPSocketIOTransport) {
 @property (nonatomic, assign) NSTimeInterval connectTimeout;
 
 /// 传输方式（默认：自动选择）
+/// WebSocket 和自动模式都直接以 transport=websocket 握手，open 包取自第一帧
 @property (nonatomic, assign) RTCVPSocketIOTransport transport;
 
+/// 自动模式下 WebSocket 直连的领先时间（秒，默认：1）
+/// 超过该时间仍未收到 open 包就并行发起轮询握手，谁先完成用谁；WebSocket 失败时立即回退轮询
+@property (nonatomic, assign) NSTimeInterval websocketFallbackDelay;
+
 /// 协议版本（默认：RTCVPSocketIOProtocolVersion3）
 @property (nonatomic, assign) RTCVPSocketIOProtocolVersion protocolVersion;
 
@@ -51,6 +58,13 @@ typedef NS_ENUM(NSInteger, RTCVPSocketIOTransport) {
 /// 是否启用二进制传输
 @property (nonatomic, assign) BOOL enableBinary;
 
+/// 轮询模式下合并发送的等待窗口（秒，默认：0.005，0 表示有消息立即 POST）
+@property (nonatomic, assign) NSTimeInterval pollingCoalesceInterval;
+
+/// 单个轮询 POST 的最大负载（字节，默认：1000000，与服务端 maxHttpBufferSize 默认值一致）
+/// 超过时拆分到多个 POST 依次发送
+@property (nonatomic, assign) NSUInteger maxPollingPayloadSize;
+
 /// 是否启用重连
 @property (nonatomic, assign) BOOL reconnectionEnabled;
 
@@ -79,9 +93,70 @@ typedef NS_ENUM(NSInteger, RTCVPSocketIOTransport) {
 
 #pragma mark - 高级配置
 
-/// 是否启用压缩
+/// 是否启用压缩（默认：NO）
+/// 开启后 WebSocket 握手时协商 permessage-deflate，服务端接受才会压缩收发的消息；轮询传输不受影响
 @property (nonatomic, assign) BOOL compressionEnabled;
 
+/// 压缩的最小消息长度（字节，默认：1024）
+/// 更短的消息不压缩直接发送，压缩小消息省不了几个字节，反而多花 CPU
+@property (nonatomic, assign) NSUInteger compressionThreshold;
+
+/// 客户端压缩窗口（client_max_window_bits，9-15，默认：15）
+@property (nonatomic, assign) NSUInteger compressionClientMaxWindowBits;
+
+/// 请求服务端使用的压缩窗口（server_max_window_bits，8-15，默认：15）
+@property (nonatomic, assign) NSUInteger compressionServerMaxWindowBits;
+
+/// 客户端每条消息使用新的压缩上下文（client_no_context_takeover，默认：NO）
+/// 开启后每个连接少占一份压缩窗口内存，但相似的小消息压缩率明显下降
+@property (nonatomic, assign) BOOL compressionClientNoContextTakeover;
+
+/// 要求服务端每条消息使用新的压缩上下文（server_no_context_takeover，默认：NO）
+@property (nonatomic, assign) BOOL compressionServerNoContextTakeover;
+
+/// 是否延迟解析事件参数（默认：YES）
+/// 开启后收到文本事件时只先解析事件名，没有对应处理器（含 onAny）时不再解析参数 JSON
+@property (nonatomic, assign) BOOL lazyEventDecoding;
+
+/// 包编解码格式（默认：RTCVPSocketJSONParser）
+/// 服务端使用 socket.io-msgpack-parser 时设置为 [RTCVPSocketMsgPackParser parser]
+@property (nonatomic, strong) id<RTCVPSocketParser> parser;
+
+/// 发送缓冲高水位（字节，默认：1MB）
+/// 未发出的字节数超过该值后 volatile 事件直接丢弃
+@property (nonatomic, assign) NSUInteger highWaterMark;
+
+/// 发送缓冲低水位（字节，默认：256KB）
+/// 超过高水位后回落到该值以下时触发 drain 事件
+@property (nonatomic, assign) NSUInteger lowWaterMark;
+
+/// 发送缓冲硬上限（字节，默认：16MB，0 表示不限制）
+/// 超过后普通事件也不再交给引擎：emit 丢弃，emitWithAck / emitBatch 中带 ACK 的事件以发送缓冲已满错误回调
+@property (nonatomic, assign) NSUInteger maxBufferedAmount;
+
+/// 未指定超时的 ACK 等待时间（秒，默认：10）
+/// 开启自适应超时后只在还没有往返时延采样时使用
+@property (nonatomic, assign) NSTimeInterval ackTimeout;
+
+/// 是否按测得的往返时延计算 ACK 超时（默认：NO）
+/// 开启后未指定超时的 ACK 等待 SRTT + 4 × RTTVAR，限制在 [minAckTimeout, maxAckTimeout]
+/// 往返时延取自 ACK 往返、Engine.IO v3 的心跳 ping/pong，以及 Engine.IO v4 在 WebSocket 上随心跳回复发出的 ping 帧；
+/// Engine.IO v4 轮询连接只有 ACK 往返一个采样来源
+@property (nonatomic, assign) BOOL adaptiveAckTimeout;
+
+/// 自适应 ACK 超时下限（秒，默认：1）
+@property (nonatomic, assign) NSTimeInterval minAckTimeout;
+
+/// 自适应 ACK 超时上限（秒，默认：60）
+@property (nonatomic, assign) NSTimeInterval maxAckTimeout;
+
+/// 同时等待 ACK 的包上限（默认：1024）
+@property (nonatomic, assign) NSInteger maxPendingAcks;
+
+/// 等待 ACK 的包达到上限时的处理方式（默认：RTCVPACKOverflowPolicyReject）
+/// Reject 时新的 emitWithAck 立即以容量错误回调；Wait 时排队，有位置后再发送
+@property (nonatomic, assign) RTCVPACKOverflowPolicy ackOverflowPolicy;
+
 /// 是否强制创建新连接
 @property (nonatomic, assign) BOOL forceNewConnection;
 
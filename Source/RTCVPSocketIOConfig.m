@@ -9,6 +9,8 @@
 
 #import "RTCVPSocketIOConfig.h"
 #import "RTCDefaultSocketLogger.h"
+#import "RTCVPSocketJSONParser.h"
+#import "RTCVPSocketMsgPackParser.h"
 
 // 配置键常量
 NSString *const kRTCVPSocketIOConfigKeyForceNew = @"forceNew";
@@ -33,6 +35,25 @@ NSString *const kRTCVPSocketIOConfigKeySelfSigned = @"selfSigned";
 NSString *const kRTCVPSocketIOConfigKeySecurity = @"security";
 NSString *const kRTCVPSocketIOConfigKeyCompress = @"compress";
 NSString *const kRTCVPSocketIOConfigKeyNamespace = @"namespace";
+NSString *const kRTCVPSocketIOConfigKeyLazyEventDecoding = @"lazyEventDecoding";
+NSString *const kRTCVPSocketIOConfigKeyParser = @"parser";
+NSString *const kRTCVPSocketIOConfigKeyHighWaterMark = @"highWaterMark";
+NSString *const kRTCVPSocketIOConfigKeyLowWaterMark = @"lowWaterMark";
+NSString *const kRTCVPSocketIOConfigKeyMaxBufferedAmount = @"maxBufferedAmount";
+NSString *const kRTCVPSocketIOConfigKeyPollingCoalesceInterval = @"pollingCoalesceInterval";
+NSString *const kRTCVPSocketIOConfigKeyMaxPollingPayloadSize = @"maxPollingPayloadSize";
+NSString *const kRTCVPSocketIOConfigKeyWebSocketFallbackDelay = @"websocketFallbackDelay";
+NSString *const kRTCVPSocketIOConfigKeyAckTimeout = @"ackTimeout";
+NSString *const kRTCVPSocketIOConfigKeyAdaptiveAckTimeout = @"adaptiveAckTimeout";
+NSString *const kRTCVPSocketIOConfigKeyMinAckTimeout = @"minAckTimeout";
+NSString *const kRTCVPSocketIOConfigKeyMaxAckTimeout = @"maxAckTimeout";
+NSString *const kRTCVPSocketIOConfigKeyMaxPendingAcks = @"maxPendingAcks";
+NSString *const kRTCVPSocketIOConfigKeyAckOverflowPolicy = @"ackOverflowPolicy";
+NSString *const kRTCVPSocketIOConfigKeyCompressionThreshold = @"compressionThreshold";
+NSString *const kRTCVPSocketIOConfigKeyCompressionClientMaxWindowBits = @"compressionClientMaxWindowBits";
+NSString *const kRTCVPSocketIOConfigKeyCompressionServerMaxWindowBits = @"compressionServerMaxWindowBits";
+NSString *const kRTCVPSocketIOConfigKeyCompressionClientNoContextTakeover = @"compressionClientNoContextTakeover";
+NSString *const kRTCVPSocketIOConfigKeyCompressionServerNoContextTakeover = @"compressionServerNoContextTakeover";
 
 // Socket.IO 3.0协议支持常量
 const int kRTCVPSocketIOProtocolVersion2 = 2;
@@ -67,11 +88,14 @@ const int kRTCVPSocketIOProtocolVersion3 = 3;
         _secure = NO;
         _connectTimeout = 10;
         _transport = RTCVPSocketIOTransportAuto;
+        _websocketFallbackDelay = 1.0;
         _protocolVersion = kRTCVPSocketIOProtocolVersionDefault;
 
         _pingInterval = 25;
         _pingTimeout = 20;
         _enableBinary = YES;
+        _pollingCoalesceInterval = 0.005;
+        _maxPollingPayloadSize = 1000000;
         _reconnectionEnabled = YES;
         _reconnectionAttempts = -1; // 无限重连
         _reconnectionDelay = 1;
@@ -80,7 +104,23 @@ const int kRTCVPSocketIOProtocolVersion3 = 3;
         _allowSelfSignedCertificates = NO;
         _ignoreSSLErrors = NO;
         _compressionEnabled = NO;
+        _compressionThreshold = 1024;
+        _compressionClientMaxWindowBits = 15;
+        _compressionServerMaxWindowBits = 15;
+        _compressionClientNoContextTakeover = NO;
+        _compressionServerNoContextTakeover = NO;
         _forceNewConnection = NO;
+        _lazyEventDecoding = YES;
+        _parser = [RTCVPSocketJSONParser parser];
+        _highWaterMark = 1024 * 1024;
+        _lowWaterMark = 256 * 1024;
+        _maxBufferedAmount = 16 * 1024 * 1024;
+        _ackTimeout = 10;
+        _adaptiveAckTimeout = NO;
+        _minAckTimeout = 1;
+        _maxAckTimeout = 60;
+        _maxPendingAcks = 1024;
+        _ackOverflowPolicy = RTCVPACKOverflowPolicyReject;
         _loggingEnabled = NO;
         _logLevel = 2; // 信息级别
     }
@@ -133,8 +173,58 @@ const int kRTCVPSocketIOProtocolVersion3 = 3;
             self.security = value;
         } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyCompress]) {
             self.compressionEnabled = [value boolValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyCompressionThreshold]) {
+            self.compressionThreshold = [value unsignedIntegerValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyCompressionClientMaxWindowBits]) {
+            self.compressionClientMaxWindowBits = [value unsignedIntegerValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyCompressionServerMaxWindowBits]) {
+            self.compressionServerMaxWindowBits = [value unsignedIntegerValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyCompressionClientNoContextTakeover]) {
+            self.compressionClientNoContextTakeover = [value boolValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyCompressionServerNoContextTakeover]) {
+            self.compressionServerNoContextTakeover = [value boolValue];
         } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyNamespace]) {
             self.namespace = value;
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyLazyEventDecoding]) {
+            self.lazyEventDecoding = [value boolValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyParser]) {
+            // 支持直接传解析器对象，或 @"msgpack" / @"json"
+            if ([value conformsToProtocol:@protocol(RTCVPSocketParser)]) {
+                self.parser = value;
+            } else if ([value isKindOfClass:[NSString class]] && [value caseInsensitiveCompare:@"msgpack"] == NSOrderedSame) {
+                self.parser = [RTCVPSocketMsgPackParser parser];
+            } else {
+                self.parser = [RTCVPSocketJSONParser parser];
+            }
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyHighWaterMark]) {
+            self.highWaterMark = [value unsignedIntegerValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyLowWaterMark]) {
+            self.lowWaterMark = [value unsignedIntegerValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyMaxBufferedAmount]) {
+            self.maxBufferedAmount = [value unsignedIntegerValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyPollingCoalesceInterval]) {
+            self.pollingCoalesceInterval = [value doubleValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyMaxPollingPayloadSize]) {
+            self.maxPollingPayloadSize = [value unsignedIntegerValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyWebSocketFallbackDelay]) {
+            self.websocketFallbackDelay = [value doubleValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyAckTimeout]) {
+            self.ackTimeout = [value doubleValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyAdaptiveAckTimeout]) {
+            self.adaptiveAckTimeout = [value boolValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyMinAckTimeout]) {
+            self.minAckTimeout = [value doubleValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyMaxAckTimeout]) {
+            self.maxAckTimeout = [value doubleValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyMaxPendingAcks]) {
+            self.maxPendingAcks = [value integerValue];
+        } else if ([key isEqualToString:kRTCVPSocketIOConfigKeyAckOverflowPolicy]) {
+            // 支持枚举值，或 @"reject" / @"wait"
+            if ([value isKindOfClass:[NSString class]]) {
+                self.ackOverflowPolicy = [value caseInsensitiveCompare:@"wait"] == NSOrderedSame ? RTCVPACKOverflowPolicyWait : RTCVPACKOverflowPolicyReject;
+            } else {
+                self.ackOverflowPolicy = [value integerValue];
+            }
         }
     }
 }
@@ -23,6 +23,28 @@ typedef NS_ENUM(NSInteger, RTCLogLevel) {
 @property (nonatomic, assign) BOOL log;
 @property (nonatomic, assign) RTCLogLevel logLevel;
 
+#pragma mark - 异步输出
+
+/// 异步输出（默认：NO）
+/// 开启后日志先写入无锁环形缓冲区，由后台队列统一输出到 NSLog、文件和回调，
+/// 记录日志的线程（引擎队列、WebSocket 读线程）不再等待 stderr 或回调
+@property (nonatomic, assign) BOOL asynchronous;
+
+/// 环形缓冲区容量（向上取 2 的幂）
+@property (nonatomic, assign, readonly) NSUInteger bufferCapacity;
+
+/// 缓冲区满时丢弃的日志条数（丢弃而不阻塞，后台输出时会补一条汇总警告）
+@property (nonatomic, assign, readonly) uint64_t droppedCount;
+
+/// 日志文件路径，设置后日志追加写入该文件
+@property (nonatomic, copy, nullable) NSString *logFilePath;
+
+/// 指定环形缓冲区容量（默认 1024）
+- (instancetype)initWithBufferCapacity:(NSUInteger)capacity;
+
+/// 等待缓冲区中已记录的日志全部输出
+- (void)flush;
+
 /// 记录日志消息
 - (void)log:(NSString *)message type:(NSString *)type;
 /// 记录错误消息
@@ -33,6 +55,10 @@ typedef NS_ENUM(NSInteger, RTCLogLevel) {
 /// 简化的日志方法
 - (void)logMessage:(NSString *)message type:(NSString *)type level:(RTCLogLevel)level;
 
+/// 该级别的日志是否会被输出（打开了日志或设置了回调，且级别满足）
+/// 调用方应先判断再格式化消息，推荐直接使用 RTCDefaultSocketLogger.h 中的 RTCVPLog 系列宏
+- (BOOL)isEnabledForLevel:(RTCLogLevel)level;
+
 @end
 
 NS_ASSUME_NONNULL_END
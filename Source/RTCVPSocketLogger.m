@@ -7,28 +7,95 @@
 //
 
 #import "RTCVPSocketLogger.h"
+#import <stdatomic.h>
 
-@interface RTCVPSocketLogger()
+static const NSUInteger RTCVPLoggerDefaultCapacity = 1024;
+
+/// 环形缓冲区槽位（Vyukov 有界队列：sequence 标记槽位属于生产者还是消费者）
+typedef struct {
+    atomic_size_t sequence;
+    CFAbsoluteTime timestamp;
+    RTCLogLevel level;
+    void *label;    // CFBridgingRetain(NSString)
+    void *type;     // CFBridgingRetain(NSString)
+    void *message;  // CFBridgingRetain(NSString)
+} RTCVPLogSlot;
+
+@interface RTCVPSocketLogger() {
+    RTCVPLogSlot *_slots;
+    size_t _mask;
+    atomic_size_t _enqueuePos;
+    size_t _dequeuePos;          // 只在 _drainQueue 上访问
+    atomic_uint_fast64_t _dropped;
+    uint64_t _reportedDrops;     // 只在 _drainQueue 上访问
+    dispatch_queue_t _drainQueue;
+    dispatch_source_t _drainSource;
+    NSFileHandle *_fileHandle;   // @synchronized(self) 保护
+    NSDateFormatter *_fileDateFormatter;
+}
 @property (nonatomic, copy) void(^logCb)(NSString *message, NSString *type);
 @end
 
 @implementation RTCVPSocketLogger
 
 - (instancetype)init {
+    return [self initWithBufferCapacity:RTCVPLoggerDefaultCapacity];
+}
+
+- (instancetype)initWithBufferCapacity:(NSUInteger)capacity {
     self = [super init];
     if (self) {
         self.log = NO;
         self.logLevel = RTCLogLevelInfo;
+
+        // 容量取 2 的幂，下标用掩码计算
+        size_t size = 16;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _bufferCapacity = size;
+        _mask = size - 1;
+        _slots = calloc(size, sizeof(RTCVPLogSlot));
+        for (size_t i = 0; i < size; i++) {
+            atomic_init(&_slots[i].sequence, i);
+        }
+        atomic_init(&_enqueuePos, 0);
+        atomic_init(&_dropped, 0);
+
+        _drainQueue = dispatch_queue_create("com.vpsocketio.logger",
+                                            dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _drainSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_ADD, 0, 0, _drainQueue);
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(_drainSource, ^{
+            [weakSelf drainBuffer];
+        });
+        dispatch_resume(_drainSource);
     }
     return self;
 }
 
+- (void)dealloc {
+    dispatch_source_cancel(_drainSource);
+    for (size_t i = 0; i < _bufferCapacity; i++) {
+        RTCVPLogSlot *slot = &_slots[i];
+        if (slot->message) {
+            CFRelease(slot->label);
+            CFRelease(slot->type);
+            CFRelease(slot->message);
+        }
+    }
+    free(_slots);
+    [_fileHandle closeFile];
+}
+
+#pragma mark - 记录
+
 - (void)log:(NSString *)message type:(NSString *)type {
-    [self printLog:@"LOG" message:message type:type];
+    [self printLog:@"LOG" level:RTCLogLevelInfo message:message type:type];
 }
 
 - (void)error:(NSString *)message type:(NSString *)type {
-    [self printLog:@"ERROR" message:message type:type];
+    [self printLog:@"ERROR" level:RTCLogLevelError message:message type:type];
 }
 
 - (void)logMessage:(NSString *)message type:(NSString *)type level:(RTCLogLevel)level {
@@ -41,16 +108,146 @@
             case RTCLogLevelInfo: levelString = @"INFO"; break;
             case RTCLogLevelDebug: levelString = @"DEBUG"; break;
         }
-        [self printLog:levelString message:message type:type];
+        [self printLog:levelString level:level message:message type:type];
     }
 }
 
-- (void)printLog:(NSString *)logType message:(NSString *)message type:(NSString *)type {
+- (BOOL)isEnabledForLevel:(RTCLogLevel)level {
+    return (self.log || self.logCb != nil || self.logFilePath != nil) && level <= self.logLevel;
+}
+
+- (void)printLog:(NSString *)label level:(RTCLogLevel)level message:(NSString *)message type:(NSString *)type {
+    if (!self.log && !self.logCb && !self.logFilePath) {
+        return;
+    }
+
+    if (self.asynchronous) {
+        [self enqueueLabel:label level:level message:message type:type];
+    } else {
+        [self emitLabel:label timestamp:CFAbsoluteTimeGetCurrent() message:message type:type];
+    }
+}
+
+#pragma mark - 环形缓冲区
+
+/// 生产者：可在任意线程调用，不加锁；缓冲区满时丢弃并计数，不阻塞调用线程
+- (void)enqueueLabel:(NSString *)label level:(RTCLogLevel)level message:(NSString *)message type:(NSString *)type {
+    size_t pos = atomic_load_explicit(&_enqueuePos, memory_order_relaxed);
+    RTCVPLogSlot *slot;
+    for (;;) {
+        slot = &_slots[pos & _mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&_dropped, 1, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&_enqueuePos, memory_order_relaxed);
+        }
+    }
+
+    slot->timestamp = CFAbsoluteTimeGetCurrent();
+    slot->level = level;
+    slot->label = (void *)CFBridgingRetain(label ?: @"");
+    slot->type = (void *)CFBridgingRetain(type ?: @"");
+    slot->message = (void *)CFBridgingRetain(message ?: @"");
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+
+    dispatch_source_merge_data(_drainSource, 1);
+}
+
+/// 消费者：只在 _drainQueue 上运行
+- (void)drainBuffer {
+    for (;;) {
+        RTCVPLogSlot *slot = &_slots[_dequeuePos & _mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (sequence != _dequeuePos + 1) {
+            break;
+        }
+
+        CFAbsoluteTime timestamp = slot->timestamp;
+        NSString *label = CFBridgingRelease(slot->label);
+        NSString *type = CFBridgingRelease(slot->type);
+        NSString *message = CFBridgingRelease(slot->message);
+        slot->label = slot->type = slot->message = NULL;
+        atomic_store_explicit(&slot->sequence, _dequeuePos + _bufferCapacity, memory_order_release);
+        _dequeuePos++;
+
+        [self emitLabel:label timestamp:timestamp message:message type:type];
+    }
+
+    uint64_t dropped = atomic_load_explicit(&_dropped, memory_order_relaxed);
+    if (dropped > _reportedDrops) {
+        NSString *message = [NSString stringWithFormat:@"日志缓冲区已满，丢弃 %llu 条日志", (unsigned long long)(dropped - _reportedDrops)];
+        _reportedDrops = dropped;
+        [self emitLabel:@"WARN" timestamp:CFAbsoluteTimeGetCurrent() message:message type:@"SocketLogger"];
+    }
+}
+
+- (uint64_t)droppedCount {
+    return atomic_load_explicit(&_dropped, memory_order_relaxed);
+}
+
+- (void)flush {
+    dispatch_sync(_drainQueue, ^{
+        [self drainBuffer];
+        @synchronized (self) {
+            [self->_fileHandle synchronizeFile];
+        }
+    });
+}
+
+#pragma mark - 输出
+
+- (void)emitLabel:(NSString *)label timestamp:(CFAbsoluteTime)timestamp message:(NSString *)message type:(NSString *)type {
     if (self.log) {
-        NSLog(@"%@ %@: %@", logType, type, message);
+        NSLog(@"%@ %@: %@", label, type, message);
+    }
+    if (self.logFilePath) {
+        [self writeFileLabel:label timestamp:timestamp message:message type:type];
+    }
+    void (^callback)(NSString *, NSString *) = self.logCb;
+    if (callback) {
+        callback(message, type);
     }
-    if (self.logCb) {
-        self.logCb(message, type);
+}
+
+- (void)writeFileLabel:(NSString *)label timestamp:(CFAbsoluteTime)timestamp message:(NSString *)message type:(NSString *)type {
+    // 同步模式下可能在任意线程写文件，加锁保证行不交错
+    @synchronized (self) {
+        if (!_fileHandle) {
+            NSString *path = self.logFilePath;
+            if (![[NSFileManager defaultManager] fileExistsAtPath:path]) {
+                [[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil];
+            }
+            _fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+            [_fileHandle seekToEndOfFile];
+
+            _fileDateFormatter = [[NSDateFormatter alloc] init];
+            _fileDateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+            _fileDateFormatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
+        }
+        if (!_fileHandle) {
+            return;
+        }
+
+        NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:timestamp];
+        NSString *line = [NSString stringWithFormat:@"%@ %@ %@: %@\n",
+                          [_fileDateFormatter stringFromDate:date], label, type, message];
+        [_fileHandle writeData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+}
+
+- (void)setLogFilePath:(NSString *)logFilePath {
+    @synchronized (self) {
+        _logFilePath = [logFilePath copy];
+        [_fileHandle closeFile];
+        _fileHandle = nil;
     }
 }
 
@@ -0,0 +1,39 @@
+//
+//  RTCVPSocketManager.h
+//  RTCVPSocketIO
+//
+//  多个命名空间共用一条 Engine.IO 连接：manager 持有唯一的引擎，
+//  按命名空间分发入站包，引擎打开后各命名空间的 CONNECT 包在同一次发送中发出。
+//
+
+#import <Foundation/Foundation.h>
+#import "RTCVPSocketIOClient.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class RTCVPSocketIOConfig;
+
+@interface RTCVPSocketManager : NSObject
+
+/// 服务器URL
+@property (nonatomic, strong, readonly) NSURL *socketURL;
+/// 配置对象（config.namespace 不再使用，命名空间由 socketForNamespace: 指定）
+@property (nonatomic, strong, readonly) RTCVPSocketIOConfig *config;
+/// 处理队列，所有 socket 共用
+@property (nonatomic, strong, readonly) dispatch_queue_t handleQueue;
+/// 底层连接是否已打开
+@property (nonatomic, readonly, getter=isOpen) BOOL open;
+
++ (instancetype)managerWithSocketURL:(NSURL *)socketURL config:(RTCVPSocketIOConfig *)config;
+
+- (instancetype)initWithSocketURL:(NSURL *)socketURL config:(RTCVPSocketIOConfig *)config;
+
+/// 命名空间对应的 socket，同一命名空间总是返回同一个实例；调用其 connect 后才加入连接
+- (RTCVPSocketIOClient *)socketForNamespace:(NSString *)nsp;
+
+/// 断开所有 socket 并关闭底层连接
+- (void)disconnect;
+
+@end
+
+NS_ASSUME_NONNULL_END
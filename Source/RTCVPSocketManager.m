@@ -0,0 +1,420 @@
+//
+//  RTCVPSocketManager.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPSocketManager.h"
+#import "RTCVPSocketIOClient+Private.h"
+#import "RTCVPSocketEngine.h"
+#import "RTCVPSocketIOConfig.h"
+#import "RTCVPSocketPacket.h"
+#import "RTCVPSocketJSONParser.h"
+#import "RTCVPReconnectDriver.h"
+#import "RTCDefaultSocketLogger.h"
+
+#pragma mark - manager 私有接口
+
+@interface RTCVPSocketManager () <RTCVPSocketEngineClient, RTCVPReconnectDriverDelegate> {
+    BOOL _engineConnecting;
+}
+
+@property (nonatomic, strong) NSString *logType;
+@property (nonatomic, strong) RTCVPSocketEngine *engine;
+@property (nonatomic, strong) RTCVPReconnectDriver *reconnectDriver;
+
+// 以下集合由 @synchronized(self) 保护：socketForNamespace: 可在任意线程调用，
+// engineNamespacesToConnect 在 engineQueue 上回调
+@property (nonatomic, strong) NSMutableDictionary<NSString *, RTCVPSocketIOClient *> *sockets;
+@property (nonatomic, strong) NSMutableOrderedSet<NSString *> *activeNamespaces;
+@property (nonatomic, strong) NSMutableSet<NSString *> *connectSentNamespaces;
+
+// 文本格式的二进制事件/ACK：附件帧交给最近一个二进制包所在的 socket（只在 handleQueue 上访问）
+@property (nonatomic, weak) RTCVPSocketIOClient *binaryTarget;
+
+@end
+
+#pragma mark - manager 实现
+
+@implementation RTCVPSocketManager
+
+#pragma mark - 生命周期
+
++ (instancetype)managerWithSocketURL:(NSURL *)socketURL config:(RTCVPSocketIOConfig *)config {
+    return [[self alloc] initWithSocketURL:socketURL config:config];
+}
+
+- (instancetype)initWithSocketURL:(NSURL *)socketURL config:(RTCVPSocketIOConfig *)config {
+    self = [super init];
+    if (self) {
+        _socketURL = socketURL;
+        _config = config ?: [RTCVPSocketIOConfig defaultConfig];
+        _handleQueue = self.config.handleQueue ?: dispatch_get_main_queue();
+
+        // 日志是全局设置，由 manager 设置一次，命名空间 socket 不再各自设置
+        if (self.config.logger) {
+            [RTCDefaultSocketLogger setCoustomLogger:self.config.logger];
+        }
+        [RTCDefaultSocketLogger setEnabled:self.config.loggingEnabled];
+        [RTCDefaultSocketLogger setLogLevel:self.config.logLevel];
+
+        _sockets = [NSMutableDictionary dictionary];
+        _activeNamespaces = [NSMutableOrderedSet orderedSet];
+        _connectSentNamespaces = [NSMutableSet set];
+        _reconnectDriver = [RTCVPReconnectDriver driverWithConfig:self.config queue:_handleQueue];
+        _reconnectDriver.delegate = self;
+        _reconnectDriver.logType = self.logType;
+
+        _engine = [RTCVPSocketEngine engineWithClient:self url:socketURL config:self.config];
+
+        // 网络监控只在 manager 上做一次，命名空间 socket 不单独监控
+        if (self.config.enableNetworkMonitoring) {
+            [_reconnectDriver startNetworkMonitoring];
+        }
+
+        RTCVPLogInfo(self.logType, @"Manager initialized with URL: %@", socketURL.absoluteString);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_reconnectDriver stop];
+    [_reconnectDriver stopNetworkMonitoring];
+    [_engine disconnect:@"Manager Deinit"];
+}
+
+#pragma mark - 属性
+
+- (NSString *)logType {
+    return @"RTCVPSocketManager";
+}
+
+- (BOOL)isOpen {
+    return self.engine.connected;
+}
+
+#pragma mark - 命名空间 socket
+
+- (RTCVPSocketIOClient *)socketForNamespace:(NSString *)nsp {
+    NSString *key = nsp.length > 0 ? nsp : @"/";
+    if (![key hasPrefix:@"/"]) {
+        key = [@"/" stringByAppendingString:key];
+    }
+
+    @synchronized (self) {
+        RTCVPSocketIOClient *socket = self.sockets[key];
+        if (!socket) {
+            socket = [[RTCVPSocketIOClient alloc] initWithManager:self namespace:key];
+            self.sockets[key] = socket;
+        }
+        return socket;
+    }
+}
+
+- (NSArray<RTCVPSocketIOClient *> *)activeSockets {
+    @synchronized (self) {
+        NSMutableArray<RTCVPSocketIOClient *> *sockets = [NSMutableArray arrayWithCapacity:self.activeNamespaces.count];
+        for (NSString *nsp in self.activeNamespaces) {
+            RTCVPSocketIOClient *socket = self.sockets[nsp];
+            if (socket) {
+                [sockets addObject:socket];
+            }
+        }
+        return sockets;
+    }
+}
+
+- (nullable RTCVPSocketIOClient *)activeSocketForNamespace:(NSString *)nsp {
+    @synchronized (self) {
+        return [self.activeNamespaces containsObject:nsp] ? self.sockets[nsp] : nil;
+    }
+}
+
+#pragma mark - 连接管理
+
+/// socket 调用 connect：加入活跃集合，引擎已打开时单独补发这个命名空间的 connect 包
+- (void)openSocket:(RTCVPSocketIOClient *)socket {
+    socket.engine = self.engine;
+
+    BOOL sendNow = NO;
+    @synchronized (self) {
+        [self.activeNamespaces addObject:socket.nsp];
+        // 引擎打开时会一次性取走活跃命名空间；打开之后才加入的命名空间由这里发送
+        sendNow = self.engine.connected && ![self.connectSentNamespaces containsObject:socket.nsp];
+        if (sendNow) {
+            [self.connectSentNamespaces addObject:socket.nsp];
+        }
+    }
+
+    if (sendNow) {
+        [socket sendNamespacePacket:RTCVPPacketTypeConnect];
+    } else {
+        [self connectEngine];
+    }
+}
+
+/// socket 断开：最后一个 socket 断开时关闭引擎，否则只离开这个命名空间
+- (void)closeSocket:(RTCVPSocketIOClient *)socket {
+    BOOL wasSent = NO;
+    BOOL last = NO;
+    @synchronized (self) {
+        if (![self.activeNamespaces containsObject:socket.nsp]) {
+            return;
+        }
+        [self.activeNamespaces removeObject:socket.nsp];
+        wasSent = [self.connectSentNamespaces containsObject:socket.nsp];
+        [self.connectSentNamespaces removeObject:socket.nsp];
+        last = self.activeNamespaces.count == 0;
+    }
+
+    if (last) {
+        RTCVPLogInfo(self.logType, @"Last socket closed, closing engine");
+        [self.reconnectDriver stop];
+        [self.engine disconnect:@"Disconnect"];
+    } else if (wasSent && self.engine.connected) {
+        [socket sendNamespacePacket:RTCVPPacketTypeDisconnect];
+    }
+}
+
+- (void)connectEngine {
+    @synchronized (self) {
+        if (_engineConnecting || self.engine.connected) {
+            return;
+        }
+        _engineConnecting = YES;
+    }
+    [self.engine connect];
+}
+
+- (void)disconnect {
+    RTCVPLogInfo(self.logType, @"Closing manager");
+    // 最后一个 socket 断开时 closeSocket: 已关闭引擎，这里只处理没有活跃 socket 的情况
+    NSArray<RTCVPSocketIOClient *> *sockets = [self activeSockets];
+    for (RTCVPSocketIOClient *socket in sockets) {
+        [socket disconnect];
+    }
+    if (sockets.count == 0) {
+        [self.reconnectDriver stop];
+        [self.engine disconnect:@"Disconnect"];
+    }
+}
+
+#pragma mark - 重连管理
+
+// 重连由 manager 统一调度，所有命名空间跟随同一个引擎恢复
+
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver didStartWithReason:(NSString *)reason {
+    for (RTCVPSocketIOClient *socket in [self activeSockets]) {
+        [socket handleClientEvent:RTCVPSocketEventReconnect withData:@[reason]];
+    }
+}
+
+- (BOOL)reconnectDriverShouldAttempt:(RTCVPReconnectDriver *)driver {
+    return [self activeSockets].count > 0 && !self.engine.connected;
+}
+
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver attempt:(NSInteger)attempt {
+    for (RTCVPSocketIOClient *socket in [self activeSockets]) {
+        [socket startConnectionTimeline];
+        [socket.metrics addValue:1 toCounter:RTCVPMetricReconnects];
+        [socket handleClientEvent:RTCVPSocketEventReconnectAttempt withData:@[@(attempt)]];
+    }
+    [self connectEngine];
+}
+
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver didFailAfterAttempts:(NSInteger)attempts {
+    for (RTCVPSocketIOClient *socket in [self activeSockets]) {
+        [socket didDisconnect:@"Reconnect Failed"];
+    }
+}
+
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver networkDidChange:(NSString *)reason linkChanged:(BOOL)linkChanged {
+    if (linkChanged) {
+        // 换了链路，旧的往返时延不再适用
+        for (RTCVPSocketIOClient *socket in [self activeSockets]) {
+            [socket.rttEstimator reset];
+        }
+    }
+    [self.engine disconnect:reason];
+}
+
+#pragma mark - RTCVPSocketEngineClient
+
+- (NSArray<NSString *> *)engineNamespacesToConnect {
+    @synchronized (self) {
+        NSMutableArray<NSString *> *namespaces = [NSMutableArray arrayWithCapacity:self.activeNamespaces.count];
+        for (NSString *nsp in self.activeNamespaces) {
+            if (![self.connectSentNamespaces containsObject:nsp]) {
+                [namespaces addObject:nsp];
+                [self.connectSentNamespaces addObject:nsp];
+            }
+        }
+        return namespaces;
+    }
+}
+
+- (nullable NSDictionary *)engineConnectPayloadForNamespace:(NSString *)nsp {
+    RTCVPSocketIOClient *socket = [self activeSocketForNamespace:nsp];
+    return [socket engineConnectPayloadForNamespace:nsp];
+}
+
+- (void)engineDidReachConnectionPhase:(RTCVPConnectionPhase)phase atTime:(uint64_t)timestamp {
+    for (RTCVPSocketIOClient *socket in [self activeSockets]) {
+        [socket engineDidReachConnectionPhase:phase atTime:timestamp];
+    }
+}
+
+- (void)engineDidMeasureRoundTrip:(NSTimeInterval)rtt {
+    for (RTCVPSocketIOClient *socket in [self activeSockets]) {
+        [socket engineDidMeasureRoundTrip:rtt];
+    }
+}
+
+- (void)engineDidOpen:(NSString *)reason {
+    @synchronized (self) {
+        _engineConnecting = NO;
+    }
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.handleQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf) {
+            return;
+        }
+        [strongSelf.reconnectDriver stop];
+        for (RTCVPSocketIOClient *socket in [strongSelf activeSockets]) {
+            [socket engineDidOpen:reason];
+        }
+    });
+}
+
+- (void)engineDidClose:(NSString *)reason {
+    // 新连接的 open 之前清空，重连后所有活跃命名空间重新一起加入
+    @synchronized (self) {
+        _engineConnecting = NO;
+        [self.connectSentNamespaces removeAllObjects];
+    }
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.handleQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf) {
+            [strongSelf _engineDidClose:reason];
+        }
+    });
+}
+
+- (void)_engineDidClose:(NSString *)reason {
+    self.binaryTarget = nil;
+
+    NSArray<RTCVPSocketIOClient *> *sockets = [self activeSockets];
+    if (sockets.count == 0 || !self.config.reconnectionEnabled) {
+        [self.reconnectDriver stop];
+        for (RTCVPSocketIOClient *socket in sockets) {
+            [socket didDisconnect:reason];
+        }
+        return;
+    }
+
+    for (RTCVPSocketIOClient *socket in sockets) {
+        [socket managerDidClose:reason];
+    }
+    [self.reconnectDriver connectionDidClose:reason];
+}
+
+- (void)engineDidError:(NSString *)reason {
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.handleQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        for (RTCVPSocketIOClient *socket in [strongSelf activeSockets]) {
+            [socket handleClientEvent:RTCVPSocketEventError withData:@[reason]];
+        }
+    });
+}
+
+- (void)engineDidDrain {
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.handleQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        for (RTCVPSocketIOClient *socket in [strongSelf activeSockets]) {
+            [socket handleClientEvent:RTCVPSocketEventDrain withData:@[]];
+        }
+    });
+}
+
+- (void)parseEngineMessage:(NSString *)msg {
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.handleQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf) {
+            [strongSelf routeMessage:msg];
+        }
+    });
+}
+
+- (void)parseEngineBinaryData:(NSData *)data {
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.handleQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf) {
+            [strongSelf routeBinaryData:data];
+        }
+    });
+}
+
+- (void)handleEngineAck:(NSInteger)ackId withData:(NSArray *)data {
+    // ACK 包经 parseEngineMessage 按命名空间分发，这里没有命名空间信息
+}
+
+#pragma mark - 入站分发
+
+/// 每条消息只解码一次，再按包的命名空间交给对应 socket
+- (void)routeMessage:(NSString *)message {
+    if (message.length == 0) {
+        return;
+    }
+
+    NSError *error = nil;
+    id<RTCVPSocketParser> parser = self.config.parser ?: [RTCVPSocketJSONParser parser];
+    RTCVPSocketPacket *packet = [parser decodeString:message
+                                      deferArguments:self.config.lazyEventDecoding
+                                               error:&error];
+    if (packet) {
+        [self routePacket:packet];
+    } else {
+        RTCVPLogError(@"SocketParser", @"无效的消息格式: %@", error.localizedDescription);
+    }
+}
+
+- (void)routeBinaryData:(NSData *)data {
+    // 二进制编码格式：每个二进制帧就是一个完整的包，自带命名空间
+    if (self.config.parser.encodesToBinary) {
+        NSError *error = nil;
+        RTCVPSocketPacket *packet = [self.config.parser decodeData:data error:&error];
+        if (packet) {
+            [self routePacket:packet];
+        } else {
+            RTCVPLogError(@"SocketParser", @"无效的二进制包: %@", error.localizedDescription);
+        }
+        return;
+    }
+
+    RTCVPSocketIOClient *socket = self.binaryTarget;
+    if (socket) {
+        [socket parseBinaryData:data];
+    } else {
+        RTCVPLogError(@"SocketParser", @"收到二进制数据但没有等待中的包");
+    }
+}
+
+- (void)routePacket:(RTCVPSocketPacket *)packet {
+    RTCVPSocketIOClient *socket = [self activeSocketForNamespace:packet.nsp ?: @"/"];
+    if (!socket) {
+        RTCVPLogDebug(self.logType, @"没有加入的命名空间的包: %@", packet.description);
+        return;
+    }
+
+    if (packet.type == RTCVPPacketTypeBinaryEvent || packet.type == RTCVPPacketTypeBinaryAck) {
+        self.binaryTarget = socket;
+    }
+    [socket handlePacket:packet];
+}
+
+@end
@@ -45,15 +45,23 @@ typedef NS_ENUM(NSUInteger, RTCVPPacketState) {
 @property (nonatomic, strong, readonly) NSArray *data;
 @property (nonatomic, strong, readonly) NSMutableArray<NSData *> *binary;
 @property (nonatomic, copy, readonly) NSString *packetString;
+/// 事件最后一个参数为字符串时返回它（连接状态恢复的偏移量），否则为 nil；
+/// 参数还未解析时直接从原始负载末尾读取，不触发整个负载的解析
+@property (nonatomic, copy, readonly, nullable) NSString *trailingStringArgument;
 
 #pragma mark - ACK相关属性
+// 回调、超时等 ACK 簿记按需创建，入站包和不需要 ACK 的包不携带
 @property (nonatomic, assign, readonly) BOOL requiresAck;
 @property (nonatomic, assign, readonly) RTCVPPacketState state;
 @property (nonatomic, copy, nullable) RTCVPPacketSuccessCallback successCallback;
 @property (nonatomic, copy, nullable) RTCVPPacketErrorCallback errorCallback;
-@property (nonatomic, strong, nullable) NSTimer *timeoutTimer;
+/// ACK 超时（秒），由 RTCVPACKManager 的时间轮在注册后计时，包自身不再持有定时器
 @property (nonatomic, assign) NSTimeInterval timeoutInterval;
 @property (nonatomic, strong, readonly) NSDate *creationDate;
+/// 创建时间（CFAbsoluteTime），比较超时时不需要创建 NSDate
+@property (nonatomic, assign, readonly) CFAbsoluteTime creationTime;
+/// 创建时的单调时钟（纳秒，RTCVPMonotonicNanoseconds），ACK 超时和 RTT 用它计算，不受系统时间调整影响
+@property (nonatomic, assign, readonly) uint64_t creationUptime;
 
 #pragma mark - 初始化方法
 - (instancetype)initWithType:(RTCVPPacketType)type
@@ -80,7 +88,29 @@ typedef NS_ENUM(NSUInteger, RTCVPPacketState) {
 
 + (nullable instancetype)packetFromString:(NSString *)message;
 
+/// 解析 Socket.IO 文本包，失败时通过 error 返回原因
++ (nullable instancetype)packetFromString:(NSString *)message
+                                    error:(NSError * _Nullable * _Nullable)error;
+
+/// 解析 Socket.IO 文本包；deferArguments 为 YES 时文本事件只提取事件名和 ACK ID，
+/// 参数 JSON 在第一次访问 data/args 时才解析
++ (nullable instancetype)packetFromString:(NSString *)message
+                           deferArguments:(BOOL)deferArguments
+                                    error:(NSError * _Nullable * _Nullable)error;
+
+/// 直接解析传输层收到的 UTF-8 字节，避免先转成 NSString
++ (nullable instancetype)packetFromData:(NSData *)data
+                                  error:(NSError * _Nullable * _Nullable)error;
+
+#pragma mark - 编码
+/// 将 Socket.IO 包头和 JSON 负载直接写入 buffer（UTF-8），可连续写入多个包
+- (void)encodeIntoBuffer:(NSMutableData *)buffer;
+
+/// 带 Engine.IO message 前缀（'4'）的完整文本帧，WebSocket 和轮询都可直接发送
+- (NSData *)engineMessageData;
+
 #pragma mark - ACK管理
+/// 回调在完成该包的线程上同步执行（收到 ACK、超时时为 ACK 管理器的队列），需要切线程时由调用方自己派发
 - (void)setupAckCallbacksWithSuccess:(nullable RTCVPPacketSuccessCallback)success
                                error:(nullable RTCVPPacketErrorCallback)error
                              timeout:(NSTimeInterval)timeout;
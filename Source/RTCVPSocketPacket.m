@@ -9,16 +9,51 @@
 // RTCVPSocketPacket.m
 #import "RTCVPSocketPacket.h"
 #import "RTCDefaultSocketLogger.h"
+#import "RTCVPConnectionTimeline.h"
+#import <stdatomic.h>
+
+// 包类型名称表（静态，所有包共享）
+static NSString * const RTCVPPacketTypeNames[] = {
+    @"connect",
+    @"disconnect",
+    @"event",
+    @"ack",
+    @"error",
+    @"binaryEvent",
+    @"binaryAck"
+};
+
+static NSString *RTCVPPacketTypeName(RTCVPPacketType type) {
+    if (type < sizeof(RTCVPPacketTypeNames) / sizeof(RTCVPPacketTypeNames[0])) {
+        return RTCVPPacketTypeNames[type];
+    }
+    return @"unknown";
+}
 
-@interface RTCVPSocketPacket()
+/// ACK 簿记：回调和超时时间，只有需要 ACK 的发送包才会创建
+@interface RTCVPPacketAckContext : NSObject
 
-@property (nonatomic, strong) NSDictionary *packetStrings;
-@property (nonatomic, assign) int placeholders;
-@property (nonatomic, assign) RTCVPPacketState packetState;
-@property (nonatomic, strong) NSDate *internalCreationDate;
+@property (nonatomic, copy, nullable) RTCVPPacketSuccessCallback successCallback;
+@property (nonatomic, copy, nullable) RTCVPPacketErrorCallback errorCallback;
+@property (nonatomic, assign) NSTimeInterval timeoutInterval;
+
+@end
+
+@implementation RTCVPPacketAckContext
+@end
+
+@interface RTCVPSocketPacket() {
+    // 包状态，使用原子操作代替每个包一个串行队列
+    atomic_uint _packetState;
+    RTCVPPacketAckContext *_ackContext;
+    // 延迟解码：只提取了事件名，参数 JSON 在首次访问 data/args 时才解析
+    NSData *_rawPayload;
+    NSString *_eventName;
+    // 解码时记录的占位符位置，每项为 @[容器, 下标或键, num]，收齐附件后原地替换
+    NSMutableArray<NSArray *> *_placeholderSlots;
+}
 
-// 线程安全
-@property (nonatomic, strong) dispatch_queue_t stateQueue;
+@property (nonatomic, assign) int placeholders;
 
 @end
 
@@ -35,11 +70,9 @@
         _type = type;
         _nsp = [namespace copy] ?: @"/";
         _placeholders = placeholders;
-        _packetState = RTCVPPacketStatePending;
-        _internalCreationDate = [NSDate date];
-        _stateQueue = dispatch_queue_create("com.socketio.packet.state", DISPATCH_QUEUE_SERIAL);
-        
-        [self setupData];
+        atomic_init(&_packetState, RTCVPPacketStatePending);
+        _creationTime = CFAbsoluteTimeGetCurrent();
+        _creationUptime = RTCVPMonotonicNanoseconds();
     }
     return self;
 }
@@ -54,16 +87,14 @@
     self = [super init];
     if (self) {
         _type = type;
-        _data = [data mutableCopy];
+        _data = [data copy];
         _packetId = packetId;
         _nsp = [nsp copy] ?: @"/";
         _placeholders = placeholders;
         _binary = [binary mutableCopy];
-        _packetState = RTCVPPacketStatePending;
-        _internalCreationDate = [NSDate date];
-        _stateQueue = dispatch_queue_create("com.socketio.packet.state", DISPATCH_QUEUE_SERIAL);
-        
-        [self setupData];
+        atomic_init(&_packetState, RTCVPPacketStatePending);
+        _creationTime = CFAbsoluteTimeGetCurrent();
+        _creationUptime = RTCVPMonotonicNanoseconds();
     }
     return self;
 }
@@ -142,141 +173,102 @@
                                binary:binary];
 }
 
+#pragma mark - ACK簿记
+
+- (RTCVPPacketAckContext *)ackContextCreatingIfNeeded {
+    @synchronized (self) {
+        if (!_ackContext) {
+            _ackContext = [[RTCVPPacketAckContext alloc] init];
+        }
+        return _ackContext;
+    }
+}
+
+- (RTCVPPacketSuccessCallback)successCallback {
+    return _ackContext.successCallback;
+}
+
+- (void)setSuccessCallback:(RTCVPPacketSuccessCallback)successCallback {
+    [self ackContextCreatingIfNeeded].successCallback = successCallback;
+}
+
+- (RTCVPPacketErrorCallback)errorCallback {
+    return _ackContext.errorCallback;
+}
+
+- (void)setErrorCallback:(RTCVPPacketErrorCallback)errorCallback {
+    [self ackContextCreatingIfNeeded].errorCallback = errorCallback;
+}
+
+- (NSTimeInterval)timeoutInterval {
+    return _ackContext.timeoutInterval;
+}
+
+- (void)setTimeoutInterval:(NSTimeInterval)timeoutInterval {
+    [self ackContextCreatingIfNeeded].timeoutInterval = timeoutInterval;
+}
+
+/// 只允许从 Pending 进入终止状态，返回是否由本次调用完成转换
+- (BOOL)transitionFromPendingToState:(RTCVPPacketState)state {
+    unsigned int expected = RTCVPPacketStatePending;
+    return atomic_compare_exchange_strong(&_packetState, &expected, (unsigned int)state);
+}
+
 #pragma mark - 设置ACK回调
 
 - (void)setupAckCallbacksWithSuccess:(nullable RTCVPPacketSuccessCallback)success
                                error:(nullable RTCVPPacketErrorCallback)error
                              timeout:(NSTimeInterval)timeout {
     
-    __weak typeof(self) weakSelf = self;
-    
-    dispatch_async(_stateQueue, ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf || strongSelf.packetState != RTCVPPacketStatePending) {
-            return;
-        }
-        
-        strongSelf.successCallback = [success copy];
-        strongSelf.errorCallback = [error copy];
-        strongSelf.timeoutInterval = timeout;
-        
-        // 设置超时定时器
-        if (timeout > 0) {
-            [strongSelf startTimeoutTimer];
-        }
-    });
-}
-
-- (void)startTimeoutTimer {
-    __weak typeof(self) weakSelf = self;
+    if (self.state != RTCVPPacketStatePending) {
+        return;
+    }
     
-    dispatch_async(dispatch_get_main_queue(), ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf) return;
-        
-        [strongSelf.timeoutTimer invalidate];
-        strongSelf.timeoutTimer = [NSTimer scheduledTimerWithTimeInterval:strongSelf.timeoutInterval
-                                                                  repeats:NO
-                                                                    block:^(NSTimer * _Nonnull timer) {
-            [strongSelf handleTimeout];
-        }];
-    });
+    RTCVPPacketAckContext *context = [self ackContextCreatingIfNeeded];
+    context.successCallback = success;
+    context.errorCallback = error;
+    context.timeoutInterval = timeout;
 }
 
-- (void)handleTimeout {
-    __weak typeof(self) weakSelf = self;
+/// 终止状态确定后回调，状态转换保证只执行一次
+- (void)finishWithSuccess:(BOOL)success data:(nullable NSArray *)data error:(nullable NSError *)error {
+    RTCVPPacketAckContext *context = _ackContext;
+    if (!context) {
+        return;
+    }
     
-    dispatch_async(_stateQueue, ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf || strongSelf.packetState != RTCVPPacketStatePending) {
-            return;
+    if (success) {
+        if (context.successCallback) {
+            context.successCallback(data);
         }
-        
-        strongSelf.packetState = RTCVPPacketStateTimeout;
-        
-        NSError *error = [NSError errorWithDomain:@"RTCVPSocketIOErrorDomain"
-                                             code:-1
-                                         userInfo:@{NSLocalizedDescriptionKey: @"ACK timeout"}];
-        
-        dispatch_async(dispatch_get_main_queue(), ^{
-            if (strongSelf.errorCallback) {
-                strongSelf.errorCallback(error);
-            }
-            
-            [strongSelf.timeoutTimer invalidate];
-            strongSelf.timeoutTimer = nil;
-        });
-        
-        [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"包超时: packetId=%ld", (long)strongSelf.packetId]
-                                      type:@"SocketPacket"];
-    });
+    } else if (context.errorCallback) {
+        context.errorCallback(error);
+    }
 }
 
 #pragma mark - ACK处理
 
 - (void)acknowledgeWithData:(nullable NSArray *)data {
-    __weak typeof(self) weakSelf = self;
+    if (![self transitionFromPendingToState:RTCVPPacketStateAcknowledged]) {
+        return;
+    }
     
-    dispatch_async(_stateQueue, ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf || strongSelf.packetState != RTCVPPacketStatePending) {
-            return;
-        }
-        
-        strongSelf.packetState = RTCVPPacketStateAcknowledged;
-        
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [strongSelf.timeoutTimer invalidate];
-            strongSelf.timeoutTimer = nil;
-            
-            if (strongSelf.successCallback) {
-                strongSelf.successCallback(data);
-            }
-        });
-        
-        [RTCDefaultSocketLogger.logger log:[NSString stringWithFormat:@"包已确认: packetId=%ld", (long)strongSelf.packetId]
-                                      type:@"SocketPacket"];
-    });
+    [self finishWithSuccess:YES data:data error:nil];
+    
+    RTCVPLogDebug(@"SocketPacket", @"包已确认: packetId=%ld", (long)_packetId);
 }
 
 - (void)failWithError:(nullable NSError *)error {
-    __weak typeof(self) weakSelf = self;
+    // 失败（超时、容量清理等）统一进入 Timeout 终止态，区别于主动取消
+    if (![self transitionFromPendingToState:RTCVPPacketStateTimeout]) {
+        return;
+    }
     
-    dispatch_async(_stateQueue, ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf || strongSelf.packetState != RTCVPPacketStatePending) {
-            return;
-        }
-        
-        strongSelf.packetState = RTCVPPacketStateCancelled;
-        
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [strongSelf.timeoutTimer invalidate];
-            strongSelf.timeoutTimer = nil;
-            
-            if (strongSelf.errorCallback) {
-                strongSelf.errorCallback(error);
-            }
-        });
-    });
+    [self finishWithSuccess:NO data:nil error:error];
 }
 
 - (void)cancel {
-    __weak typeof(self) weakSelf = self;
-    
-    dispatch_async(_stateQueue, ^{
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf || strongSelf.packetState != RTCVPPacketStatePending) {
-            return;
-        }
-        
-        strongSelf.packetState = RTCVPPacketStateCancelled;
-        
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [strongSelf.timeoutTimer invalidate];
-            strongSelf.timeoutTimer = nil;
-        });
-    });
+    [self transitionFromPendingToState:RTCVPPacketStateCancelled];
 }
 
 #pragma mark - 二进制数据处理
@@ -302,23 +294,51 @@
 
 #pragma mark - 数据包构建
 
-- (void)setupData {
-    _packetStrings = @{
-        @(RTCVPPacketTypeConnect): @"connect",
-        @(RTCVPPacketTypeDisconnect): @"disconnect",
-        @(RTCVPPacketTypeEvent): @"event",
-        @(RTCVPPacketTypeAck): @"ack",
-        @(RTCVPPacketTypeError): @"error",
-        @(RTCVPPacketTypeBinaryEvent): @"binaryEvent",
-        @(RTCVPPacketTypeBinaryAck): @"binaryAck"
-    };
+- (NSString *)packetString {
+    NSMutableData *buffer = [NSMutableData dataWithCapacity:64];
+    [self encodeIntoBuffer:buffer];
+    return [[NSString alloc] initWithData:buffer encoding:NSUTF8StringEncoding] ?: @"";
 }
 
-- (NSString *)packetString {
-    return [self createPacketString];
+- (NSData *)engineMessageData {
+    NSMutableData *buffer = [NSMutableData dataWithCapacity:64];
+    // Engine.IO message 类型前缀 '4'
+    const uint8_t enginePrefix = '4';
+    [buffer appendBytes:&enginePrefix length:1];
+    [self encodeIntoBuffer:buffer];
+    return buffer;
+}
+
+- (NSArray *)data {
+    [self decodeRawPayloadIfNeeded];
+    return _data;
+}
+
+/// 解析延迟的 JSON 负载（入站包只在 handleQueue 上访问）
+- (void)decodeRawPayloadIfNeeded {
+    if (!_rawPayload) {
+        return;
+    }
+    
+    NSData *payload = _rawPayload;
+    _rawPayload = nil;
+    
+    NSError *jsonError = nil;
+    id jsonObject = [NSJSONSerialization JSONObjectWithData:payload options:0 error:&jsonError];
+    if ([jsonObject isKindOfClass:[NSArray class]]) {
+        _data = jsonObject;
+    } else {
+        _data = @[];
+        [RTCDefaultSocketLogger.logger error:[NSString stringWithFormat:@"延迟解析事件参数失败: %@", jsonError.localizedDescription ?: @"非数组负载"]
+                                        type:@"SocketParser"];
+    }
 }
 
 - (NSString *)event {
+    if (_eventName) {
+        return _eventName;
+    }
+    [self decodeRawPayloadIfNeeded];
     if (_data.count > 0 && (_type == RTCVPPacketTypeEvent || _type == RTCVPPacketTypeBinaryEvent)) {
         id firstItem = _data.firstObject;
         if ([firstItem isKindOfClass:[NSString class]]) {
@@ -328,7 +348,24 @@
     return @"";
 }
 
+- (NSString *)trailingStringArgument {
+    if (_rawPayload) {
+        NSString *string = nil;
+        if ([RTCVPSocketPacket _trailingString:&string inPayload:_rawPayload.bytes length:_rawPayload.length]) {
+            return string;
+        }
+        // 带转义字符等无法直接判断的情况交给完整解析
+    }
+    NSArray *data = self.data;
+    id last = data.lastObject;
+    if (data.count > 1 && [last isKindOfClass:[NSString class]]) {
+        return last;
+    }
+    return nil;
+}
+
 - (NSArray *)args {
+    [self decodeRawPayloadIfNeeded];
     if (_data.count == 0) {
         return @[];
     }
@@ -336,47 +373,8 @@
     switch (_type) {
         case RTCVPPacketTypeEvent:
         case RTCVPPacketTypeBinaryEvent: {
-            // 事件包格式：["eventName", arg1, arg2, ...] 或 ["eventName", arg1, arg2, ..., ackId]
-            
-            // 检查最后一个元素是否是ACK ID
-            BOOL hasAckId = NO;
-            NSInteger ackId = -1;
-            
-            if (_data.count >= 1) {
-                id lastItem = [_data lastObject];
-                if ([lastItem isKindOfClass:[NSNumber class]]) {
-                    ackId = [lastItem integerValue];
-                    // 合理的ACK ID范围是0-999
-                    if (ackId >= 0 && ackId < 1000) {
-                        hasAckId = YES;
-                    }
-                }
-            }
-            
-            // 提取参数
-            if (_data.count == 1) {
-                // 只有事件名，没有参数
-                return @[];
-            } else if (_data.count == 2) {
-                if (hasAckId) {
-                    // ["eventName", ackId]
-                    return @[];
-                } else {
-                    // ["eventName", arg]
-                    // 注意：即使arg是数组，也要原样返回
-                    return @[_data[1]];
-                }
-            } else {
-                // 多个参数
-                if (hasAckId) {
-                    // 排除第一个（事件名）和最后一个（ACK ID）
-                    NSRange range = NSMakeRange(1, _data.count - 2);
-                    return [_data subarrayWithRange:range];
-                } else {
-                    // 排除第一个（事件名）
-                    return [_data subarrayWithRange:NSMakeRange(1, _data.count - 1)];
-                }
-            }
+            // 事件包格式：["eventName", arg1, arg2, ...]，ACK ID 只在包头，数组里的数字都是参数
+            return [_data subarrayWithRange:NSMakeRange(1, _data.count - 1)];
         }
             
         case RTCVPPacketTypeAck:
@@ -404,91 +402,170 @@
     }
 }
 
-- (NSString *)createPacketString {
-    // 构建包字符串
-    NSMutableString *result = [NSMutableString string];
+- (void)encodeIntoBuffer:(NSMutableData *)buffer {
+    char header[32];
+    int length;
     
     // 1. 包类型
-    [result appendFormat:@"%d", (int)_type];
+    const uint8_t typeByte = (uint8_t)('0' + _type);
+    [buffer appendBytes:&typeByte length:1];
     
-    // 2. 二进制计数（如果是二进制包）
+    // 2. 二进制计数（如果是二进制包），即使没有二进制数据也要有 "0-"
     if (_type == RTCVPPacketTypeBinaryEvent || _type == RTCVPPacketTypeBinaryAck) {
-        // 修复：确保这里有"-"分隔符
-        if (_binary.count > 0) {
-            [result appendFormat:@"%lu-", (unsigned long)_binary.count];
-        } else {
-            [result appendString:@"0-"]; // 即使没有二进制数据也要有0-
-        }
+        length = snprintf(header, sizeof(header), "%lu-", (unsigned long)_binary.count);
+        [buffer appendBytes:header length:length];
     }
     
+    // connect/disconnect 的负载是单个对象（如 {pid, offset}），没有负载时包到命名空间为止
+    [self decodeRawPayloadIfNeeded];
+    BOOL namespacePacket = (_type == RTCVPPacketTypeConnect || _type == RTCVPPacketTypeDisconnect);
+    id namespacePayload = [_data.firstObject isKindOfClass:[NSDictionary class]] ? _data.firstObject : nil;
+    
     // 3. 命名空间（如果不是根命名空间）
-    if (![_nsp isEqualToString:@"/"]) {
-        [result appendString:_nsp];
-        [result appendString:@","];
+    if (_nsp.length > 0 && ![_nsp isEqualToString:@"/"]) {
+        const char *nspBytes = _nsp.UTF8String;
+        [buffer appendBytes:nspBytes length:strlen(nspBytes)];
+        if (namespacePacket && !namespacePayload) {
+            return;
+        }
+        [buffer appendBytes:"," length:1];
+    }
+    
+    if (namespacePacket) {
+        if (namespacePayload) {
+            NSData *jsonData = [NSJSONSerialization dataWithJSONObject:namespacePayload options:0 error:nil];
+            if (jsonData) {
+                [buffer appendData:jsonData];
+            }
+        }
+        return;
     }
     
     // 4. Packet ID（如果有）
     if (_packetId >= 0) {
-        [result appendString:[NSString stringWithFormat:@"%ld", (long)_packetId]];
+        length = snprintf(header, sizeof(header), "%ld", (long)_packetId);
+        [buffer appendBytes:header length:length];
     }
     
-    // 5. 数据
-    [result appendString:[self completeMessage:@""]];
-    
-    return result;
-}
-
-- (NSString *)completeMessage:(NSString *)message {
+    // 5. 数据：NSJSONSerialization 输出直接追加，不再经过 NSString
     if (_data.count > 0) {
         NSError *error = nil;
         NSData *jsonData = [NSJSONSerialization dataWithJSONObject:_data options:0 error:&error];
-        if (jsonData && !error) {
-            NSString *jsonString = [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
-            return [NSString stringWithFormat:@"%@%@", message, jsonString];
-        } else {
-            [RTCDefaultSocketLogger.logger error:@"Error creating JSON in completeMessage" type:@"SocketPacket"];
+        if (jsonData) {
+            [buffer appendData:jsonData];
+            return;
         }
+        [RTCDefaultSocketLogger.logger error:@"Error creating JSON in encodeIntoBuffer" type:@"SocketPacket"];
     }
-    return [NSString stringWithFormat:@"%@[]", message];
+    [buffer appendBytes:"[]" length:2];
 }
 
 #pragma mark - 占位符处理
 
 - (void)fillInPlaceholders {
-    NSMutableArray *filledArray = [NSMutableArray array];
-    for (id object in _data) {
-        [filledArray addObject:[self fillInPlaceholders:object]];
+    [self decodeRawPayloadIfNeeded];
+    
+    // 解码时已记录位置：只替换占位符本身，不复制整棵树
+    if (_placeholderSlots) {
+        for (NSArray *slot in _placeholderSlots) {
+            NSInteger num = [slot[2] integerValue];
+            if (num < 0 || num >= (NSInteger)_binary.count) {
+                continue;
+            }
+            id container = slot[0];
+            if ([container isKindOfClass:[NSMutableArray class]]) {
+                ((NSMutableArray *)container)[[slot[1] unsignedIntegerValue]] = _binary[num];
+            } else {
+                ((NSMutableDictionary *)container)[slot[1]] = _binary[num];
+            }
+        }
+        _placeholderSlots = nil;
+        return;
     }
-    _data = filledArray;
+    
+    _data = [self fillInPlaceholders:_data];
 }
 
+/// 只重建通向占位符的容器，没有占位符的子树原样返回
 - (id)fillInPlaceholders:(id)object {
     if ([object isKindOfClass:[NSDictionary class]]) {
         NSDictionary *dict = object;
-        NSNumber *placeholder = dict[@"_placeholder"];
-        if ([placeholder isKindOfClass:[NSNumber class]] && placeholder.boolValue) {
-            NSNumber *num = dict[@"num"];
-            if (num && _binary.count > num.integerValue) {
-                return _binary[num.integerValue];
-            }
+        NSInteger num = [[self class] _placeholderNumOf:dict];
+        if (num >= 0) {
+            return num < (NSInteger)_binary.count ? _binary[num] : object;
         }
         
-        NSMutableDictionary *result = [NSMutableDictionary dictionary];
-        for (id key in dict.allKeys) {
-            result[key] = [self fillInPlaceholders:dict[key]];
+        NSMutableDictionary *result = nil;
+        for (id key in dict) {
+            id value = dict[key];
+            id filled = [self fillInPlaceholders:value];
+            if (filled != value) {
+                if (!result) {
+                    result = [dict mutableCopy];
+                }
+                result[key] = filled;
+            }
         }
-        return result;
+        return result ?: dict;
     } else if ([object isKindOfClass:[NSArray class]]) {
         NSArray *arr = object;
-        NSMutableArray *filledArray = [NSMutableArray array];
-        for (id item in arr) {
-            [filledArray addObject:[self fillInPlaceholders:item]];
+        NSMutableArray *result = nil;
+        for (NSUInteger idx = 0; idx < arr.count; idx++) {
+            id item = arr[idx];
+            id filled = [self fillInPlaceholders:item];
+            if (filled != item) {
+                if (!result) {
+                    result = [arr mutableCopy];
+                }
+                result[idx] = filled;
+            }
         }
-        return filledArray;
+        return result ?: arr;
     }
     return object;
 }
 
+/// 解码二进制包时记录所有占位符的位置（容器为 NSJSONReadingMutableContainers 产生的可变容器）
+- (void)recordPlaceholderSlotsIn:(id)container {
+    if ([container isKindOfClass:[NSMutableArray class]]) {
+        NSMutableArray *arr = container;
+        for (NSUInteger idx = 0; idx < arr.count; idx++) {
+            [self recordPlaceholderSlot:arr[idx] container:arr key:@(idx)];
+        }
+    } else if ([container isKindOfClass:[NSMutableDictionary class]]) {
+        NSMutableDictionary *dict = container;
+        for (id key in dict) {
+            [self recordPlaceholderSlot:dict[key] container:dict key:key];
+        }
+    }
+}
+
+- (void)recordPlaceholderSlot:(id)value container:(id)container key:(id)key {
+    if ([value isKindOfClass:[NSDictionary class]]) {
+        NSInteger num = [[self class] _placeholderNumOf:value];
+        if (num >= 0) {
+            if (!_placeholderSlots) {
+                _placeholderSlots = [NSMutableArray arrayWithCapacity:(NSUInteger)MAX(_placeholders, 1)];
+            }
+            [_placeholderSlots addObject:@[container, key, @(num)]];
+            return;
+        }
+    }
+    [self recordPlaceholderSlotsIn:value];
+}
+
+/// {"_placeholder":true,"num":n} 返回 n，其它返回 -1
++ (NSInteger)_placeholderNumOf:(NSDictionary *)dict {
+    NSNumber *placeholder = dict[@"_placeholder"];
+    if ([placeholder isKindOfClass:[NSNumber class]] && placeholder.boolValue) {
+        NSNumber *num = dict[@"num"];
+        if ([num isKindOfClass:[NSNumber class]]) {
+            return num.integerValue;
+        }
+    }
+    return -1;
+}
+
 #pragma mark - 解析方法
 
 + (RTCVPSocketPacket *)packetFromString:(NSString *)message {
@@ -502,6 +579,7 @@
 }
 
 + (RTCVPSocketPacket *)packetFromString:(NSString *)message
+                         deferArguments:(BOOL)deferArguments
                                   error:(NSError **)error
 {
     if (message.length == 0) {
@@ -512,6 +590,48 @@
         }
         return nil;
     }
+    
+    // ASCII 字符串的 UTF8String 直接返回内部缓冲区，其余情况也只有一次转码
+    const char *bytes = message.UTF8String;
+    if (!bytes) {
+        if (error) {
+            *error = [NSError errorWithDomain:@"RTCVPSocketPacket"
+                                         code:-1
+                                     userInfo:@{NSLocalizedDescriptionKey: @"消息编码错误"}];
+        }
+        return nil;
+    }
+    
+    return [self packetFromBytes:(const uint8_t *)bytes length:strlen(bytes) deferArguments:deferArguments error:error];
+}
+
++ (RTCVPSocketPacket *)packetFromString:(NSString *)message
+                                  error:(NSError **)error
+{
+    return [self packetFromString:message deferArguments:NO error:error];
+}
+
++ (RTCVPSocketPacket *)packetFromData:(NSData *)data
+                                error:(NSError **)error
+{
+    return [self packetFromBytes:(const uint8_t *)data.bytes length:data.length deferArguments:NO error:error];
+}
+
+/// 单遍字节级解码：直接在 UTF-8 字节上解析 type / 附件数 / 命名空间 / id，
+/// JSON 负载以不拷贝的 NSData 交给 NSJSONSerialization
++ (RTCVPSocketPacket *)packetFromBytes:(const uint8_t *)bytes
+                                length:(NSUInteger)length
+                        deferArguments:(BOOL)deferArguments
+                                 error:(NSError **)error
+{
+    if (!bytes || length == 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:@"RTCVPSocketPacket"
+                                         code:-1
+                                     userInfo:@{NSLocalizedDescriptionKey: @"消息为空"}];
+        }
+        return nil;
+    }
 
     NSUInteger cursor = 0;
 
@@ -519,8 +639,8 @@
     // 1. 解析 packet type（Socket.IO packet type）
     // 标准格式socket.io格式：例如 42["welcome",{...}] 或 30[{"success":true,...}]
     // ------------------------------------------------------------------
-    unichar typeChar = [message characterAtIndex:cursor];
-    if (!isdigit(typeChar)) {
+    uint8_t typeByte = bytes[cursor];
+    if (typeByte < '0' || typeByte > '9') {
         if (error) {
             *error = [NSError errorWithDomain:@"RTCVPSocketPacket"
                                          code:-2
@@ -529,7 +649,7 @@
         return nil;
     }
 
-    RTCVPPacketType type = (RTCVPPacketType)(typeChar - '0');
+    RTCVPPacketType type = (RTCVPPacketType)(typeByte - '0');
     cursor++;
 
     // 检查是否为有效包类型
@@ -548,16 +668,20 @@
     // ------------------------------------------------------------------
     int binaryCount = 0;
     if ((type == RTCVPPacketTypeBinaryEvent || type == RTCVPPacketTypeBinaryAck) &&
-        cursor < message.length && [message characterAtIndex:cursor] != '[') {
+        cursor < length && bytes[cursor] != '[') {
         
-        NSMutableString *countStr = [NSMutableString string];
-        while (cursor < message.length && isdigit([message characterAtIndex:cursor])) {
-            [countStr appendFormat:@"%c", [message characterAtIndex:cursor]];
+        NSUInteger start = cursor;
+        int count = 0;
+        while (cursor < length && bytes[cursor] >= '0' && bytes[cursor] <= '9') {
+            count = count * 10 + (bytes[cursor] - '0');
             cursor++;
         }
-        if (cursor < message.length && [message characterAtIndex:cursor] == '-') {
+        if (cursor < length && bytes[cursor] == '-') {
             cursor++; // 跳过 '-'
-            binaryCount = [countStr intValue];
+            binaryCount = count;
+        } else {
+            // 没有 '-' 说明这些数字不是附件数，交给后面的 id 解析
+            cursor = start;
         }
     }
 
@@ -565,13 +689,17 @@
     // 3. 解析命名空间（可选）
     // ------------------------------------------------------------------
     NSString *nsp = @"/";
-    if (cursor < message.length && [message characterAtIndex:cursor] == '/') {
+    if (cursor < length && bytes[cursor] == '/') {
         NSUInteger start = cursor;
-        while (cursor < message.length && [message characterAtIndex:cursor] != ',') {
+        while (cursor < length && bytes[cursor] != ',') {
             cursor++;
         }
-        nsp = [message substringWithRange:NSMakeRange(start, cursor - start)];
-        if (cursor < message.length && [message characterAtIndex:cursor] == ',') {
+        if (cursor - start > 1) {
+            nsp = [[NSString alloc] initWithBytes:bytes + start
+                                           length:cursor - start
+                                         encoding:NSUTF8StringEncoding] ?: @"/";
+        }
+        if (cursor < length && bytes[cursor] == ',') {
             cursor++; // 跳过 ','
         }
     }
@@ -581,98 +709,162 @@
     // ------------------------------------------------------------------
     NSInteger packetId = -1;
     
-    if (cursor < message.length && isdigit([message characterAtIndex:cursor])) {
-        NSUInteger start = cursor;
-        while (cursor < message.length && isdigit([message characterAtIndex:cursor])) {
+    if (cursor < length && bytes[cursor] >= '0' && bytes[cursor] <= '9') {
+        packetId = 0;
+        while (cursor < length && bytes[cursor] >= '0' && bytes[cursor] <= '9') {
+            packetId = packetId * 10 + (bytes[cursor] - '0');
             cursor++;
         }
-        NSString *idStr = [message substringWithRange:NSMakeRange(start, cursor - start)];
-        packetId = [idStr integerValue];
     }
 
     // ------------------------------------------------------------------
     // 5. 解析 JSON payload
     // ------------------------------------------------------------------
     NSArray *data = @[];
-    NSArray *binary = @[];
+    
+    // 文本事件可以只提取事件名，参数留到有处理器需要时再解析
+    if (deferArguments && type == RTCVPPacketTypeEvent && cursor < length && bytes[cursor] == '[') {
+        NSString *eventName = [self _eventNameInPayload:bytes + cursor length:length - cursor];
+        if (eventName) {
+            RTCVPSocketPacket *packet = [[self alloc] initWithType:type
+                                                              data:@[]
+                                                          packetId:packetId
+                                                               nsp:nsp
+                                                      placeholders:0
+                                                            binary:@[]];
+            packet->_eventName = eventName;
+            packet->_rawPayload = [NSData dataWithBytes:bytes + cursor length:length - cursor];
+            return packet;
+        }
+    }
 
-    if (cursor < message.length) {
-        NSString *jsonPart = [message substringFromIndex:cursor];
-        
-        if (jsonPart.length > 0 && [jsonPart hasPrefix:@"["]) {
-            NSData *jsonData = [jsonPart dataUsingEncoding:NSUTF8StringEncoding];
-            NSError *jsonError = nil;
-            id jsonObject = [NSJSONSerialization JSONObjectWithData:jsonData
-                                                            options:0
-                                                              error:&jsonError];
-            if (jsonError) {
-                if (error) {
-                    *error = jsonError;
-                }
-                return nil;
+    if (cursor < length && (bytes[cursor] == '[' || bytes[cursor] == '{')) {
+        // 负载只在本次调用内同步使用，不需要拷贝
+        NSData *jsonData = [NSData dataWithBytesNoCopy:(void *)(bytes + cursor)
+                                                length:length - cursor
+                                          freeWhenDone:NO];
+        // 二进制包用可变容器解析，收齐附件后可以原地替换占位符
+        NSJSONReadingOptions options = binaryCount > 0 ? NSJSONReadingMutableContainers : 0;
+        NSError *jsonError = nil;
+        id jsonObject = [NSJSONSerialization JSONObjectWithData:jsonData
+                                                        options:options
+                                                          error:&jsonError];
+        if (!jsonObject) {
+            if (error) {
+                *error = jsonError;
             }
+            return nil;
+        }
 
-            if ([jsonObject isKindOfClass:[NSArray class]]) {
-                data = jsonObject;
-                
-                // 重要：对于ACK包，第一个元素应该是ACK ID
-                // 对于事件包，可能需要检查最后一个元素是否是ACK ID
-                if (type == RTCVPPacketTypeAck || type == RTCVPPacketTypeBinaryAck) {
-                    // ACK包：确保第一个元素是ACK ID
-                    if (data.count > 0 && [data[0] isKindOfClass:[NSNumber class]]) {
-                        // 第一个元素已经是ACK ID，保持原样
-                    }
-                } else if (type == RTCVPPacketTypeEvent || type == RTCVPPacketTypeBinaryEvent) {
-                    // 事件包：检查最后一个元素是否是ACK ID
-                    if (data.count > 1) {
-                        id lastItem = [data lastObject];
-                        if ([lastItem isKindOfClass:[NSNumber class]]) {
-                            NSInteger potentialAckId = [lastItem integerValue];
-                            if (potentialAckId >= 0 && potentialAckId < 1000) {
-                                // 最后一个元素是ACK ID
-                                packetId = potentialAckId;
-                            }
-                        }
-                    }
-                }
-            }
-        } else if (jsonPart.length > 0 && [jsonPart hasPrefix:@"{"]) {
+        if ([jsonObject isKindOfClass:[NSArray class]]) {
+            data = jsonObject;
+        } else {
             // 单个JSON对象
-            NSData *jsonData = [jsonPart dataUsingEncoding:NSUTF8StringEncoding];
-            NSError *jsonError = nil;
-            id jsonObject = [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:&jsonError];
-            
-            if (!jsonError) {
-                data = @[jsonObject];
-            } else {
-                if (error) *error = jsonError;
-                return nil;
-            }
+            data = @[jsonObject];
         }
     }
 
     // ------------------------------------------------------------------
-    // 6. 解析日志
+    // 6. 解析日志（不输出 data，避免对整个负载做 description）
     // ------------------------------------------------------------------
-    [RTCDefaultSocketLogger.logger log:
-     [NSString stringWithFormat:
-      @"Socket.IO packet parsed: type=%d, nsp=%@, id=%ld, placeholders=%d, data=%@",
-      (int)type, nsp, (long)packetId, binaryCount, data]
-                                  type:@"SocketParser"];
+    RTCVPLogDebug(@"SocketParser", @"Socket.IO packet parsed: type=%d, nsp=%@, id=%ld, placeholders=%d",
+                  (int)type, nsp, (long)packetId, binaryCount);
 
     // ------------------------------------------------------------------
     // 7. 构造 packet
     // ------------------------------------------------------------------
-    return [[self alloc] initWithType:type
-                                 data:data
-                             packetId:packetId
-                                  nsp:nsp
-                         placeholders:(int)binaryCount
-                               binary:@[]];
+    RTCVPSocketPacket *packet = [[self alloc] initWithType:type
+                                                      data:data
+                                                  packetId:packetId
+                                                       nsp:nsp
+                                              placeholders:(int)binaryCount
+                                                    binary:@[]];
+    if (binaryCount > 0 && [data isKindOfClass:[NSMutableArray class]]) {
+        // 保留解析出的可变数组本身，占位符位置指向它
+        packet->_data = data;
+        [packet recordPlaceholderSlotsIn:data];
+    }
+    return packet;
 }
 
 #pragma mark - 辅助解析方法
 
+/// 从 ["event", ...] 中直接读出事件名；带转义字符时返回 nil，交给完整解析
++ (nullable NSString *)_eventNameInPayload:(const uint8_t *)bytes length:(NSUInteger)length {
+    NSUInteger cursor = 1; // 跳过 '['
+    while (cursor < length && (bytes[cursor] == ' ' || bytes[cursor] == '\t' || bytes[cursor] == '\n' || bytes[cursor] == '\r')) {
+        cursor++;
+    }
+    if (cursor >= length || bytes[cursor] != '"') {
+        return nil;
+    }
+    
+    NSUInteger start = ++cursor;
+    while (cursor < length && bytes[cursor] != '"') {
+        if (bytes[cursor] == '\\') {
+            return nil;
+        }
+        cursor++;
+    }
+    if (cursor >= length) {
+        return nil;
+    }
+    
+    return [[NSString alloc] initWithBytes:bytes + start length:cursor - start encoding:NSUTF8StringEncoding];
+}
+
+/// 从 [..., "offset"] 末尾直接读出最后一个字符串参数，*string 在最后一项不是字符串或只有事件名时为 nil；
+/// 字符串带转义字符或格式不符合预期时返回 NO，交给完整解析
++ (BOOL)_trailingString:(NSString * _Nullable * _Nonnull)string inPayload:(const uint8_t *)bytes length:(NSUInteger)length {
+    *string = nil;
+    NSInteger cursor = (NSInteger)length - 1;
+    while (cursor >= 0 && (bytes[cursor] == ' ' || bytes[cursor] == '\t' || bytes[cursor] == '\n' || bytes[cursor] == '\r')) {
+        cursor--;
+    }
+    if (cursor < 0 || bytes[cursor] != ']') {
+        return NO;
+    }
+    cursor--;
+    while (cursor >= 0 && (bytes[cursor] == ' ' || bytes[cursor] == '\t' || bytes[cursor] == '\n' || bytes[cursor] == '\r')) {
+        cursor--;
+    }
+    if (cursor < 0) {
+        return NO;
+    }
+    if (bytes[cursor] != '"') {
+        return YES;
+    }
+    
+    NSInteger end = cursor--;
+    while (cursor >= 0 && bytes[cursor] != '"') {
+        if (bytes[cursor] == '\\') {
+            return NO;
+        }
+        cursor--;
+    }
+    if (cursor <= 0 || bytes[cursor - 1] == '\\') {
+        return NO;
+    }
+    NSInteger start = cursor + 1;
+    
+    // 字符串前是逗号才是参数，前面是 '[' 说明它是事件名本身
+    cursor--;
+    while (cursor >= 0 && (bytes[cursor] == ' ' || bytes[cursor] == '\t' || bytes[cursor] == '\n' || bytes[cursor] == '\r')) {
+        cursor--;
+    }
+    if (cursor < 0) {
+        return NO;
+    }
+    if (bytes[cursor] == '[') {
+        return YES;
+    }
+    if (bytes[cursor] != ',') {
+        return NO;
+    }
+    *string = [[NSString alloc] initWithBytes:bytes + start length:end - start encoding:NSUTF8StringEncoding];
+    return *string != nil;
+}
+
 + (BOOL)_isValidPacketType:(RTCVPPacketType)type {
     return (type == RTCVPPacketTypeConnect ||
             type == RTCVPPacketTypeDisconnect ||
@@ -683,91 +875,13 @@
             type == RTCVPPacketTypeBinaryAck);
 }
 
-+ (void)_parseDataFromArray:(NSArray *)jsonArray
-                 packetType:(RTCVPPacketType)type
-                   packetId:(NSInteger *)packetId
-                      data:(NSArray **)data {
-    
-    switch (type) {
-        case RTCVPPacketTypeEvent: {
-            // 事件格式: ["event", data..., ackId?]
-            if (jsonArray.count > 0) {
-                id lastItem = [jsonArray lastObject];
-                if ([lastItem isKindOfClass:[NSNumber class]]) {
-                    *packetId = [lastItem integerValue];
-                    *data = [jsonArray subarrayWithRange:NSMakeRange(0, jsonArray.count - 1)];
-                } else {
-                    *data = jsonArray;
-                }
-            }
-            break;
-        }
-            
-        case RTCVPPacketTypeAck: {
-            // ACK格式: [ackId, data...]
-            if (jsonArray.count > 0 && [jsonArray[0] isKindOfClass:[NSNumber class]]) {
-                *packetId = [jsonArray[0] integerValue];
-                if (jsonArray.count > 1) {
-                    *data = [jsonArray subarrayWithRange:NSMakeRange(1, jsonArray.count - 1)];
-                }
-            }
-            break;
-        }
-            
-        case RTCVPPacketTypeConnect: {
-            // Connect格式: [data..., ackId?]
-            if (jsonArray.count > 0) {
-                id lastItem = [jsonArray lastObject];
-                if ([lastItem isKindOfClass:[NSNumber class]]) {
-                    *packetId = [lastItem integerValue];
-                    *data = [jsonArray subarrayWithRange:NSMakeRange(0, jsonArray.count - 1)];
-                } else {
-                    *data = jsonArray;
-                }
-            }
-            break;
-        }
-            
-        case RTCVPPacketTypeDisconnect: {
-            // Disconnect格式: [ackId?, data...]
-            if (jsonArray.count > 0 && [jsonArray[0] isKindOfClass:[NSNumber class]]) {
-                *packetId = [jsonArray[0] integerValue];
-                if (jsonArray.count > 1) {
-                    *data = [jsonArray subarrayWithRange:NSMakeRange(1, jsonArray.count - 1)];
-                }
-            } else {
-                *data = jsonArray;
-            }
-            break;
-        }
-            
-        case RTCVPPacketTypeError: {
-            // Error格式: [errorData...]
-            *data = jsonArray;
-            break;
-        }
-            
-        default: {
-            *data = jsonArray;
-            break;
-
-
-        }
-
-    }
-
-}
-
 #pragma mark - 辅助方法
 
 + (NSArray *)parseItems:(NSArray *)items toBinary:(NSMutableArray *)binary {
-    NSMutableArray *parsedData = [NSMutableArray array];
-    for (id item in items) {
-        [parsedData addObject:[self shred:item binary:binary]];
-    }
-    return parsedData;
+    return [self shred:items binary:binary];
 }
 
+/// 把 NSData 替换成占位符；没有 NSData 的子树原样返回，只有通向附件的容器会被复制
 + (id)shred:(id)data binary:(NSMutableArray *)binary {
     if ([data isKindOfClass:[NSData class]]) {
         NSDictionary *placeholder = @{@"_placeholder": @YES, @"num": @(binary.count)};
@@ -775,18 +889,32 @@
         return placeholder;
     } else if ([data isKindOfClass:[NSArray class]]) {
         NSArray *arr = data;
-        NSMutableArray *result = [NSMutableArray array];
-        for (id item in arr) {
-            [result addObject:[self shred:item binary:binary]];
+        NSMutableArray *result = nil;
+        for (NSUInteger idx = 0; idx < arr.count; idx++) {
+            id item = arr[idx];
+            id shredded = [self shred:item binary:binary];
+            if (shredded != item) {
+                if (!result) {
+                    result = [arr mutableCopy];
+                }
+                result[idx] = shredded;
+            }
         }
-        return result;
+        return result ?: arr;
     } else if ([data isKindOfClass:[NSDictionary class]]) {
         NSDictionary *dict = data;
-        NSMutableDictionary *result = [NSMutableDictionary dictionary];
-        for (id key in dict.allKeys) {
-            result[key] = [self shred:dict[key] binary:binary];
+        NSMutableDictionary *result = nil;
+        for (id key in dict) {
+            id value = dict[key];
+            id shredded = [self shred:value binary:binary];
+            if (shredded != value) {
+                if (!result) {
+                    result = [dict mutableCopy];
+                }
+                result[key] = shredded;
+            }
         }
-        return result;
+        return result ?: dict;
     }
     return data;
 }
@@ -794,47 +922,27 @@
 #pragma mark - 状态查询
 
 - (BOOL)isPending {
-    __block BOOL result;
-    dispatch_sync(_stateQueue, ^{
-        result = (self.packetState == RTCVPPacketStatePending);
-    });
-    return result;
+    return self.state == RTCVPPacketStatePending;
 }
 
 - (BOOL)isAcknowledged {
-    __block BOOL result;
-    dispatch_sync(_stateQueue, ^{
-        result = (self.packetState == RTCVPPacketStateAcknowledged);
-    });
-    return result;
+    return self.state == RTCVPPacketStateAcknowledged;
 }
 
 - (BOOL)isTimedOut {
-    __block BOOL result;
-    dispatch_sync(_stateQueue, ^{
-        result = (self.packetState == RTCVPPacketStateTimeout);
-    });
-    return result;
+    return self.state == RTCVPPacketStateTimeout;
 }
 
 - (BOOL)isCancelled {
-    __block BOOL result;
-    dispatch_sync(_stateQueue, ^{
-        result = (self.packetState == RTCVPPacketStateCancelled);
-    });
-    return result;
+    return self.state == RTCVPPacketStateCancelled;
 }
 
 - (RTCVPPacketState)state {
-    __block RTCVPPacketState result;
-    dispatch_sync(_stateQueue, ^{
-        result = self.packetState;
-    });
-    return result;
+    return (RTCVPPacketState)atomic_load(&_packetState);
 }
 
 - (NSDate *)creationDate {
-    return _internalCreationDate;
+    return [NSDate dateWithTimeIntervalSinceReferenceDate:_creationTime];
 }
 
 #pragma mark - 调试信息
@@ -850,14 +958,14 @@
             "  timeout: %.1f,\n"
             "  creationDate: %@\n"
             "}",
-            self.packetStrings[@(_type)],
+            RTCVPPacketTypeName(_type),
             (long)_packetId,
             self.event,
             _nsp,
             _requiresAck ? @"YES" : @"NO",
-            (unsigned long)_packetState,
-            _timeoutInterval,
-            _internalCreationDate];
+            (unsigned long)self.state,
+            self.timeoutInterval,
+            self.creationDate];
 }
 
 - (NSString *)description {
@@ -25,3 +25,29 @@
 + (void)setLogLevel:(RTCLogLevel)level;
 
 @end
+
+#pragma mark - 日志宏
+
+/// 编译期开关：定义为 0 时 Debug 级日志连同参数求值一起被编译掉
+/// 例如在 Release 配置的 GCC_PREPROCESSOR_DEFINITIONS 中加入 RTCVP_LOG_DEBUG_ENABLED=0
+#ifndef RTCVP_LOG_DEBUG_ENABLED
+#define RTCVP_LOG_DEBUG_ENABLED 1
+#endif
+
+/// 按级别记录日志；日志关闭或级别不够时不格式化消息，也不对参数求值
+#define RTCVPLog(lvl, logType, fmt, ...) do { \
+    RTCVPSocketLogger *rtcvp_logger_ = RTCDefaultSocketLogger.logger; \
+    if (rtcvp_logger_ && [rtcvp_logger_ isEnabledForLevel:(lvl)]) { \
+        [rtcvp_logger_ logMessage:[NSString stringWithFormat:(fmt), ##__VA_ARGS__] type:(logType) level:(lvl)]; \
+    } \
+} while (0)
+
+#define RTCVPLogError(logType, fmt, ...)   RTCVPLog(RTCLogLevelError, logType, fmt, ##__VA_ARGS__)
+#define RTCVPLogWarning(logType, fmt, ...) RTCVPLog(RTCLogLevelWarning, logType, fmt, ##__VA_ARGS__)
+#define RTCVPLogInfo(logType, fmt, ...)    RTCVPLog(RTCLogLevelInfo, logType, fmt, ##__VA_ARGS__)
+
+#if RTCVP_LOG_DEBUG_ENABLED
+#define RTCVPLogDebug(logType, fmt, ...)   RTCVPLog(RTCLogLevelDebug, logType, fmt, ##__VA_ARGS__)
+#else
+#define RTCVPLogDebug(logType, fmt, ...)   do {} while (0)
+#endif
@@ -0,0 +1,49 @@
+//
+//  RTCVPConnectionTimeline.h
+//  RTCVPSocketIO
+//
+//  一次连接的各阶段时间点：单调时钟（CLOCK_UPTIME_RAW，纳秒），不受系统改时间影响。
+//  只有 WebSocket 传输有 TCP/TLS/升级响应三个阶段，纯轮询连接这三项为空。
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 连接阶段，按正常连接的先后顺序排列
+typedef NS_ENUM(NSInteger, RTCVPConnectionPhase) {
+    RTCVPConnectionPhaseStart = 0,           // 调用 connect
+    RTCVPConnectionPhaseTCPConnected,        // WebSocket TCP 连接建立
+    RTCVPConnectionPhaseTLSHandshake,        // TLS 握手完成（仅 wss）
+    RTCVPConnectionPhaseUpgradeResponse,     // 收到 HTTP 101 升级响应
+    RTCVPConnectionPhaseEngineOpen,          // 收到 Engine.IO open 包
+    RTCVPConnectionPhaseTransportUpgraded,   // 轮询探测并升级到 WebSocket 完成
+    RTCVPConnectionPhaseNamespaceConnected,  // 收到命名空间 CONNECT 响应
+    RTCVPConnectionPhaseFirstEvent,          // 收到第一个事件
+    RTCVPConnectionPhaseCount
+};
+
+/// 当前单调时间（纳秒），与 RTCJFRWebSocket 的阶段时间戳同一时钟
+FOUNDATION_EXPORT uint64_t RTCVPMonotonicNanoseconds(void);
+
+@interface RTCVPConnectionTimeline : NSObject <NSCopying>
+
+/// 阶段名，用作 dictionaryRepresentation 的 key（如 @"tcpConnected"）
++ (NSString *)nameForPhase:(RTCVPConnectionPhase)phase;
+
+/// 记录阶段时间，每个阶段只记第一次；返回是否为首次记录。线程安全
+- (BOOL)markPhase:(RTCVPConnectionPhase)phase;
+- (BOOL)markPhase:(RTCVPConnectionPhase)phase atTime:(uint64_t)timestamp;
+
+/// 阶段的单调时间戳（纳秒），未到达为 0
+- (uint64_t)timestampForPhase:(RTCVPConnectionPhase)phase;
+
+/// 阶段距 start 的秒数，未到达（或没有 start）为 -1
+- (NSTimeInterval)elapsedForPhase:(RTCVPConnectionPhase)phase;
+
+/// 已到达的阶段：阶段名 → 距 start 的毫秒数（NSNumber，double）
+- (NSDictionary<NSString *, NSNumber *> *)dictionaryRepresentation;
+
+@end
+
+NS_ASSUME_NONNULL_END
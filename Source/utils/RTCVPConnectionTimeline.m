@@ -0,0 +1,93 @@
+//
+//  RTCVPConnectionTimeline.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPConnectionTimeline.h"
+#import <time.h>
+
+uint64_t RTCVPMonotonicNanoseconds(void) {
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+@implementation RTCVPConnectionTimeline {
+    uint64_t _timestamps[RTCVPConnectionPhaseCount];
+}
+
++ (NSString *)nameForPhase:(RTCVPConnectionPhase)phase {
+    switch (phase) {
+        case RTCVPConnectionPhaseStart:              return @"start";
+        case RTCVPConnectionPhaseTCPConnected:       return @"tcpConnected";
+        case RTCVPConnectionPhaseTLSHandshake:       return @"tlsHandshake";
+        case RTCVPConnectionPhaseUpgradeResponse:    return @"upgradeResponse";
+        case RTCVPConnectionPhaseEngineOpen:         return @"engineOpen";
+        case RTCVPConnectionPhaseTransportUpgraded:  return @"transportUpgraded";
+        case RTCVPConnectionPhaseNamespaceConnected: return @"namespaceConnected";
+        case RTCVPConnectionPhaseFirstEvent:         return @"firstEvent";
+        default:                                     return @"unknown";
+    }
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    RTCVPConnectionTimeline *copy = [[[self class] allocWithZone:zone] init];
+    @synchronized (self) {
+        memcpy(copy->_timestamps, _timestamps, sizeof(_timestamps));
+    }
+    return copy;
+}
+
+#pragma mark - 记录
+
+- (BOOL)markPhase:(RTCVPConnectionPhase)phase {
+    return [self markPhase:phase atTime:RTCVPMonotonicNanoseconds()];
+}
+
+- (BOOL)markPhase:(RTCVPConnectionPhase)phase atTime:(uint64_t)timestamp {
+    if (phase < 0 || phase >= RTCVPConnectionPhaseCount || timestamp == 0) {
+        return NO;
+    }
+    @synchronized (self) {
+        if (_timestamps[phase] != 0) {
+            return NO;
+        }
+        _timestamps[phase] = timestamp;
+        return YES;
+    }
+}
+
+#pragma mark - 读取
+
+- (uint64_t)timestampForPhase:(RTCVPConnectionPhase)phase {
+    if (phase < 0 || phase >= RTCVPConnectionPhaseCount) {
+        return 0;
+    }
+    @synchronized (self) {
+        return _timestamps[phase];
+    }
+}
+
+- (NSTimeInterval)elapsedForPhase:(RTCVPConnectionPhase)phase {
+    uint64_t start = [self timestampForPhase:RTCVPConnectionPhaseStart];
+    uint64_t time = [self timestampForPhase:phase];
+    if (start == 0 || time == 0) {
+        return -1;
+    }
+    return time > start ? (double)(time - start) / NSEC_PER_SEC : 0;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)dictionaryRepresentation {
+    NSMutableDictionary<NSString *, NSNumber *> *dictionary = [NSMutableDictionary dictionary];
+    for (NSInteger phase = 0; phase < RTCVPConnectionPhaseCount; phase++) {
+        NSTimeInterval elapsed = [self elapsedForPhase:phase];
+        if (elapsed >= 0) {
+            dictionary[[RTCVPConnectionTimeline nameForPhase:phase]] = @(elapsed * 1000.0);
+        }
+    }
+    return dictionary;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<RTCVPConnectionTimeline %@>", [self dictionaryRepresentation]];
+}
+
+@end
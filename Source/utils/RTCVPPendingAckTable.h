@@ -0,0 +1,38 @@
+//
+//  RTCVPPendingAckTable.h
+//  RTCVPSocketIO
+//
+//  等待 ACK 的包表：以 32 位 ACK ID 为键的开放寻址哈希表（线性探测，删除时后移，不留墓碑），
+//  查找、插入、删除期望 O(1)，不需要把 ID 装箱成 NSNumber。
+//  ACK ID 是递增分配的，直接取低位作为槽位，相邻 ID 落在相邻槽位上几乎不冲突。
+//  不加锁，由 RTCVPACKManager 在自己的串行队列上访问。
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class RTCVPSocketPacket;
+
+@interface RTCVPPendingAckTable : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+/// capacity 为预计的最大条目数，装载因子超过 0.5 时自动扩容
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/// 插入，已存在相同 ID 时返回 NO；deadline 为包在时间轮上的超时项
+- (BOOL)setPacket:(RTCVPSocketPacket *)packet deadline:(nullable id)deadline forId:(uint32_t)packetId;
+
+- (nullable RTCVPSocketPacket *)packetForId:(uint32_t)packetId;
+
+/// 移除并返回包，deadline 输出它的超时项
+- (nullable RTCVPSocketPacket *)removePacketForId:(uint32_t)packetId deadline:(id _Nullable __autoreleasing * _Nullable)deadline;
+
+- (void)removeAllPackets;
+
+- (NSArray<RTCVPSocketPacket *> *)allPackets;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,177 @@
+//
+//  RTCVPPendingAckTable.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPPendingAckTable.h"
+#import "RTCVPSocketPacket.h"
+
+/// 装载因子不超过 0.5 的最小 2 的幂容量
+static NSUInteger RTCVPPendingAckTableCapacity(NSUInteger count) {
+    NSUInteger capacity = 16;
+    while (capacity < count * 2) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+@implementation RTCVPPendingAckTable {
+    uint32_t *_keys;
+    RTCVPSocketPacket * __strong *_packets;  // 为 nil 表示空槽
+    id __strong *_deadlines;
+    NSUInteger _capacity;
+    NSUInteger _mask;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:0];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        [self allocateSlots:RTCVPPendingAckTableCapacity(capacity)];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self removeAllPackets];
+    free(_keys);
+    free(_packets);
+    free(_deadlines);
+}
+
+#pragma mark - 存取
+
+- (BOOL)setPacket:(RTCVPSocketPacket *)packet deadline:(nullable id)deadline forId:(uint32_t)packetId {
+    if (!packet) {
+        return NO;
+    }
+    if ((_count + 1) * 2 > _capacity) {
+        [self growToCapacity:_capacity * 2];
+    }
+
+    NSUInteger index = packetId & _mask;
+    while (_packets[index]) {
+        if (_keys[index] == packetId) {
+            return NO;
+        }
+        index = (index + 1) & _mask;
+    }
+    _keys[index] = packetId;
+    _packets[index] = packet;
+    _deadlines[index] = deadline;
+    _count++;
+    return YES;
+}
+
+- (nullable RTCVPSocketPacket *)packetForId:(uint32_t)packetId {
+    NSUInteger index = [self indexOfId:packetId];
+    return index == NSNotFound ? nil : _packets[index];
+}
+
+- (nullable RTCVPSocketPacket *)removePacketForId:(uint32_t)packetId deadline:(id _Nullable __autoreleasing *)deadline {
+    NSUInteger index = [self indexOfId:packetId];
+    if (index == NSNotFound) {
+        if (deadline) {
+            *deadline = nil;
+        }
+        return nil;
+    }
+
+    RTCVPSocketPacket *packet = _packets[index];
+    if (deadline) {
+        *deadline = _deadlines[index];
+    }
+    _packets[index] = nil;
+    _deadlines[index] = nil;
+    _count--;
+
+    // 删除时后移：把探测链上后面的条目搬进空位，查找就不会提前遇到空槽
+    NSUInteger hole = index;
+    NSUInteger next = (hole + 1) & _mask;
+    while (_packets[next]) {
+        NSUInteger home = _keys[next] & _mask;
+        // home 不在环形区间 (hole, next] 内时才能搬到 hole
+        BOOL movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            _keys[hole] = _keys[next];
+            _packets[hole] = _packets[next];
+            _deadlines[hole] = _deadlines[next];
+            _packets[next] = nil;
+            _deadlines[next] = nil;
+            hole = next;
+        }
+        next = (next + 1) & _mask;
+    }
+    return packet;
+}
+
+- (void)removeAllPackets {
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        _packets[i] = nil;
+        _deadlines[i] = nil;
+    }
+    _count = 0;
+}
+
+- (NSArray<RTCVPSocketPacket *> *)allPackets {
+    NSMutableArray<RTCVPSocketPacket *> *packets = [NSMutableArray arrayWithCapacity:_count];
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        if (_packets[i]) {
+            [packets addObject:_packets[i]];
+        }
+    }
+    return packets;
+}
+
+#pragma mark - 槽位
+
+/// 键所在槽位，不存在时返回 NSNotFound
+- (NSUInteger)indexOfId:(uint32_t)packetId {
+    NSUInteger index = packetId & _mask;
+    while (_packets[index]) {
+        if (_keys[index] == packetId) {
+            return index;
+        }
+        index = (index + 1) & _mask;
+    }
+    return NSNotFound;
+}
+
+- (void)allocateSlots:(NSUInteger)capacity {
+    _capacity = capacity;
+    _mask = capacity - 1;
+    _keys = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+    _packets = (RTCVPSocketPacket * __strong *)calloc(capacity, sizeof(RTCVPSocketPacket *));
+    _deadlines = (id __strong *)calloc(capacity, sizeof(id));
+}
+
+- (void)growToCapacity:(NSUInteger)capacity {
+    uint32_t *oldKeys = _keys;
+    RTCVPSocketPacket * __strong *oldPackets = _packets;
+    id __strong *oldDeadlines = _deadlines;
+    NSUInteger oldCapacity = _capacity;
+
+    [self allocateSlots:capacity];
+    for (NSUInteger i = 0; i < oldCapacity; i++) {
+        if (!oldPackets[i]) {
+            continue;
+        }
+        NSUInteger index = oldKeys[i] & _mask;
+        while (_packets[index]) {
+            index = (index + 1) & _mask;
+        }
+        _keys[index] = oldKeys[i];
+        _packets[index] = oldPackets[i];
+        _deadlines[index] = oldDeadlines[i];
+        oldPackets[i] = nil;
+        oldDeadlines[i] = nil;
+    }
+    free(oldKeys);
+    free(oldPackets);
+    free(oldDeadlines);
+}
+
+@end
@@ -0,0 +1,35 @@
+//
+//  RTCVPPollingPayloadDecoder.h
+//  RTCVPSocketIO
+//
+//  轮询响应解码：游标直接在原始响应字节上移动，逐条给出记录的范围，不复制剩余缓冲区。
+//  Engine.IO v3：<length>:<packet>，length 为 JS 字符串长度（UTF-16 单元）
+//  Engine.IO v4：packet 之间用 0x1e 分隔
+//
+
+#import <Foundation/Foundation.h>
+#import "RTCVPSocketIOProtocolVersion.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface RTCVPPollingPayloadDecoder : NSObject
+
+/// 当前游标位置（字节）
+@property (nonatomic, assign, readonly) NSUInteger offset;
+
+/// 遇到格式错误（长度前缀不是数字、长度超出数据）后停止解码
+@property (nonatomic, assign, readonly) BOOL failed;
+
+- (instancetype)initWithData:(NSData *)data protocolVersion:(RTCVPSocketIOProtocolVersion)protocolVersion;
+
+/// 下一条记录在 data 中的字节范围，没有更多记录或格式错误时返回 NO
+- (BOOL)nextRecordRange:(NSRange *)range;
+
+/// 逐条回调记录的 UTF-8 字节；bytes 指向原始数据，只在回调内有效
++ (BOOL)enumerateRecordsInData:(NSData *)data
+               protocolVersion:(RTCVPSocketIOProtocolVersion)protocolVersion
+                    usingBlock:(void (NS_NOESCAPE ^)(const uint8_t *bytes, NSUInteger length, BOOL *stop))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
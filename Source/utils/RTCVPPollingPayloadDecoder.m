@@ -0,0 +1,123 @@
+//
+//  RTCVPPollingPayloadDecoder.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPPollingPayloadDecoder.h"
+
+/// 从 start 开始前进 units 个 UTF-16 单元，返回对应的字节数；4 字节序列算两个单元
+/// 数据在凑够 units 之前用完（记录被截断）时返回 NSNotFound
+static NSUInteger RTCVPUTF8LengthForUTF16Units(const uint8_t *bytes, NSUInteger available, NSUInteger units) {
+    NSUInteger position = 0;
+    while (units > 0 && position < available) {
+        uint8_t byte = bytes[position];
+        NSUInteger sequenceLength = 1;
+        NSUInteger sequenceUnits = 1;
+        if (byte >= 0xF0) {
+            sequenceLength = 4;
+            sequenceUnits = 2;
+        } else if (byte >= 0xE0) {
+            sequenceLength = 3;
+        } else if (byte >= 0xC0) {
+            sequenceLength = 2;
+        }
+        position += sequenceLength;
+        units = units > sequenceUnits ? units - sequenceUnits : 0;
+    }
+    if (units > 0 || position > available) {
+        return NSNotFound;
+    }
+    return position;
+}
+
+@implementation RTCVPPollingPayloadDecoder {
+    NSData *_data;
+    const uint8_t *_bytes;
+    NSUInteger _length;
+    BOOL _lengthPrefixed;
+}
+
+- (instancetype)initWithData:(NSData *)data protocolVersion:(RTCVPSocketIOProtocolVersion)protocolVersion {
+    self = [super init];
+    if (self) {
+        _data = data;
+        _bytes = (const uint8_t *)data.bytes;
+        _length = data.length;
+        _lengthPrefixed = protocolVersion < RTCVPSocketIOProtocolVersion3;
+    }
+    return self;
+}
+
+- (BOOL)nextRecordRange:(NSRange *)range {
+    if (_failed || _offset >= _length) {
+        return NO;
+    }
+    return _lengthPrefixed ? [self nextLengthPrefixedRecord:range] : [self nextSeparatedRecord:range];
+}
+
+/// Engine.IO v4：记录以 0x1e 分隔，空记录跳过
+- (BOOL)nextSeparatedRecord:(NSRange *)range {
+    while (_offset < _length) {
+        const uint8_t *start = _bytes + _offset;
+        const uint8_t *separator = memchr(start, 0x1e, _length - _offset);
+        NSUInteger recordLength = separator ? (NSUInteger)(separator - start) : _length - _offset;
+        NSUInteger location = _offset;
+        _offset += recordLength + (separator ? 1 : 0);
+        if (recordLength > 0) {
+            *range = NSMakeRange(location, recordLength);
+            return YES;
+        }
+    }
+    return NO;
+}
+
+/// Engine.IO v3：<length>:<packet>
+- (BOOL)nextLengthPrefixedRecord:(NSRange *)range {
+    NSUInteger units = 0;
+    NSUInteger position = _offset;
+    while (position < _length && _bytes[position] >= '0' && _bytes[position] <= '9') {
+        units = units * 10 + (_bytes[position] - '0');
+        position++;
+    }
+    
+    if (position == _offset || position >= _length || _bytes[position] != ':') {
+        // 没有长度前缀：整个剩余数据作为一条记录（与旧实现兼容单条消息的响应）
+        if (_offset == 0) {
+            *range = NSMakeRange(0, _length);
+            _offset = _length;
+            return YES;
+        }
+        _failed = YES;
+        return NO;
+    }
+    
+    position++; // 跳过 ':'
+    // 长度超出剩余数据时是截断的负载，不把半条记录交出去
+    NSUInteger byteLength = RTCVPUTF8LengthForUTF16Units(_bytes + position, _length - position, units);
+    if (byteLength == NSNotFound) {
+        _failed = YES;
+        return NO;
+    }
+    _offset = position + byteLength;
+    if (byteLength == 0) {
+        // 空记录（"0:"）跳过
+        return [self nextRecordRange:range];
+    }
+    *range = NSMakeRange(position, byteLength);
+    return YES;
+}
+
++ (BOOL)enumerateRecordsInData:(NSData *)data
+               protocolVersion:(RTCVPSocketIOProtocolVersion)protocolVersion
+                    usingBlock:(void (NS_NOESCAPE ^)(const uint8_t *, NSUInteger, BOOL *))block {
+    RTCVPPollingPayloadDecoder *decoder = [[self alloc] initWithData:data protocolVersion:protocolVersion];
+    const uint8_t *bytes = (const uint8_t *)data.bytes;
+    NSRange range;
+    BOOL stop = NO;
+    while (!stop && [decoder nextRecordRange:&range]) {
+        block(bytes + range.location, range.length, &stop);
+    }
+    return !decoder.failed;
+}
+
+@end
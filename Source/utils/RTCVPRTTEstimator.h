@@ -0,0 +1,43 @@
+//
+//  RTCVPRTTEstimator.h
+//  RTCVPSocketIO
+//
+//  往返时延估算（RFC 6298）：SRTT/RTTVAR 由 ACK 往返和 WebSocket ping/pong 采样更新，
+//  超时 = SRTT + max(G, 4 × RTTVAR)，快速链路上更早发现失败，抖动大的移动网络上减少误判超时。
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface RTCVPRTTEstimator : NSObject
+
+/// 平滑往返时延（秒），还没有采样时为 0
+@property (nonatomic, readonly) NSTimeInterval smoothedRTT;
+
+/// 往返时延平均偏差（秒）
+@property (nonatomic, readonly) NSTimeInterval rttVariance;
+
+/// 最近一次采样（秒）
+@property (nonatomic, readonly) NSTimeInterval latestRTT;
+
+/// 观察到的最小往返时延（秒）
+@property (nonatomic, readonly) NSTimeInterval minRTT;
+
+/// 采样次数
+@property (nonatomic, readonly) NSUInteger sampleCount;
+
+/// 加入一次往返采样（秒），可在任意线程调用，非正数忽略
+- (void)addSample:(NSTimeInterval)rtt;
+
+/// 按当前估算的超时，限制在 [minimum, maximum]；还没有采样时返回 fallback
+- (NSTimeInterval)timeoutWithFallback:(NSTimeInterval)fallback
+                              minimum:(NSTimeInterval)minimum
+                              maximum:(NSTimeInterval)maximum;
+
+/// 清空估算（网络切换后旧链路的采样不再有意义）
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
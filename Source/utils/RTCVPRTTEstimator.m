@@ -0,0 +1,69 @@
+//
+//  RTCVPRTTEstimator.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPRTTEstimator.h"
+
+// RFC 6298 推荐的增益：alpha = 1/8，beta = 1/4
+static const double kRTCVPRTTAlpha = 0.125;
+static const double kRTCVPRTTBeta = 0.25;
+// 时钟粒度 G，避免 RTTVAR 收敛到 0 后超时紧贴 SRTT
+static const NSTimeInterval kRTCVPRTTGranularity = 0.01;
+
+@implementation RTCVPRTTEstimator
+
+- (void)addSample:(NSTimeInterval)rtt {
+    if (!(rtt > 0)) {
+        return;
+    }
+    @synchronized (self) {
+        if (_sampleCount == 0) {
+            _smoothedRTT = rtt;
+            _rttVariance = rtt / 2;
+            _minRTT = rtt;
+        } else {
+            // 先用旧的 SRTT 更新 RTTVAR，再更新 SRTT
+            _rttVariance = (1 - kRTCVPRTTBeta) * _rttVariance + kRTCVPRTTBeta * fabs(_smoothedRTT - rtt);
+            _smoothedRTT = (1 - kRTCVPRTTAlpha) * _smoothedRTT + kRTCVPRTTAlpha * rtt;
+            _minRTT = MIN(_minRTT, rtt);
+        }
+        _latestRTT = rtt;
+        _sampleCount++;
+    }
+}
+
+- (NSTimeInterval)timeoutWithFallback:(NSTimeInterval)fallback
+                              minimum:(NSTimeInterval)minimum
+                              maximum:(NSTimeInterval)maximum {
+    NSTimeInterval timeout;
+    @synchronized (self) {
+        if (_sampleCount == 0) {
+            return fallback;
+        }
+        timeout = _smoothedRTT + MAX(kRTCVPRTTGranularity, 4 * _rttVariance);
+    }
+    if (maximum > 0) {
+        timeout = MIN(timeout, maximum);
+    }
+    return MAX(timeout, minimum);
+}
+
+- (void)reset {
+    @synchronized (self) {
+        _smoothedRTT = 0;
+        _rttVariance = 0;
+        _latestRTT = 0;
+        _minRTT = 0;
+        _sampleCount = 0;
+    }
+}
+
+- (NSString *)description {
+    @synchronized (self) {
+        return [NSString stringWithFormat:@"<RTCVPRTTEstimator srtt=%.1fms rttvar=%.1fms min=%.1fms samples=%lu>",
+                _smoothedRTT * 1000, _rttVariance * 1000, _minRTT * 1000, (unsigned long)_sampleCount];
+    }
+}
+
+@end
@@ -0,0 +1,77 @@
+//
+//  RTCVPReconnectDriver.h
+//  RTCVPSocketIO
+//
+//  重连状态机，客户端和 manager 共用：连接关闭后开始一轮重连，每次尝试失败（连接再次关闭）后
+//  按 RTCVPReconnectScheduler 的退避调度下一次，次数用完、连接成功或主动断开时结束。
+//  同时负责网络监控：WiFi 与蜂窝之间切换是瞬时故障，随后的第一次重连不等待。
+//  状态由 @synchronized(self) 保护，可在任意线程调用；重连定时和代理回调在初始化时传入的 queue 上执行。
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class RTCVPReconnectDriver;
+@class RTCVPSocketIOConfig;
+
+@protocol RTCVPReconnectDriverDelegate <NSObject>
+
+/// 开始新一轮重连
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver didStartWithReason:(NSString *)reason;
+
+/// 重连定时到期时询问是否还需要重连；返回 NO（已连接或不再需要重连）时本轮重连结束
+- (BOOL)reconnectDriverShouldAttempt:(RTCVPReconnectDriver *)driver;
+
+/// 发起第 attempt 次重连（从 1 开始）
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver attempt:(NSInteger)attempt;
+
+/// 本轮重连次数用完，重连已结束
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver didFailAfterAttempts:(NSInteger)attempts;
+
+/// 网络不可用或切换了链路，代理应关闭当前连接；linkChanged 为 YES 表示换了链路，旧的往返时延不再适用
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver networkDidChange:(NSString *)reason linkChanged:(BOOL)linkChanged;
+
+@end
+
+@interface RTCVPReconnectDriver : NSObject
+
+@property (nonatomic, weak, nullable) id<RTCVPReconnectDriverDelegate> delegate;
+
+/// 基础延迟（秒），默认 config.reconnectionDelay
+@property (nonatomic, assign) NSTimeInterval baseDelay;
+
+/// 每轮最多尝试次数，-1 为不限，默认 config.reconnectionAttempts
+@property (nonatomic, assign) NSInteger maxAttempts;
+
+/// 日志类型，默认为所属对象的类型名
+@property (nonatomic, copy) NSString *logType;
+
+/// 是否在一轮重连中
+@property (nonatomic, readonly, getter=isReconnecting) BOOL reconnecting;
+
+/// 本轮已发起的尝试次数
+@property (nonatomic, readonly) NSInteger currentAttempt;
+
++ (instancetype)driverWithConfig:(RTCVPSocketIOConfig *)config queue:(dispatch_queue_t)queue;
+
+#pragma mark - 重连
+
+/// 开始一轮重连，已在重连中时忽略；immediate 只用于明确的瞬时故障（如手动重连）
+- (void)startWithReason:(NSString *)reason immediately:(BOOL)immediate;
+
+/// 连接关闭且需要重连：不在重连中时开始一轮（网络切换导致的关闭第一次不等待），
+/// 在重连中且没有等待中的尝试时说明本次尝试失败，按退避调度下一次
+- (void)connectionDidClose:(NSString *)reason;
+
+/// 结束重连并清空退避（连接成功、主动断开或不再重连时调用）
+- (void)stop;
+
+#pragma mark - 网络监控
+
+- (void)startNetworkMonitoring;
+- (void)stopNetworkMonitoring;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,233 @@
+//
+//  RTCVPReconnectDriver.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPReconnectDriver.h"
+#import "RTCVPReconnectScheduler.h"
+#import "RTCVPSocketIOConfig.h"
+#import "RTCVPAFNetworkReachabilityManager.h"
+#import "RTCDefaultSocketLogger.h"
+
+@interface RTCVPReconnectDriver () {
+    BOOL _reconnecting;
+    BOOL _transientDisconnect;  // 网络切换导致的断开，第一次重连不等待
+    NSInteger _currentAttempt;
+}
+
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) RTCVPReconnectScheduler *scheduler;
+@property (nonatomic, strong, nullable) RTCVPAFNetworkReachabilityManager *networkManager;
+// 只在 queue 上访问
+@property (nonatomic, assign) RTCVPAFNetworkReachabilityStatus currentNetworkStatus;
+
+@end
+
+@implementation RTCVPReconnectDriver
+
++ (instancetype)driverWithConfig:(RTCVPSocketIOConfig *)config queue:(dispatch_queue_t)queue {
+    RTCVPReconnectDriver *driver = [[self alloc] init];
+    driver.queue = queue;
+    driver.scheduler = [RTCVPReconnectScheduler schedulerWithConfig:config queue:queue];
+    driver.maxAttempts = config.reconnectionAttempts;
+    driver.logType = @"RTCVPReconnectDriver";
+    return driver;
+}
+
+- (void)dealloc {
+    [_scheduler cancel];
+    [_networkManager stopMonitoring];
+}
+
+#pragma mark - 属性
+
+- (NSTimeInterval)baseDelay {
+    @synchronized (self) {
+        return self.scheduler.baseDelay;
+    }
+}
+
+- (void)setBaseDelay:(NSTimeInterval)baseDelay {
+    @synchronized (self) {
+        self.scheduler.baseDelay = baseDelay;
+    }
+}
+
+- (BOOL)isReconnecting {
+    @synchronized (self) {
+        return _reconnecting;
+    }
+}
+
+- (NSInteger)currentAttempt {
+    @synchronized (self) {
+        return _currentAttempt;
+    }
+}
+
+#pragma mark - 重连
+
+- (void)startWithReason:(NSString *)reason immediately:(BOOL)immediate {
+    @synchronized (self) {
+        if (_reconnecting) {
+            return;
+        }
+        _reconnecting = YES;
+        _currentAttempt = 0;
+        [self.scheduler reset];
+    }
+
+    RTCVPLogInfo(self.logType, @"Starting reconnect: %@", reason);
+    [self.delegate reconnectDriver:self didStartWithReason:reason];
+    [self scheduleNextAttemptImmediately:immediate];
+}
+
+- (void)connectionDidClose:(NSString *)reason {
+    BOOL transient = NO;
+    BOOL reconnecting = NO;
+    BOOL scheduled = NO;
+    @synchronized (self) {
+        transient = _transientDisconnect;
+        _transientDisconnect = NO;
+        reconnecting = _reconnecting;
+        scheduled = self.scheduler.isScheduled;
+    }
+
+    if (!reconnecting) {
+        [self startWithReason:reason immediately:transient];
+    } else if (!scheduled) {
+        // 本次重连尝试失败，按退避调度下一次
+        [self scheduleNextAttemptImmediately:NO];
+    }
+}
+
+- (void)stop {
+    @synchronized (self) {
+        _reconnecting = NO;
+        _transientDisconnect = NO;
+        _currentAttempt = 0;
+        [self.scheduler reset];
+    }
+}
+
+/// 重连只由调度器驱动：每次尝试失败（连接关闭）后才调度下一次
+- (void)scheduleNextAttemptImmediately:(BOOL)immediate {
+    NSInteger attempts = 0;
+    BOOL exhausted = NO;
+    NSTimeInterval delay = 0;
+    @synchronized (self) {
+        if (!_reconnecting) {
+            return;
+        }
+        attempts = _currentAttempt;
+        if (self.maxAttempts != -1 && attempts >= self.maxAttempts) {
+            exhausted = YES;
+            _reconnecting = NO;
+            [self.scheduler reset];
+        } else {
+            __weak typeof(self) weakSelf = self;
+            delay = [self.scheduler scheduleImmediately:immediate block:^{
+                [weakSelf attemptReconnect];
+            }];
+        }
+    }
+
+    if (exhausted) {
+        RTCVPLogWarning(self.logType, @"Reconnect failed after %ld attempts", (long)attempts);
+        [self.delegate reconnectDriver:self didFailAfterAttempts:attempts];
+        return;
+    }
+    RTCVPLogDebug(self.logType, @"Setting reconnect timer for %.2f seconds", delay);
+}
+
+- (void)attemptReconnect {
+    if (!self.isReconnecting) {
+        return;
+    }
+    id<RTCVPReconnectDriverDelegate> delegate = self.delegate;
+    if (![delegate reconnectDriverShouldAttempt:self]) {
+        RTCVPLogDebug(self.logType, @"Reconnect timer fired but reconnect is no longer needed");
+        [self stop];
+        return;
+    }
+
+    NSInteger attempt = 0;
+    @synchronized (self) {
+        attempt = ++_currentAttempt;
+    }
+    RTCVPLogInfo(self.logType, @"Trying to reconnect (attempt %ld/%ld)",
+                 (long)attempt, self.maxAttempts == -1 ? LONG_MAX : (long)self.maxAttempts);
+    [delegate reconnectDriver:self attempt:attempt];
+}
+
+#pragma mark - 网络监控
+
+- (void)startNetworkMonitoring {
+    if (self.networkManager) {
+        return;
+    }
+    self.networkManager = [RTCVPAFNetworkReachabilityManager sharedManager];
+    [self.networkManager startMonitoring];
+    self.currentNetworkStatus = RTCVPAFNetworkReachabilityStatusUnknown;
+
+    __weak typeof(self) weakSelf = self;
+    [self.networkManager setReachabilityStatusChangeBlock:^(RTCVPAFNetworkReachabilityStatus status) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf) {
+            return;
+        }
+        dispatch_async(strongSelf.queue, ^{
+            [strongSelf handleNetworkStatusChange:status];
+        });
+    }];
+}
+
+- (void)stopNetworkMonitoring {
+    if (self.networkManager) {
+        [self.networkManager stopMonitoring];
+        self.networkManager = nil;
+    }
+}
+
+- (void)handleNetworkStatusChange:(RTCVPAFNetworkReachabilityStatus)status {
+    if (self.currentNetworkStatus == RTCVPAFNetworkReachabilityStatusUnknown) {
+        self.currentNetworkStatus = status;
+        return;
+    }
+
+    RTCVPAFNetworkReachabilityStatus previous = self.currentNetworkStatus;
+    self.currentNetworkStatus = status;
+
+    switch (status) {
+        case RTCVPAFNetworkReachabilityStatusUnknown:
+        case RTCVPAFNetworkReachabilityStatusNotReachable: {
+            RTCVPLogWarning(self.logType, @"ERROR ==========No network===========");
+            [self.delegate reconnectDriver:self networkDidChange:@"No network or not reachable" linkChanged:NO];
+            break;
+        }
+        case RTCVPAFNetworkReachabilityStatusReachableViaWWAN: {
+            if (previous == RTCVPAFNetworkReachabilityStatusReachableViaWiFi) {
+                RTCVPLogWarning(self.logType, @"ERROR ==========Network changed: WiFi to 4G===========");
+                [self linkDidChange:@"Network changed: WiFi to 4G"];
+            }
+            break;
+        }
+        case RTCVPAFNetworkReachabilityStatusReachableViaWiFi: {
+            if (previous == RTCVPAFNetworkReachabilityStatusReachableViaWWAN) {
+                RTCVPLogWarning(self.logType, @"ERROR ==========Network changed: 4G to WiFi===========");
+                [self linkDidChange:@"Network changed: 4G to WiFi"];
+            }
+            break;
+        }
+    }
+}
+
+/// 网络切换是瞬时故障，新链路已可用，随后的第一次重连不等待
+- (void)linkDidChange:(NSString *)reason {
+    @synchronized (self) {
+        _transientDisconnect = YES;
+    }
+    [self.delegate reconnectDriver:self networkDidChange:reason linkChanged:YES];
+}
+
+@end
@@ -0,0 +1,49 @@
+//
+//  RTCVPReconnectScheduler.h
+//  RTCVPSocketIO
+//
+//  重连调度：客户端唯一的重连退避来源，引擎不再自行重连。
+//  延迟 = 指数退避 × (1 - randomizationFactor) + 去相关抖动 × randomizationFactor，
+//  去相关抖动在 [reconnectionDelay, 上次延迟 × 3] 之间取值，服务端重启后客户端不会同时重连。
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class RTCVPSocketIOConfig;
+
+@interface RTCVPReconnectScheduler : NSObject
+
+/// 基础延迟（秒，对应 config.reconnectionDelay）
+@property (nonatomic, assign) NSTimeInterval baseDelay;
+
+/// 最大延迟（秒，对应 config.reconnectionDelayMax）
+@property (nonatomic, assign) NSTimeInterval maxDelay;
+
+/// 抖动比例（0.0-1.0，对应 config.randomizationFactor），0 为纯指数退避
+@property (nonatomic, assign) double randomizationFactor;
+
+/// 本轮已计算过的延迟次数
+@property (nonatomic, readonly) NSInteger attempts;
+
+/// 是否有等待中的重连
+@property (nonatomic, readonly, getter=isScheduled) BOOL scheduled;
+
++ (instancetype)schedulerWithConfig:(RTCVPSocketIOConfig *)config queue:(dispatch_queue_t)queue;
+
+/// 计算下一次延迟并推进退避状态
+- (NSTimeInterval)nextDelay;
+
+/// 调度一次重连，已有等待中的重连时先取消；immediate 只用于明确的瞬时故障，返回实际延迟
+- (NSTimeInterval)scheduleImmediately:(BOOL)immediate block:(dispatch_block_t)block;
+
+/// 取消等待中的重连，保留退避状态
+- (void)cancel;
+
+/// 取消并清空退避状态（连接成功或主动断开时调用）
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,92 @@
+//
+//  RTCVPReconnectScheduler.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPReconnectScheduler.h"
+#import "RTCVPSocketIOConfig.h"
+#import "RTCVPTimer.h"
+
+@interface RTCVPReconnectScheduler ()
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) RTCVPTimer *timer;
+@property (nonatomic, assign) NSTimeInterval previousDelay;
+@property (nonatomic, assign) NSInteger attempts;
+@end
+
+@implementation RTCVPReconnectScheduler
+
++ (instancetype)schedulerWithConfig:(RTCVPSocketIOConfig *)config queue:(dispatch_queue_t)queue {
+    RTCVPReconnectScheduler *scheduler = [[self alloc] init];
+    scheduler.queue = queue;
+    scheduler.baseDelay = config.reconnectionDelay;
+    scheduler.maxDelay = config.reconnectionDelayMax;
+    scheduler.randomizationFactor = config.randomizationFactor;
+    return scheduler;
+}
+
+- (void)dealloc {
+    [_timer cancel];
+}
+
+#pragma mark - 退避计算
+
+- (NSTimeInterval)nextDelay {
+    NSTimeInterval base = MAX(self.baseDelay, 0);
+    NSTimeInterval cap = MAX(self.maxDelay, base);
+    double factor = MIN(MAX(self.randomizationFactor, 0.0), 1.0);
+
+    // 指数部分：base * 2^n
+    NSTimeInterval exponential = MIN(cap, base * pow(2, MIN(self.attempts, 31)));
+
+    // 去相关部分：[base, 上次延迟 * 3] 内均匀取值
+    NSTimeInterval previous = self.attempts == 0 ? base : self.previousDelay;
+    NSTimeInterval upper = MIN(cap, MAX(base, previous * 3));
+    double random = (double)arc4random() / UINT32_MAX;
+    NSTimeInterval decorrelated = base + (upper - base) * random;
+
+    NSTimeInterval delay = exponential * (1.0 - factor) + decorrelated * factor;
+    self.previousDelay = delay;
+    self.attempts += 1;
+    return delay;
+}
+
+#pragma mark - 调度
+
+- (NSTimeInterval)scheduleImmediately:(BOOL)immediate block:(dispatch_block_t)block {
+    [self cancel];
+
+    // 瞬时故障立即重试，但不重置退避，紧接着再失败时仍按原节奏退避
+    NSTimeInterval delay = immediate ? 0 : [self nextDelay];
+
+    __weak typeof(self) weakSelf = self;
+    self.timer = [RTCVPTimer scheduledTimerWithTimeInterval:delay
+                                                    repeats:NO
+                                                      queue:self.queue
+                                                      block:^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf || !strongSelf.timer) {
+            return;
+        }
+        strongSelf.timer = nil;
+        block();
+    }];
+    return delay;
+}
+
+- (BOOL)isScheduled {
+    return self.timer != nil;
+}
+
+- (void)cancel {
+    [self.timer cancel];
+    self.timer = nil;
+}
+
+- (void)reset {
+    [self cancel];
+    self.attempts = 0;
+    self.previousDelay = 0;
+}
+
+@end
@@ -0,0 +1,19 @@
+//
+//  RTCVPSocketJSONParser.h
+//  RTCVPSocketIO
+//
+//  默认的 Socket.IO 文本格式（JSON + 二进制附件占位符）
+//
+
+#import <Foundation/Foundation.h>
+#import "RTCVPSocketParser.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface RTCVPSocketJSONParser : NSObject <RTCVPSocketParser>
+
++ (instancetype)parser;
+
+@end
+
+NS_ASSUME_NONNULL_END
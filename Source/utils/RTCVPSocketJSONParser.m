@@ -0,0 +1,44 @@
+//
+//  RTCVPSocketJSONParser.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPSocketJSONParser.h"
+#import "RTCVPSocketPacket.h"
+
+@implementation RTCVPSocketJSONParser
+
++ (instancetype)parser {
+    static RTCVPSocketJSONParser *sharedParser;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedParser = [[self alloc] init];
+    });
+    return sharedParser;
+}
+
+- (BOOL)encodesToBinary {
+    return NO;
+}
+
+- (void)encodePacket:(RTCVPSocketPacket *)packet intoBuffer:(NSMutableData *)buffer {
+    [packet encodeIntoBuffer:buffer];
+}
+
+- (RTCVPSocketPacket *)decodeString:(NSString *)message
+                     deferArguments:(BOOL)deferArguments
+                              error:(NSError **)error {
+    return [RTCVPSocketPacket packetFromString:message deferArguments:deferArguments error:error];
+}
+
+- (RTCVPSocketPacket *)decodeData:(NSData *)data error:(NSError **)error {
+    // 文本格式下二进制帧只是附件，由等待中的包认领
+    if (error) {
+        *error = [NSError errorWithDomain:@"RTCVPSocketParser"
+                                     code:-1
+                                 userInfo:@{NSLocalizedDescriptionKey: @"JSON parser does not decode binary frames"}];
+    }
+    return nil;
+}
+
+@end
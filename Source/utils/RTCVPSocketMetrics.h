@@ -0,0 +1,91 @@
+//
+//  RTCVPSocketMetrics.h
+//  RTCVPSocketIO
+//
+//  运行时指标：计数器和延迟直方图都用原子操作更新，热路径上不加锁；
+//  RTCVPSocketMetricsSnapshot 是某一时刻的只读快照，供上报到业务自己的监控系统。
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 累计计数器
+typedef NS_ENUM(NSInteger, RTCVPMetricCounter) {
+    RTCVPMetricPollingBytesOut = 0,     // 轮询 POST 发出的负载字节
+    RTCVPMetricPollingBytesIn,          // 轮询 GET 收到的负载字节
+    RTCVPMetricPollingFramesOut,        // 轮询发出的 Engine.IO 包数
+    RTCVPMetricPollingFramesIn,         // 轮询收到的 Engine.IO 包数
+    RTCVPMetricWebSocketBytesOut,       // WebSocket 发出的数据帧负载字节（不含心跳/探测控制帧）
+    RTCVPMetricWebSocketBytesIn,        // WebSocket 收到的数据帧负载字节
+    RTCVPMetricWebSocketFramesOut,      // WebSocket 发出的数据帧数
+    RTCVPMetricWebSocketFramesIn,       // WebSocket 收到的数据帧数
+    RTCVPMetricEmits,                   // 发出的事件数
+    RTCVPMetricEvents,                  // 收到的事件数
+    RTCVPMetricReconnects,              // 重连尝试次数
+    RTCVPMetricCounterCount
+};
+
+/// 快照时采样的队列深度
+typedef NS_ENUM(NSInteger, RTCVPMetricGauge) {
+    RTCVPMetricPostWaitDepth = 0,       // 等待 POST 的包
+    RTCVPMetricProbeWaitDepth,          // 探测期间缓存的包
+    RTCVPMetricWaitingPacketsDepth,     // 等待二进制附件的包
+    RTCVPMetricDataCacheDepth,          // 未连接时缓存的事件
+    RTCVPMetricPendingAckDepth,         // 等待 ACK 的包
+    RTCVPMetricGaugeCount
+};
+
+/// HDR 风格的对数线性直方图（单位微秒）：每个 2 的幂区间分 16 个桶，相对误差约 6%
+@interface RTCVPLatencyHistogram : NSObject <NSCopying>
+
+/// 记录一个值，无锁，可在任意线程调用
+- (void)recordValue:(uint64_t)microseconds;
+
+@property (nonatomic, readonly) uint64_t count;
+@property (nonatomic, readonly) uint64_t maxValue;
+@property (nonatomic, readonly) double mean;
+
+/// 百分位数（0-100），返回所在桶的上界，不超过 maxValue；没有数据时为 0
+- (uint64_t)valueAtPercentile:(double)percentile;
+
+@end
+
+/// 一组计数器，客户端和引擎各持有一个
+@interface RTCVPSocketMetrics : NSObject
+
+/// 发出事件到收到 ACK 的耗时
+@property (nonatomic, strong, readonly) RTCVPLatencyHistogram *ackLatency;
+
+/// 无锁累加
+- (void)addValue:(uint64_t)value toCounter:(RTCVPMetricCounter)counter;
+- (uint64_t)valueForCounter:(RTCVPMetricCounter)counter;
+
+@end
+
+@interface RTCVPSocketMetricsSnapshot : NSObject
+
+/// 快照时间（单调时钟，秒）
+@property (nonatomic, readonly) NSTimeInterval timestamp;
+
+/// 距上一次快照（第一次为计数器创建以来）的发出/收到事件速率
+@property (nonatomic, readonly) double emitsPerSecond;
+@property (nonatomic, readonly) double eventsPerSecond;
+
+/// ACK 延迟直方图的快照
+@property (nonatomic, strong, readonly) RTCVPLatencyHistogram *ackLatency;
+
+/// 合并多个计数器组（客户端 + 引擎），gauges 为 RTCVPMetricGaugeCount 个队列深度
+- (instancetype)initWithMetrics:(NSArray<RTCVPSocketMetrics *> *)metrics
+                         gauges:(const NSUInteger *)gauges
+                       previous:(nullable RTCVPSocketMetricsSnapshot *)previous;
+
+- (uint64_t)valueForCounter:(RTCVPMetricCounter)counter;
+- (NSUInteger)valueForGauge:(RTCVPMetricGauge)gauge;
+
+/// 扁平字典，key 如 @"websocketBytesOut"、@"postWaitDepth"、@"ackLatencyP99"（微秒）
+- (NSDictionary<NSString *, NSNumber *> *)dictionaryRepresentation;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,270 @@
+//
+//  RTCVPSocketMetrics.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPSocketMetrics.h"
+#import "RTCVPConnectionTimeline.h"
+#import <stdatomic.h>
+
+// 子桶 16 个（4 位精度），最大记录 2^40 微秒（约 12 天）
+static const int kRTCVPHistogramSubBucketBits = 4;
+static const uint64_t kRTCVPHistogramSubBucketCount = 1 << kRTCVPHistogramSubBucketBits;
+static const uint64_t kRTCVPHistogramMaxValue = (1ULL << 40) - 1;
+static const NSUInteger kRTCVPHistogramBucketCount = (40 - kRTCVPHistogramSubBucketBits + 1) * kRTCVPHistogramSubBucketCount;
+
+static NSTimeInterval RTCVPMonotonicSeconds(void) {
+    return (double)RTCVPMonotonicNanoseconds() / NSEC_PER_SEC;
+}
+
+/// 值所在的桶：小于 32 的值一桶一个，之后每个 2 的幂区间 16 个桶
+static NSUInteger RTCVPHistogramBucketIndex(uint64_t value) {
+    if (value < 2 * kRTCVPHistogramSubBucketCount) {
+        return (NSUInteger)value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kRTCVPHistogramSubBucketBits;
+    return (NSUInteger)shift * kRTCVPHistogramSubBucketCount + (NSUInteger)(value >> shift);
+}
+
+/// 桶内最大值
+static uint64_t RTCVPHistogramBucketUpperBound(NSUInteger index) {
+    if (index < 2 * kRTCVPHistogramSubBucketCount) {
+        return index;
+    }
+    NSUInteger shift = index / kRTCVPHistogramSubBucketCount - 1;
+    uint64_t sub = index % kRTCVPHistogramSubBucketCount + kRTCVPHistogramSubBucketCount;
+    return ((sub + 1) << shift) - 1;
+}
+
+static NSString *RTCVPMetricCounterName(RTCVPMetricCounter counter) {
+    switch (counter) {
+        case RTCVPMetricPollingBytesOut:    return @"pollingBytesOut";
+        case RTCVPMetricPollingBytesIn:     return @"pollingBytesIn";
+        case RTCVPMetricPollingFramesOut:   return @"pollingFramesOut";
+        case RTCVPMetricPollingFramesIn:    return @"pollingFramesIn";
+        case RTCVPMetricWebSocketBytesOut:  return @"websocketBytesOut";
+        case RTCVPMetricWebSocketBytesIn:   return @"websocketBytesIn";
+        case RTCVPMetricWebSocketFramesOut: return @"websocketFramesOut";
+        case RTCVPMetricWebSocketFramesIn:  return @"websocketFramesIn";
+        case RTCVPMetricEmits:              return @"emits";
+        case RTCVPMetricEvents:             return @"events";
+        case RTCVPMetricReconnects:         return @"reconnects";
+        default:                            return @"unknown";
+    }
+}
+
+static NSString *RTCVPMetricGaugeName(RTCVPMetricGauge gauge) {
+    switch (gauge) {
+        case RTCVPMetricPostWaitDepth:       return @"postWaitDepth";
+        case RTCVPMetricProbeWaitDepth:      return @"probeWaitDepth";
+        case RTCVPMetricWaitingPacketsDepth: return @"waitingPacketsDepth";
+        case RTCVPMetricDataCacheDepth:      return @"dataCacheDepth";
+        case RTCVPMetricPendingAckDepth:     return @"pendingAckDepth";
+        default:                             return @"unknown";
+    }
+}
+
+#pragma mark - 延迟直方图
+
+@implementation RTCVPLatencyHistogram {
+    atomic_ullong _buckets[kRTCVPHistogramBucketCount];
+    atomic_ullong _count;
+    atomic_ullong _sum;
+    atomic_ullong _max;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        for (NSUInteger i = 0; i < kRTCVPHistogramBucketCount; i++) {
+            atomic_init(&_buckets[i], 0);
+        }
+        atomic_init(&_count, 0);
+        atomic_init(&_sum, 0);
+        atomic_init(&_max, 0);
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    // 各计数器分别读取，并发记录时快照内可能相差一两个值
+    RTCVPLatencyHistogram *copy = [[[self class] allocWithZone:zone] init];
+    for (NSUInteger i = 0; i < kRTCVPHistogramBucketCount; i++) {
+        atomic_store_explicit(&copy->_buckets[i], atomic_load_explicit(&_buckets[i], memory_order_relaxed), memory_order_relaxed);
+    }
+    atomic_store_explicit(&copy->_count, atomic_load_explicit(&_count, memory_order_relaxed), memory_order_relaxed);
+    atomic_store_explicit(&copy->_sum, atomic_load_explicit(&_sum, memory_order_relaxed), memory_order_relaxed);
+    atomic_store_explicit(&copy->_max, atomic_load_explicit(&_max, memory_order_relaxed), memory_order_relaxed);
+    return copy;
+}
+
+- (void)recordValue:(uint64_t)microseconds {
+    uint64_t value = MIN(microseconds, kRTCVPHistogramMaxValue);
+    atomic_fetch_add_explicit(&_buckets[RTCVPHistogramBucketIndex(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_sum, value, memory_order_relaxed);
+
+    unsigned long long current = atomic_load_explicit(&_max, memory_order_relaxed);
+    while (value > current &&
+           !atomic_compare_exchange_weak_explicit(&_max, &current, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+- (uint64_t)count {
+    return atomic_load_explicit(&_count, memory_order_relaxed);
+}
+
+- (uint64_t)maxValue {
+    return atomic_load_explicit(&_max, memory_order_relaxed);
+}
+
+- (double)mean {
+    uint64_t count = self.count;
+    return count > 0 ? (double)atomic_load_explicit(&_sum, memory_order_relaxed) / count : 0;
+}
+
+- (uint64_t)valueAtPercentile:(double)percentile {
+    uint64_t total = 0;
+    for (NSUInteger i = 0; i < kRTCVPHistogramBucketCount; i++) {
+        total += atomic_load_explicit(&_buckets[i], memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    double clamped = MIN(MAX(percentile, 0.0), 100.0);
+    uint64_t target = MAX((uint64_t)ceil(total * clamped / 100.0), 1);
+    uint64_t seen = 0;
+    for (NSUInteger i = 0; i < kRTCVPHistogramBucketCount; i++) {
+        seen += atomic_load_explicit(&_buckets[i], memory_order_relaxed);
+        if (seen >= target) {
+            return MIN(RTCVPHistogramBucketUpperBound(i), self.maxValue);
+        }
+    }
+    return self.maxValue;
+}
+
+@end
+
+#pragma mark - 计数器
+
+@interface RTCVPSocketMetrics ()
+@property (nonatomic, assign) NSTimeInterval createdAt;
+@end
+
+@implementation RTCVPSocketMetrics {
+    atomic_ullong _counters[RTCVPMetricCounterCount];
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        for (NSInteger i = 0; i < RTCVPMetricCounterCount; i++) {
+            atomic_init(&_counters[i], 0);
+        }
+        _ackLatency = [[RTCVPLatencyHistogram alloc] init];
+        _createdAt = RTCVPMonotonicSeconds();
+    }
+    return self;
+}
+
+- (void)addValue:(uint64_t)value toCounter:(RTCVPMetricCounter)counter {
+    if (counter < 0 || counter >= RTCVPMetricCounterCount) {
+        return;
+    }
+    atomic_fetch_add_explicit(&_counters[counter], value, memory_order_relaxed);
+}
+
+- (uint64_t)valueForCounter:(RTCVPMetricCounter)counter {
+    if (counter < 0 || counter >= RTCVPMetricCounterCount) {
+        return 0;
+    }
+    return atomic_load_explicit(&_counters[counter], memory_order_relaxed);
+}
+
+@end
+
+#pragma mark - 快照
+
+@implementation RTCVPSocketMetricsSnapshot {
+    uint64_t _counters[RTCVPMetricCounterCount];
+    NSUInteger _gauges[RTCVPMetricGaugeCount];
+}
+
+- (instancetype)initWithMetrics:(NSArray<RTCVPSocketMetrics *> *)metrics
+                         gauges:(const NSUInteger *)gauges
+                       previous:(nullable RTCVPSocketMetricsSnapshot *)previous {
+    self = [super init];
+    if (self) {
+        _timestamp = RTCVPMonotonicSeconds();
+
+        NSTimeInterval since = previous ? previous.timestamp : _timestamp;
+        RTCVPLatencyHistogram *ackLatency = nil;
+        for (RTCVPSocketMetrics *group in metrics) {
+            for (NSInteger i = 0; i < RTCVPMetricCounterCount; i++) {
+                _counters[i] += [group valueForCounter:i];
+            }
+            if (!previous) {
+                since = MIN(since, group.createdAt);
+            }
+            // 只有客户端记录 ACK 延迟，取第一个有数据的
+            if (!ackLatency && group.ackLatency.count > 0) {
+                ackLatency = [group.ackLatency copy];
+            }
+        }
+        _ackLatency = ackLatency ?: [[RTCVPLatencyHistogram alloc] init];
+
+        if (gauges) {
+            memcpy(_gauges, gauges, sizeof(_gauges));
+        }
+
+        NSTimeInterval elapsed = _timestamp - since;
+        if (elapsed > 0) {
+            uint64_t previousEmits = [previous valueForCounter:RTCVPMetricEmits];
+            uint64_t previousEvents = [previous valueForCounter:RTCVPMetricEvents];
+            _emitsPerSecond = (double)(_counters[RTCVPMetricEmits] - MIN(previousEmits, _counters[RTCVPMetricEmits])) / elapsed;
+            _eventsPerSecond = (double)(_counters[RTCVPMetricEvents] - MIN(previousEvents, _counters[RTCVPMetricEvents])) / elapsed;
+        }
+    }
+    return self;
+}
+
+- (uint64_t)valueForCounter:(RTCVPMetricCounter)counter {
+    if (counter < 0 || counter >= RTCVPMetricCounterCount) {
+        return 0;
+    }
+    return _counters[counter];
+}
+
+- (NSUInteger)valueForGauge:(RTCVPMetricGauge)gauge {
+    if (gauge < 0 || gauge >= RTCVPMetricGaugeCount) {
+        return 0;
+    }
+    return _gauges[gauge];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)dictionaryRepresentation {
+    NSMutableDictionary<NSString *, NSNumber *> *dictionary = [NSMutableDictionary dictionary];
+    for (NSInteger i = 0; i < RTCVPMetricCounterCount; i++) {
+        dictionary[RTCVPMetricCounterName(i)] = @(_counters[i]);
+    }
+    for (NSInteger i = 0; i < RTCVPMetricGaugeCount; i++) {
+        dictionary[RTCVPMetricGaugeName(i)] = @(_gauges[i]);
+    }
+    dictionary[@"emitsPerSecond"] = @(self.emitsPerSecond);
+    dictionary[@"eventsPerSecond"] = @(self.eventsPerSecond);
+    dictionary[@"ackLatencyCount"] = @(self.ackLatency.count);
+    dictionary[@"ackLatencyMean"] = @(self.ackLatency.mean);
+    dictionary[@"ackLatencyP50"] = @([self.ackLatency valueAtPercentile:50]);
+    dictionary[@"ackLatencyP90"] = @([self.ackLatency valueAtPercentile:90]);
+    dictionary[@"ackLatencyP99"] = @([self.ackLatency valueAtPercentile:99]);
+    dictionary[@"ackLatencyMax"] = @(self.ackLatency.maxValue);
+    return dictionary;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<RTCVPSocketMetricsSnapshot %@>", [self dictionaryRepresentation]];
+}
+
+@end
@@ -0,0 +1,27 @@
+//
+//  RTCVPSocketMsgPackParser.h
+//  RTCVPSocketIO
+//
+//  与 socket.io-msgpack-parser 兼容的 MessagePack 格式：
+//  每个包是一个 {type, nsp, data, id} map，编码为一个二进制帧，
+//  NSData 直接写成 msgpack bin，不再拆分附件。
+//
+
+#import <Foundation/Foundation.h>
+#import "RTCVPSocketParser.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface RTCVPSocketMsgPackParser : NSObject <RTCVPSocketParser>
+
++ (instancetype)parser;
+
+/// MessagePack 编码单个对象（NSString/NSNumber/NSData/NSArray/NSDictionary/NSDate/NSNull）
++ (NSData *)encodeObject:(nullable id)object;
+
+/// MessagePack 解码单个对象，数据不完整或有多余字节时返回 nil
++ (nullable id)decodeObject:(NSData *)data error:(NSError * _Nullable * _Nullable)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,549 @@
+//
+//  RTCVPSocketMsgPackParser.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPSocketMsgPackParser.h"
+#import "RTCVPSocketPacket.h"
+#import "RTCDefaultSocketLogger.h"
+
+static NSString * const RTCVPSocketParserErrorDomain = @"RTCVPSocketParser";
+
+// 嵌套深度上限，防止恶意数据导致栈溢出
+static const NSUInteger RTCVPMsgPackMaxDepth = 512;
+
+#pragma mark - 编码
+
+static void RTCVPMsgPackWriteHeader(NSMutableData *buffer, uint8_t marker, uint64_t value, int size) {
+    uint8_t bytes[9];
+    bytes[0] = marker;
+    for (int i = 0; i < size; i++) {
+        bytes[1 + i] = (uint8_t)(value >> (8 * (size - 1 - i)));
+    }
+    [buffer appendBytes:bytes length:1 + size];
+}
+
+static void RTCVPMsgPackWriteByte(NSMutableData *buffer, uint8_t byte) {
+    [buffer appendBytes:&byte length:1];
+}
+
+static void RTCVPMsgPackWriteUnsigned(NSMutableData *buffer, uint64_t value) {
+    if (value <= 0x7f) {
+        RTCVPMsgPackWriteByte(buffer, (uint8_t)value);
+    } else if (value <= UINT8_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xcc, value, 1);
+    } else if (value <= UINT16_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xcd, value, 2);
+    } else if (value <= UINT32_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xce, value, 4);
+    } else {
+        RTCVPMsgPackWriteHeader(buffer, 0xcf, value, 8);
+    }
+}
+
+static void RTCVPMsgPackWriteInteger(NSMutableData *buffer, int64_t value) {
+    if (value >= 0) {
+        RTCVPMsgPackWriteUnsigned(buffer, (uint64_t)value);
+    } else if (value >= -32) {
+        RTCVPMsgPackWriteByte(buffer, (uint8_t)(int8_t)value);
+    } else if (value >= INT8_MIN) {
+        RTCVPMsgPackWriteHeader(buffer, 0xd0, (uint8_t)(int8_t)value, 1);
+    } else if (value >= INT16_MIN) {
+        RTCVPMsgPackWriteHeader(buffer, 0xd1, (uint16_t)(int16_t)value, 2);
+    } else if (value >= INT32_MIN) {
+        RTCVPMsgPackWriteHeader(buffer, 0xd2, (uint32_t)(int32_t)value, 4);
+    } else {
+        RTCVPMsgPackWriteHeader(buffer, 0xd3, (uint64_t)value, 8);
+    }
+}
+
+static void RTCVPMsgPackWriteDouble(NSMutableData *buffer, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    RTCVPMsgPackWriteHeader(buffer, 0xcb, bits, 8);
+}
+
+static void RTCVPMsgPackWriteString(NSMutableData *buffer, NSString *string) {
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    if (length < 32) {
+        RTCVPMsgPackWriteByte(buffer, (uint8_t)(0xa0 | length));
+    } else if (length <= UINT8_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xd9, length, 1);
+    } else if (length <= UINT16_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xda, length, 2);
+    } else {
+        RTCVPMsgPackWriteHeader(buffer, 0xdb, length, 4);
+    }
+    [buffer appendBytes:string.UTF8String length:length];
+}
+
+static void RTCVPMsgPackWriteBinary(NSMutableData *buffer, NSData *data) {
+    NSUInteger length = data.length;
+    if (length <= UINT8_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xc4, length, 1);
+    } else if (length <= UINT16_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xc5, length, 2);
+    } else {
+        RTCVPMsgPackWriteHeader(buffer, 0xc6, length, 4);
+    }
+    [buffer appendData:data];
+}
+
+static void RTCVPMsgPackWriteArrayHeader(NSMutableData *buffer, NSUInteger count) {
+    if (count < 16) {
+        RTCVPMsgPackWriteByte(buffer, (uint8_t)(0x90 | count));
+    } else if (count <= UINT16_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xdc, count, 2);
+    } else {
+        RTCVPMsgPackWriteHeader(buffer, 0xdd, count, 4);
+    }
+}
+
+static void RTCVPMsgPackWriteMapHeader(NSMutableData *buffer, NSUInteger count) {
+    if (count < 16) {
+        RTCVPMsgPackWriteByte(buffer, (uint8_t)(0x80 | count));
+    } else if (count <= UINT16_MAX) {
+        RTCVPMsgPackWriteHeader(buffer, 0xde, count, 2);
+    } else {
+        RTCVPMsgPackWriteHeader(buffer, 0xdf, count, 4);
+    }
+}
+
+/// 日期写成 MessagePack 标准 timestamp 扩展（type -1），和 notepack.io 一致
+static void RTCVPMsgPackWriteDate(NSMutableData *buffer, NSDate *date) {
+    NSTimeInterval interval = date.timeIntervalSince1970;
+    int64_t seconds = (int64_t)floor(interval);
+    uint32_t nanoseconds = (uint32_t)llround((interval - (double)seconds) * 1e9);
+    if (nanoseconds >= 1000000000) {
+        seconds += 1;
+        nanoseconds -= 1000000000;
+    }
+
+    if (seconds >= 0 && seconds <= 0x3ffffffffLL) {
+        if (nanoseconds == 0 && seconds <= UINT32_MAX) {
+            const uint8_t bytes[6] = {0xd6, 0xff,
+                (uint8_t)(seconds >> 24), (uint8_t)(seconds >> 16), (uint8_t)(seconds >> 8), (uint8_t)seconds};
+            [buffer appendBytes:bytes length:6];
+        } else {
+            uint64_t value = ((uint64_t)nanoseconds << 34) | (uint64_t)seconds;
+            uint8_t bytes[10] = {0xd7, 0xff};
+            for (int i = 0; i < 8; i++) {
+                bytes[2 + i] = (uint8_t)(value >> (8 * (7 - i)));
+            }
+            [buffer appendBytes:bytes length:10];
+        }
+    } else {
+        const uint8_t header[3] = {0xc7, 12, 0xff};
+        [buffer appendBytes:header length:3];
+        uint8_t bytes[12];
+        for (int i = 0; i < 4; i++) {
+            bytes[i] = (uint8_t)(nanoseconds >> (8 * (3 - i)));
+        }
+        for (int i = 0; i < 8; i++) {
+            bytes[4 + i] = (uint8_t)((uint64_t)seconds >> (8 * (7 - i)));
+        }
+        [buffer appendBytes:bytes length:12];
+    }
+}
+
+static void RTCVPMsgPackWriteNumber(NSMutableData *buffer, NSNumber *number) {
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        RTCVPMsgPackWriteByte(buffer, number.boolValue ? 0xc3 : 0xc2);
+        return;
+    }
+
+    switch (number.objCType[0]) {
+        case 'f':
+        case 'd':
+            RTCVPMsgPackWriteDouble(buffer, number.doubleValue);
+            break;
+        case 'Q':
+            RTCVPMsgPackWriteUnsigned(buffer, number.unsignedLongLongValue);
+            break;
+        default:
+            RTCVPMsgPackWriteInteger(buffer, number.longLongValue);
+            break;
+    }
+}
+
+/// binary 不为空时，{"_placeholder":true,"num":n} 直接写成 binary[n]
+static void RTCVPMsgPackWriteObject(NSMutableData *buffer, id object, NSArray<NSData *> *binary) {
+    if (!object || object == [NSNull null]) {
+        RTCVPMsgPackWriteByte(buffer, 0xc0);
+    } else if ([object isKindOfClass:[NSString class]]) {
+        RTCVPMsgPackWriteString(buffer, object);
+    } else if ([object isKindOfClass:[NSNumber class]]) {
+        RTCVPMsgPackWriteNumber(buffer, object);
+    } else if ([object isKindOfClass:[NSData class]]) {
+        RTCVPMsgPackWriteBinary(buffer, object);
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        NSArray *array = object;
+        RTCVPMsgPackWriteArrayHeader(buffer, array.count);
+        for (id item in array) {
+            RTCVPMsgPackWriteObject(buffer, item, binary);
+        }
+    } else if ([object isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dict = object;
+        if (binary.count > 0) {
+            NSNumber *placeholder = dict[@"_placeholder"];
+            NSNumber *num = dict[@"num"];
+            if ([placeholder isKindOfClass:[NSNumber class]] && placeholder.boolValue &&
+                [num isKindOfClass:[NSNumber class]] && num.integerValue >= 0 && num.integerValue < (NSInteger)binary.count) {
+                RTCVPMsgPackWriteBinary(buffer, binary[num.integerValue]);
+                return;
+            }
+        }
+        RTCVPMsgPackWriteMapHeader(buffer, dict.count);
+        [dict enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            RTCVPMsgPackWriteObject(buffer, key, binary);
+            RTCVPMsgPackWriteObject(buffer, value, binary);
+        }];
+    } else if ([object isKindOfClass:[NSDate class]]) {
+        RTCVPMsgPackWriteDate(buffer, object);
+    } else {
+        [RTCDefaultSocketLogger.logger error:[NSString stringWithFormat:@"MessagePack 不支持的类型: %@", NSStringFromClass([object class])]
+                                        type:@"SocketParser"];
+        RTCVPMsgPackWriteByte(buffer, 0xc0);
+    }
+}
+
+#pragma mark - 解码
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger cursor;
+} RTCVPMsgPackReader;
+
+static BOOL RTCVPMsgPackReadBytes(RTCVPMsgPackReader *reader, NSUInteger count, const uint8_t **out) {
+    if (reader->length - reader->cursor < count) {
+        return NO;
+    }
+    *out = reader->bytes + reader->cursor;
+    reader->cursor += count;
+    return YES;
+}
+
+static BOOL RTCVPMsgPackReadUnsigned(RTCVPMsgPackReader *reader, int size, uint64_t *out) {
+    const uint8_t *bytes;
+    if (!RTCVPMsgPackReadBytes(reader, (NSUInteger)size, &bytes)) {
+        return NO;
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++) {
+        value = (value << 8) | bytes[i];
+    }
+    *out = value;
+    return YES;
+}
+
+static id RTCVPMsgPackReadObject(RTCVPMsgPackReader *reader, NSUInteger depth);
+
+static id RTCVPMsgPackReadString(RTCVPMsgPackReader *reader, uint64_t length) {
+    const uint8_t *bytes;
+    if (!RTCVPMsgPackReadBytes(reader, (NSUInteger)length, &bytes)) {
+        return nil;
+    }
+    return [[NSString alloc] initWithBytes:bytes length:(NSUInteger)length encoding:NSUTF8StringEncoding];
+}
+
+static id RTCVPMsgPackReadBinary(RTCVPMsgPackReader *reader, uint64_t length) {
+    const uint8_t *bytes;
+    if (!RTCVPMsgPackReadBytes(reader, (NSUInteger)length, &bytes)) {
+        return nil;
+    }
+    return [NSData dataWithBytes:bytes length:(NSUInteger)length];
+}
+
+static id RTCVPMsgPackReadArray(RTCVPMsgPackReader *reader, uint64_t count, NSUInteger depth) {
+    // 每个元素至少 1 字节，数量超过剩余长度的一定是坏数据
+    if (count > reader->length - reader->cursor) {
+        return nil;
+    }
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:(NSUInteger)count];
+    for (uint64_t i = 0; i < count; i++) {
+        id item = RTCVPMsgPackReadObject(reader, depth + 1);
+        if (!item) {
+            return nil;
+        }
+        [array addObject:item];
+    }
+    return array;
+}
+
+static id RTCVPMsgPackReadMap(RTCVPMsgPackReader *reader, uint64_t count, NSUInteger depth) {
+    if (count > (reader->length - reader->cursor) / 2) {
+        return nil;
+    }
+    NSMutableDictionary *dict = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)count];
+    for (uint64_t i = 0; i < count; i++) {
+        id key = RTCVPMsgPackReadObject(reader, depth + 1);
+        id value = key ? RTCVPMsgPackReadObject(reader, depth + 1) : nil;
+        if (!value || ![key conformsToProtocol:@protocol(NSCopying)]) {
+            return nil;
+        }
+        dict[key] = value;
+    }
+    return dict;
+}
+
+/// type -1 为标准 timestamp；type 0 是 notepack 的 undefined（1 字节）和旧版毫秒日期（float64）
+static id RTCVPMsgPackReadExtension(RTCVPMsgPackReader *reader, uint64_t length) {
+    const uint8_t *header;
+    if (!RTCVPMsgPackReadBytes(reader, 1, &header)) {
+        return nil;
+    }
+    int8_t extType = (int8_t)header[0];
+    NSUInteger start = reader->cursor;
+    const uint8_t *payload;
+    if (!RTCVPMsgPackReadBytes(reader, (NSUInteger)length, &payload)) {
+        return nil;
+    }
+
+    RTCVPMsgPackReader sub = { payload, (NSUInteger)length, 0 };
+    if (extType == -1) {
+        uint64_t seconds = 0, nanoseconds = 0;
+        if (length == 4) {
+            RTCVPMsgPackReadUnsigned(&sub, 4, &seconds);
+        } else if (length == 8) {
+            uint64_t value = 0;
+            RTCVPMsgPackReadUnsigned(&sub, 8, &value);
+            nanoseconds = value >> 34;
+            seconds = value & 0x3ffffffffULL;
+        } else if (length == 12) {
+            RTCVPMsgPackReadUnsigned(&sub, 4, &nanoseconds);
+            RTCVPMsgPackReadUnsigned(&sub, 8, &seconds);
+            return [NSDate dateWithTimeIntervalSince1970:(double)(int64_t)seconds + (double)nanoseconds / 1e9];
+        } else {
+            return nil;
+        }
+        return [NSDate dateWithTimeIntervalSince1970:(double)seconds + (double)nanoseconds / 1e9];
+    }
+    if (extType == 0 && length == 1) {
+        return [NSNull null];
+    }
+    if (extType == 0 && length == 8) {
+        uint64_t bits = 0;
+        RTCVPMsgPackReadUnsigned(&sub, 8, &bits);
+        double milliseconds;
+        memcpy(&milliseconds, &bits, sizeof(milliseconds));
+        return [NSDate dateWithTimeIntervalSince1970:milliseconds / 1000.0];
+    }
+    return [NSData dataWithBytes:reader->bytes + start length:(NSUInteger)length];
+}
+
+static id RTCVPMsgPackReadObject(RTCVPMsgPackReader *reader, NSUInteger depth) {
+    if (depth > RTCVPMsgPackMaxDepth) {
+        return nil;
+    }
+    const uint8_t *markerByte;
+    if (!RTCVPMsgPackReadBytes(reader, 1, &markerByte)) {
+        return nil;
+    }
+    uint8_t marker = *markerByte;
+    uint64_t value = 0;
+
+    if (marker <= 0x7f) {
+        return @(marker);
+    } else if (marker >= 0xe0) {
+        return @((int8_t)marker);
+    } else if ((marker & 0xe0) == 0xa0) {
+        return RTCVPMsgPackReadString(reader, marker & 0x1f);
+    } else if ((marker & 0xf0) == 0x90) {
+        return RTCVPMsgPackReadArray(reader, marker & 0x0f, depth);
+    } else if ((marker & 0xf0) == 0x80) {
+        return RTCVPMsgPackReadMap(reader, marker & 0x0f, depth);
+    }
+
+    switch (marker) {
+        case 0xc0: return [NSNull null];
+        case 0xc2: return @NO;
+        case 0xc3: return @YES;
+
+        case 0xc4: return RTCVPMsgPackReadUnsigned(reader, 1, &value) ? RTCVPMsgPackReadBinary(reader, value) : nil;
+        case 0xc5: return RTCVPMsgPackReadUnsigned(reader, 2, &value) ? RTCVPMsgPackReadBinary(reader, value) : nil;
+        case 0xc6: return RTCVPMsgPackReadUnsigned(reader, 4, &value) ? RTCVPMsgPackReadBinary(reader, value) : nil;
+
+        case 0xc7: return RTCVPMsgPackReadUnsigned(reader, 1, &value) ? RTCVPMsgPackReadExtension(reader, value) : nil;
+        case 0xc8: return RTCVPMsgPackReadUnsigned(reader, 2, &value) ? RTCVPMsgPackReadExtension(reader, value) : nil;
+        case 0xc9: return RTCVPMsgPackReadUnsigned(reader, 4, &value) ? RTCVPMsgPackReadExtension(reader, value) : nil;
+        case 0xd4: return RTCVPMsgPackReadExtension(reader, 1);
+        case 0xd5: return RTCVPMsgPackReadExtension(reader, 2);
+        case 0xd6: return RTCVPMsgPackReadExtension(reader, 4);
+        case 0xd7: return RTCVPMsgPackReadExtension(reader, 8);
+        case 0xd8: return RTCVPMsgPackReadExtension(reader, 16);
+
+        case 0xca: {
+            if (!RTCVPMsgPackReadUnsigned(reader, 4, &value)) return nil;
+            uint32_t bits = (uint32_t)value;
+            float result;
+            memcpy(&result, &bits, sizeof(result));
+            return @(result);
+        }
+        case 0xcb: {
+            if (!RTCVPMsgPackReadUnsigned(reader, 8, &value)) return nil;
+            double result;
+            memcpy(&result, &value, sizeof(result));
+            return @(result);
+        }
+
+        case 0xcc: return RTCVPMsgPackReadUnsigned(reader, 1, &value) ? @(value) : nil;
+        case 0xcd: return RTCVPMsgPackReadUnsigned(reader, 2, &value) ? @(value) : nil;
+        case 0xce: return RTCVPMsgPackReadUnsigned(reader, 4, &value) ? @(value) : nil;
+        case 0xcf: return RTCVPMsgPackReadUnsigned(reader, 8, &value) ? @(value) : nil;
+        case 0xd0: return RTCVPMsgPackReadUnsigned(reader, 1, &value) ? @((int8_t)value) : nil;
+        case 0xd1: return RTCVPMsgPackReadUnsigned(reader, 2, &value) ? @((int16_t)value) : nil;
+        case 0xd2: return RTCVPMsgPackReadUnsigned(reader, 4, &value) ? @((int32_t)value) : nil;
+        case 0xd3: return RTCVPMsgPackReadUnsigned(reader, 8, &value) ? @((int64_t)value) : nil;
+
+        case 0xd9: return RTCVPMsgPackReadUnsigned(reader, 1, &value) ? RTCVPMsgPackReadString(reader, value) : nil;
+        case 0xda: return RTCVPMsgPackReadUnsigned(reader, 2, &value) ? RTCVPMsgPackReadString(reader, value) : nil;
+        case 0xdb: return RTCVPMsgPackReadUnsigned(reader, 4, &value) ? RTCVPMsgPackReadString(reader, value) : nil;
+
+        case 0xdc: return RTCVPMsgPackReadUnsigned(reader, 2, &value) ? RTCVPMsgPackReadArray(reader, value, depth) : nil;
+        case 0xdd: return RTCVPMsgPackReadUnsigned(reader, 4, &value) ? RTCVPMsgPackReadArray(reader, value, depth) : nil;
+        case 0xde: return RTCVPMsgPackReadUnsigned(reader, 2, &value) ? RTCVPMsgPackReadMap(reader, value, depth) : nil;
+        case 0xdf: return RTCVPMsgPackReadUnsigned(reader, 4, &value) ? RTCVPMsgPackReadMap(reader, value, depth) : nil;
+
+        default:
+            // 0xc1 保留未使用
+            return nil;
+    }
+}
+
+#pragma mark - RTCVPSocketMsgPackParser
+
+@implementation RTCVPSocketMsgPackParser
+
++ (instancetype)parser {
+    static RTCVPSocketMsgPackParser *sharedParser;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedParser = [[self alloc] init];
+    });
+    return sharedParser;
+}
+
++ (NSData *)encodeObject:(id)object {
+    NSMutableData *buffer = [NSMutableData dataWithCapacity:64];
+    RTCVPMsgPackWriteObject(buffer, object, nil);
+    return buffer;
+}
+
++ (id)decodeObject:(NSData *)data error:(NSError **)error {
+    RTCVPMsgPackReader reader = { (const uint8_t *)data.bytes, data.length, 0 };
+    id object = RTCVPMsgPackReadObject(&reader, 0);
+    if (!object || reader.cursor != reader.length) {
+        if (error) {
+            *error = [NSError errorWithDomain:RTCVPSocketParserErrorDomain
+                                         code:-2
+                                     userInfo:@{NSLocalizedDescriptionKey: @"Invalid MessagePack data"}];
+        }
+        return nil;
+    }
+    return object;
+}
+
+- (BOOL)encodesToBinary {
+    return YES;
+}
+
+- (void)encodePacket:(RTCVPSocketPacket *)packet intoBuffer:(NSMutableData *)buffer {
+    // MessagePack 自带二进制类型，不再区分 BINARY_EVENT / BINARY_ACK
+    RTCVPPacketType type = packet.type;
+    if (type == RTCVPPacketTypeBinaryEvent) {
+        type = RTCVPPacketTypeEvent;
+    } else if (type == RTCVPPacketTypeBinaryAck) {
+        type = RTCVPPacketTypeAck;
+    }
+
+    NSArray *data = packet.data;
+    BOOL hasData = data.count > 0 || type == RTCVPPacketTypeEvent || type == RTCVPPacketTypeAck;
+    BOOL hasId = packet.packetId >= 0;
+
+    RTCVPMsgPackWriteMapHeader(buffer, 2 + (hasData ? 1 : 0) + (hasId ? 1 : 0));
+    RTCVPMsgPackWriteString(buffer, @"type");
+    RTCVPMsgPackWriteUnsigned(buffer, type);
+    RTCVPMsgPackWriteString(buffer, @"nsp");
+    RTCVPMsgPackWriteString(buffer, packet.nsp ?: @"/");
+    if (hasData) {
+        // 占位符按 packet.binary 原地还原为 bin，不重建参数树
+        RTCVPMsgPackWriteString(buffer, @"data");
+        // connect 的负载是单个对象（如 {pid, offset}），不是参数数组
+        id payload = (type == RTCVPPacketTypeConnect && data.count == 1) ? data.firstObject : data;
+        RTCVPMsgPackWriteObject(buffer, payload ?: @[], packet.binary);
+    }
+    if (hasId) {
+        RTCVPMsgPackWriteString(buffer, @"id");
+        RTCVPMsgPackWriteInteger(buffer, packet.packetId);
+    }
+}
+
+- (RTCVPSocketPacket *)decodeString:(NSString *)message
+                     deferArguments:(BOOL)deferArguments
+                              error:(NSError **)error {
+    if (error) {
+        *error = [NSError errorWithDomain:RTCVPSocketParserErrorDomain
+                                     code:-1
+                                 userInfo:@{NSLocalizedDescriptionKey: @"MessagePack parser expects binary frames"}];
+    }
+    return nil;
+}
+
+- (RTCVPSocketPacket *)decodeData:(NSData *)data error:(NSError **)error {
+    id object = [[self class] decodeObject:data error:error];
+    if (!object) {
+        return nil;
+    }
+
+    NSDictionary *dict = [object isKindOfClass:[NSDictionary class]] ? object : nil;
+    NSNumber *typeNumber = dict[@"type"];
+    if (![typeNumber isKindOfClass:[NSNumber class]] ||
+        typeNumber.integerValue < RTCVPPacketTypeConnect ||
+        typeNumber.integerValue > RTCVPPacketTypeBinaryAck) {
+        if (error) {
+            *error = [NSError errorWithDomain:RTCVPSocketParserErrorDomain
+                                         code:-3
+                                     userInfo:@{NSLocalizedDescriptionKey: @"Invalid packet type"}];
+        }
+        return nil;
+    }
+
+    RTCVPPacketType type = (RTCVPPacketType)typeNumber.integerValue;
+    if (type == RTCVPPacketTypeBinaryEvent) {
+        type = RTCVPPacketTypeEvent;
+    } else if (type == RTCVPPacketTypeBinaryAck) {
+        type = RTCVPPacketTypeAck;
+    }
+
+    NSString *nsp = [dict[@"nsp"] isKindOfClass:[NSString class]] ? dict[@"nsp"] : @"/";
+    NSNumber *packetIdNumber = dict[@"id"];
+    NSInteger packetId = [packetIdNumber isKindOfClass:[NSNumber class]] ? packetIdNumber.integerValue : -1;
+
+    // 与文本格式一致：对象负载包成单元素数组
+    id payload = dict[@"data"];
+    NSArray *items = @[];
+    if ([payload isKindOfClass:[NSArray class]]) {
+        items = payload;
+    } else if (payload && payload != [NSNull null]) {
+        items = @[payload];
+    }
+
+    if (type == RTCVPPacketTypeEvent && ![items.firstObject isKindOfClass:[NSString class]]) {
+        if (error) {
+            *error = [NSError errorWithDomain:RTCVPSocketParserErrorDomain
+                                         code:-3
+                                     userInfo:@{NSLocalizedDescriptionKey: @"Event packet without event name"}];
+        }
+        return nil;
+    }
+
+    return [[RTCVPSocketPacket alloc] initWithType:type
+                                              data:items
+                                          packetId:packetId
+                                               nsp:nsp
+                                      placeholders:0
+                                            binary:@[]];
+}
+
+@end
@@ -0,0 +1,35 @@
+//
+//  RTCVPSocketParser.h
+//  RTCVPSocketIO
+//
+//  Socket.IO 包的编解码协议，由 RTCVPSocketIOConfig.parser 选择
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class RTCVPSocketPacket;
+
+@protocol RTCVPSocketParser <NSObject>
+
+/// YES：每个包编码成一个完整的二进制帧（没有附件帧、没有 base64）
+/// NO：文本帧 + packet.binary 附件帧（默认 JSON 格式）
+@property (nonatomic, assign, readonly) BOOL encodesToBinary;
+
+/// 将包编码后追加到 buffer；文本格式时调用方已写入 Engine.IO 前缀
+- (void)encodePacket:(RTCVPSocketPacket *)packet intoBuffer:(NSMutableData *)buffer;
+
+/// 解析文本帧中的 Socket.IO 包（不含 Engine.IO 前缀）
+/// deferArguments 只是提示，不支持延迟解析的格式可以忽略
+- (nullable RTCVPSocketPacket *)decodeString:(NSString *)message
+                              deferArguments:(BOOL)deferArguments
+                                       error:(NSError * _Nullable * _Nullable)error;
+
+/// 解析二进制帧中的完整 Socket.IO 包，只有 encodesToBinary 为 YES 的格式需要实现
+- (nullable RTCVPSocketPacket *)decodeData:(NSData *)data
+                                     error:(NSError * _Nullable * _Nullable)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,51 @@
+//
+//  RTCVPTimingWheel.h
+//  RTCVPSocketIO
+//
+//  哈希时间轮：定时项按到期 tick 落到 slotCount 个槽里，挂上和取消都是 O(1)。
+//  只用一个 GCD 定时源，按最近一个非空槽设定下一次唤醒，没有定时项时不唤醒。
+//  不加锁，所有方法都必须在初始化时传入的 queue 上调用，到期回调也在该 queue 上执行。
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 时间轮上的一个定时项，用于取消
+@interface RTCVPTimingWheelTimer : NSObject
+
+/// 是否还挂在时间轮上（未到期、未取消）
+@property (nonatomic, readonly, getter=isScheduled) BOOL scheduled;
+
+@end
+
+@interface RTCVPTimingWheel : NSObject
+
+/// 当前挂着的定时项数
+@property (nonatomic, readonly) NSUInteger count;
+
+/// tickInterval 为精度（秒），到期回调最多晚一个 tick；一圈覆盖 tickInterval × slotCount，更长的延迟跨圈
+- (instancetype)initWithQueue:(dispatch_queue_t)queue
+                 tickInterval:(NSTimeInterval)tickInterval
+                    slotCount:(NSUInteger)slotCount NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// delay 秒后在 queue 上执行 handler
+- (RTCVPTimingWheelTimer *)scheduleAfter:(NSTimeInterval)delay handler:(dispatch_block_t)handler;
+
+/// 取消定时项，已到期或已取消时什么都不做
+- (void)cancelTimer:(RTCVPTimingWheelTimer *)timer;
+
+/// 取消全部定时项
+- (void)cancelAll;
+
+/// 立即处理到当前时间为止已到期的定时项
+- (void)advance;
+
+/// 取消全部定时项并释放定时源，之后不能再使用
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
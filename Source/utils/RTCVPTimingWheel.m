@@ -0,0 +1,235 @@
+//
+//  RTCVPTimingWheel.m
+//  RTCVPSocketIO
+//
+
+#import "RTCVPTimingWheel.h"
+#import "RTCVPConnectionTimeline.h"
+
+@interface RTCVPTimingWheelTimer () {
+@public
+    uint64_t _deadlineTick;
+    NSUInteger _slot;
+    BOOL _scheduled;
+    dispatch_block_t _handler;
+    // 槽内双向链表：next 持有，prev 不持有
+    RTCVPTimingWheelTimer *_next;
+    __unsafe_unretained RTCVPTimingWheelTimer *_prev;
+}
+@end
+
+@implementation RTCVPTimingWheelTimer
+
+- (BOOL)isScheduled {
+    return _scheduled;
+}
+
+@end
+
+@implementation RTCVPTimingWheel {
+    dispatch_queue_t _queue;
+    uint64_t _tickNanos;
+    NSUInteger _slotCount;
+    RTCVPTimingWheelTimer * __strong *_slots;
+    uint64_t _origin;       // 单调时钟起点，tick 从这里开始计
+    uint64_t _currentTick;  // 已处理到的 tick
+    uint64_t _armedTick;    // 定时源下一次唤醒的 tick，UINT64_MAX 表示未设定
+    dispatch_source_t _source;
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue
+                 tickInterval:(NSTimeInterval)tickInterval
+                    slotCount:(NSUInteger)slotCount {
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _tickNanos = MAX((uint64_t)(tickInterval * NSEC_PER_SEC), NSEC_PER_MSEC);
+        _slotCount = MAX(slotCount, 1);
+        _slots = (RTCVPTimingWheelTimer * __strong *)calloc(_slotCount, sizeof(RTCVPTimingWheelTimer *));
+        _origin = RTCVPMonotonicNanoseconds();
+        _armedTick = UINT64_MAX;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self invalidate];
+    free(_slots);
+}
+
+#pragma mark - 定时项
+
+- (RTCVPTimingWheelTimer *)scheduleAfter:(NSTimeInterval)delay handler:(dispatch_block_t)handler {
+    RTCVPTimingWheelTimer *timer = [[RTCVPTimingWheelTimer alloc] init];
+    uint64_t delayNanos = delay > 0 ? (uint64_t)(delay * NSEC_PER_SEC) : 0;
+    uint64_t deadline = RTCVPMonotonicNanoseconds() - _origin + delayNanos;
+    // 向上取整到 tick，保证不会提前到期
+    uint64_t tick = (deadline + _tickNanos - 1) / _tickNanos;
+    timer->_deadlineTick = MAX(tick, _currentTick + 1);
+    timer->_handler = [handler copy];
+    [self insertTimer:timer];
+
+    if (timer->_deadlineTick < _armedTick) {
+        [self armAtTick:timer->_deadlineTick];
+    }
+    return timer;
+}
+
+- (void)cancelTimer:(RTCVPTimingWheelTimer *)timer {
+    if (!timer) {
+        return;
+    }
+    // 已摘下但还没回调的项（同一批到期）也不再回调
+    timer->_handler = nil;
+    if (!timer->_scheduled) {
+        return;
+    }
+    [self unlinkTimer:timer];
+    if (_count == 0) {
+        [self disarm];
+    }
+}
+
+- (void)cancelAll {
+    for (NSUInteger i = 0; i < _slotCount; i++) {
+        // 逐个断开，避免长链表释放时递归过深
+        RTCVPTimingWheelTimer *timer = _slots[i];
+        _slots[i] = nil;
+        while (timer) {
+            RTCVPTimingWheelTimer *next = timer->_next;
+            timer->_next = nil;
+            timer->_prev = nil;
+            timer->_scheduled = NO;
+            timer->_handler = nil;
+            timer = next;
+        }
+    }
+    _count = 0;
+    [self disarm];
+}
+
+- (void)advance {
+    uint64_t nowTick = (RTCVPMonotonicNanoseconds() - _origin) / _tickNanos;
+    _armedTick = UINT64_MAX;
+    if (nowTick <= _currentTick) {
+        [self rearm];
+        return;
+    }
+
+    NSMutableArray<RTCVPTimingWheelTimer *> *expired = nil;
+    if (_count > 0) {
+        // 落后超过一圈时每个槽只需要看一遍
+        uint64_t steps = MIN(nowTick - _currentTick, (uint64_t)_slotCount);
+        for (uint64_t i = 1; i <= steps; i++) {
+            RTCVPTimingWheelTimer *timer = _slots[(_currentTick + i) % _slotCount];
+            while (timer) {
+                RTCVPTimingWheelTimer *next = timer->_next;
+                if (timer->_deadlineTick <= nowTick) {
+                    if (!expired) {
+                        expired = [NSMutableArray array];
+                    }
+                    [expired addObject:timer];
+                    [self unlinkTimer:timer];
+                }
+                timer = next;
+            }
+        }
+    }
+    _currentTick = nowTick;
+
+    // 先全部摘下再回调，回调里可以安全地挂新的定时项或取消其他定时项
+    for (RTCVPTimingWheelTimer *timer in expired) {
+        dispatch_block_t handler = timer->_handler;
+        timer->_handler = nil;
+        if (handler) {
+            handler();
+        }
+    }
+    [self rearm];
+}
+
+- (void)invalidate {
+    [self cancelAll];
+    if (_source) {
+        dispatch_source_cancel(_source);
+        _source = nil;
+    }
+}
+
+#pragma mark - 槽链表
+
+- (void)insertTimer:(RTCVPTimingWheelTimer *)timer {
+    NSUInteger slot = (NSUInteger)(timer->_deadlineTick % _slotCount);
+    RTCVPTimingWheelTimer *head = _slots[slot];
+    timer->_slot = slot;
+    timer->_next = head;
+    timer->_prev = nil;
+    if (head) {
+        head->_prev = timer;
+    }
+    _slots[slot] = timer;
+    timer->_scheduled = YES;
+    _count++;
+}
+
+- (void)unlinkTimer:(RTCVPTimingWheelTimer *)timer {
+    RTCVPTimingWheelTimer *next = timer->_next;
+    if (timer->_prev) {
+        timer->_prev->_next = next;
+    } else {
+        _slots[timer->_slot] = next;
+    }
+    if (next) {
+        next->_prev = timer->_prev;
+    }
+    timer->_next = nil;
+    timer->_prev = nil;
+    timer->_scheduled = NO;
+    _count--;
+}
+
+#pragma mark - 定时源
+
+/// 按最近的非空槽设定下一次唤醒；槽里的项可能在后面几圈，届时没有到期项就继续往后设
+- (void)rearm {
+    if (_count == 0) {
+        [self disarm];
+        return;
+    }
+    uint64_t nextTick = _currentTick + _slotCount;
+    for (uint64_t i = 1; i <= _slotCount; i++) {
+        if (_slots[(_currentTick + i) % _slotCount]) {
+            nextTick = _currentTick + i;
+            break;
+        }
+    }
+    [self armAtTick:nextTick];
+}
+
+- (void)armAtTick:(uint64_t)tick {
+    if (!_source) {
+        _source = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(_source, ^{
+            [weakSelf advance];
+        });
+        dispatch_source_set_timer(_source, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_resume(_source);
+    }
+
+    _armedTick = tick;
+    uint64_t fireAt = _origin + tick * _tickNanos;
+    uint64_t now = RTCVPMonotonicNanoseconds();
+    int64_t delta = fireAt > now ? (int64_t)(fireAt - now) : 0;
+    dispatch_source_set_timer(_source, dispatch_time(DISPATCH_TIME_NOW, delta), DISPATCH_TIME_FOREVER, _tickNanos / 10);
+}
+
+/// 没有定时项时不再唤醒
+- (void)disarm {
+    _armedTick = UINT64_MAX;
+    if (_source) {
+        dispatch_source_set_timer(_source, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+    }
+}
+
+@end
@@ -25,9 +25,10 @@
     // 修复第一个字节（操作码和RSV位）
     uint8_t firstByte = fixedBytes[0];
     
-    // 1. 清除RSV位（0x70）
-    if ((firstByte & 0x70) != 0) {
-        firstByte &= 0x8F; // 保留FIN（0x80）和操作码（0x0F）
+    // 1. 清除RSV2/RSV3位（0x30）
+    // RSV1（0x40）是 permessage-deflate 的压缩标记，清掉后压缩负载会被当成明文，必须保留
+    if ((firstByte & 0x30) != 0) {
+        firstByte &= 0xCF; // 保留FIN（0x80）、RSV1（0x40）和操作码（0x0F）
         fixedBytes[0] = firstByte;
         
         [RTCDefaultSocketLogger.logger logMessage:@"清除WebSocket帧RSV位" type:@"WebSocketProtocolFixer" level:RTCLogLevelWarning];
@@ -115,14 +116,15 @@
     // 允许的操作码
     BOOL isValidOpcode = (opcode <= 0x2) || (opcode >= 0x8 && opcode <= 0xA);
     
-    // 检查RSV位（应全部为0）
-    BOOL hasRSV = (bytes[0] & 0x70) != 0;
-    
     // 对于控制帧，检查FIN位（应始终为1）
     BOOL isControlFrame = (opcode == 0x8 || opcode == 0x9 || opcode == 0xA);
     BOOL controlFrameValid = !isControlFrame || (bytes[0] & 0x80) != 0;
     
-    return isValidOpcode && !hasRSV && controlFrameValid;
+    // 检查RSV位：RSV2/RSV3 应为0；RSV1 是压缩标记，只能出现在文本/二进制消息的第一帧
+    BOOL hasRSV = (bytes[0] & 0x30) != 0;
+    BOOL rsv1Valid = (bytes[0] & 0x40) == 0 || opcode == 0x1 || opcode == 0x2;
+    
+    return isValidOpcode && !hasRSV && rsv1Valid && controlFrameValid;
 }
 
 @end
@@ -11,6 +11,148 @@
 // 导入SDK内部头文件
 #import "../Source/RTCVPSocketIO.h"
 #import "../Source/RTCVPSocketPacket.h"
+#import "../Source/utils/RTCVPSocketMsgPackParser.h"
+#import "../Source/utils/RTCVPPollingPayloadDecoder.h"
+#import "../Source/utils/RTCVPReconnectScheduler.h"
+#import "../Source/utils/RTCVPReconnectDriver.h"
+#import "../Source/utils/RTCVPTimingWheel.h"
+#import "../Source/utils/RTCVPPendingAckTable.h"
+#import "../Source/utils/RTCVPWebSocketProtocolFixer.h"
+#import "../Source/RTCVPACKManager.h"
+#import "../Source/RTCVPSocketEngine.h"
+#import "../jetfire/RTCJFRWebSocket.h"
+
+// 测试用到的引擎内部方法
+@interface RTCVPSocketEngine (Testing)
+- (void)retainOutboundBytes:(NSUInteger)length;
+- (void)releaseOutboundBytes:(NSUInteger)length;
+- (void)websocket:(id)socket didUpdateBufferedAmount:(NSUInteger)bufferedAmount;
+- (void)sendPollEncodedMessage:(NSData *)message withData:(NSArray *)data;
+- (void)flushWaitingForPost;
+- (NSURLRequest *)createRequestForPostWithPostWait;
+- (NSURL *)urlPollingWithSid;
+- (void)handlePong:(NSString *)message;
+@end
+
+// 测试用到的 WebSocket 内部方法
+@interface RTCJFRWebSocket (Testing)
+- (id)nextWriteItem;
+- (void)writeError:(uint16_t)code;
+- (id)batchItemWithMessages:(NSArray<NSData *> *)messages binaryIndexes:(NSIndexSet *)binaryIndexes;
+- (NSData *)encodeBatchItem:(id)item;
+- (NSData *)encodeNextFrameOfItem:(id)item control:(BOOL)control;
+- (NSString *)compressionOffer;
+- (BOOL)negotiateExtensions:(NSString *)extensions;
+- (NSData *)deflateMessage:(NSData *)data;
+- (NSData *)inflateMessage:(NSMutableData *)payload;
+@end
+
+// 按客户端帧格式拆开缓冲区：header 为第一个字节（FIN/RSV1/opcode），payload 为去掉掩码后的数据；格式错误时返回 nil
+static NSArray<NSDictionary *> *RTCVPTestDecodeClientFrames(NSData *buffer) {
+    NSMutableArray<NSDictionary *> *frames = [NSMutableArray array];
+    const uint8_t *bytes = buffer.bytes;
+    NSUInteger offset = 0;
+    while (offset < buffer.length) {
+        if (buffer.length - offset < 2 || !(bytes[offset + 1] & 0x80)) {
+            return nil;
+        }
+        uint8_t header = bytes[offset];
+        uint64_t length = bytes[offset + 1] & 0x7F;
+        offset += 2;
+        NSUInteger extended = (length == 126) ? 2 : (length == 127 ? 8 : 0);
+        if (buffer.length - offset < extended + 4) {
+            return nil;
+        }
+        if (extended > 0) {
+            length = 0;
+            for (NSUInteger i = 0; i < extended; i++) {
+                length = (length << 8) | bytes[offset + i];
+            }
+            offset += extended;
+        }
+        const uint8_t *mask = bytes + offset;
+        offset += 4;
+        if (buffer.length - offset < length) {
+            return nil;
+        }
+        NSMutableData *payload = [NSMutableData dataWithLength:(NSUInteger)length];
+        uint8_t *out = payload.mutableBytes;
+        for (NSUInteger i = 0; i < length; i++) {
+            out[i] = bytes[offset + i] ^ mask[i % 4];
+        }
+        offset += (NSUInteger)length;
+        [frames addObject:@{@"header": @(header), @"payload": payload}];
+    }
+    return frames;
+}
+
+// 压缩测试用的消息：固定种子生成的小写字母，可压缩但不是简单重复
+static NSData *RTCVPTestCompressibleMessage(NSUInteger length) {
+    NSMutableData *message = [NSMutableData dataWithLength:length];
+    uint8_t *bytes = message.mutableBytes;
+    uint32_t seed = 0x1234;
+    for (NSUInteger i = 0; i < length; i++) {
+        seed = seed * 1103515245 + 12345;
+        bytes[i] = 'a' + ((seed >> 16) & 0x0F);
+    }
+    return message;
+}
+
+// 按服务端的应答协商好压缩的 WebSocket
+static RTCJFRWebSocket *RTCVPTestDeflateSocket(NSString *extensions) {
+    RTCJFRWebSocket *socket = [[RTCJFRWebSocket alloc] initWithURL:[NSURL URLWithString:@"ws://localhost:3000"] protocols:nil];
+    socket.compressionEnabled = YES;
+    [socket negotiateExtensions:extensions];
+    return socket;
+}
+
+// 记录引擎回调的客户端
+@interface RTCVPTestEngineClient : NSObject <RTCVPSocketEngineClient>
+@property (nonatomic, assign) NSInteger drainCount;
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *roundTrips;
+@end
+
+@implementation RTCVPTestEngineClient
+- (void)engineDidError:(NSString *)reason {}
+- (void)engineDidOpen:(NSString *)reason {}
+- (void)engineDidClose:(NSString *)reason {}
+- (void)parseEngineMessage:(NSString *)msg {}
+- (void)parseEngineBinaryData:(NSData *)data {}
+- (void)handleEngineAck:(NSInteger)ackId withData:(NSArray *)data {}
+- (void)engineDidDrain {
+    self.drainCount++;
+}
+- (void)engineDidMeasureRoundTrip:(NSTimeInterval)rtt {
+    if (!self.roundTrips) {
+        self.roundTrips = [NSMutableArray array];
+    }
+    [self.roundTrips addObject:@(rtt)];
+}
+@end
+
+// 记录重连回调；每次尝试都模拟连接失败
+@interface RTCVPTestReconnectDelegate : NSObject <RTCVPReconnectDriverDelegate>
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *attempts;
+@property (nonatomic, assign) NSInteger startCount;
+@property (nonatomic, strong) XCTestExpectation *failed;
+@end
+
+@implementation RTCVPTestReconnectDelegate
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver didStartWithReason:(NSString *)reason {
+    self.startCount++;
+}
+- (BOOL)reconnectDriverShouldAttempt:(RTCVPReconnectDriver *)driver {
+    return YES;
+}
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver attempt:(NSInteger)attempt {
+    [self.attempts addObject:@(attempt)];
+    [driver connectionDidClose:@"attempt failed"];
+}
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver didFailAfterAttempts:(NSInteger)attempts {
+    [self.failed fulfill];
+}
+- (void)reconnectDriver:(RTCVPReconnectDriver *)driver networkDidChange:(NSString *)reason linkChanged:(BOOL)linkChanged {}
+@end
 
 @interface VPSocketIOTests : XCTestCase
 
@@ -73,6 +215,68 @@
     XCTAssertEqualObjects(packet.nsp, @"/", @"连接命名空间错误");
 }
 
+- (void)testEncodeRecoveryConnectPacket {
+    // 测试连接状态恢复的 connect 包：负载是对象而不是参数数组，没有负载时只到命名空间为止
+    RTCVPSocketPacket *plain = [[RTCVPSocketPacket alloc] initWithType:RTCVPPacketTypeConnect data:@[] packetId:-1 nsp:@"/chat" placeholders:0 binary:@[]];
+    XCTAssertEqualObjects(plain.packetString, @"0/chat", @"无负载的 connect 包编码错误");
+
+    RTCVPSocketPacket *recovery = [[RTCVPSocketPacket alloc] initWithType:RTCVPPacketTypeConnect data:@[@{@"pid": @"p1"}] packetId:-1 nsp:@"/" placeholders:0 binary:@[]];
+    XCTAssertEqualObjects(recovery.packetString, @"0{\"pid\":\"p1\"}", @"恢复 connect 包编码错误");
+
+    RTCVPSocketPacket *reply = [RTCVPSocketPacket packetFromString:@"0/chat,{\"sid\":\"s1\",\"pid\":\"p1\"}"];
+    XCTAssertEqualObjects([reply.data.firstObject objectForKey:@"pid"], @"p1", @"CONNECT 响应中的 pid 解析错误");
+}
+
+- (void)testParseNamespacedBinaryAckFromData {
+    // 测试直接从UTF-8字节解析带命名空间、附件数和ACK ID的数据包
+    NSData *message = [@"61-/chat,12[{\"_placeholder\":true,\"num\":0}]" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSError *error = nil;
+    RTCVPSocketPacket *packet = [RTCVPSocketPacket packetFromData:message error:&error];
+
+    XCTAssertNotNil(packet, @"解析字节数据失败: %@", error);
+    XCTAssertEqual(packet.type, RTCVPPacketTypeBinaryAck, @"数据包类型错误");
+    XCTAssertEqualObjects(packet.nsp, @"/chat", @"命名空间错误");
+    XCTAssertEqual(packet.packetId, 12, @"ACK ID错误");
+    XCTAssertTrue([packet addBinaryData:[NSData data]], @"附件数错误");
+
+    XCTAssertNil([RTCVPSocketPacket packetFromString:@"9[]" error:&error], @"非法类型应解析失败");
+    XCTAssertEqual(error.code, -3, @"错误码错误");
+}
+
+- (void)testParseEventWithDeferredArguments {
+    // 测试延迟解析：先只得到事件名和ACK ID，访问args时再解析参数；ACK ID 只取包头，末尾的数字是参数
+    NSString *message = @"27[\"chatMessage\",{\"text\":\"hi\"},7]";
+
+    RTCVPSocketPacket *packet = [RTCVPSocketPacket packetFromString:message deferArguments:YES error:nil];
+
+    XCTAssertNotNil(packet, @"解析消息失败");
+    XCTAssertEqualObjects(packet.event, @"chatMessage", @"事件名称错误");
+    XCTAssertEqual(packet.packetId, 7, @"ACK ID错误");
+    XCTAssertEqual(packet.args.count, 2, @"事件参数数量错误");
+    XCTAssertEqualObjects(packet.args.firstObject[@"text"], @"hi", @"事件参数内容错误");
+    XCTAssertEqualObjects(packet.args.lastObject, @7, @"末尾数字参数不应被当作ACK ID");
+
+    RTCVPSocketPacket *noAck = [RTCVPSocketPacket packetFromString:@"2[\"score\",42]" error:nil];
+    XCTAssertEqual(noAck.packetId, -1, @"包头没有ID时不应有ACK ID");
+    XCTAssertEqualObjects(noAck.args, (@[@42]), @"数字参数错误");
+}
+
+- (void)testTrailingOffsetWithoutDecodingArguments {
+    // 测试连接状态恢复的偏移量：延迟解析的事件直接从负载末尾读出，不解析参数；带转义时回落到完整解析
+    RTCVPSocketPacket *packet = [RTCVPSocketPacket packetFromString:@"2[\"chat\",{\"text\":\"hi\"},\"1700-3\"]" deferArguments:YES error:nil];
+    XCTAssertEqualObjects(packet.trailingStringArgument, @"1700-3", @"偏移量错误");
+    XCTAssertNotNil([packet valueForKey:@"rawPayload"], @"读取偏移量不应解析参数");
+
+    RTCVPSocketPacket *escaped = [RTCVPSocketPacket packetFromString:@"2[\"chat\",\"a\\\"b\"]" deferArguments:YES error:nil];
+    XCTAssertEqualObjects(escaped.trailingStringArgument, @"a\"b", @"带转义的偏移量应完整解析");
+
+    RTCVPSocketPacket *nameOnly = [RTCVPSocketPacket packetFromString:@"2[\"chat\"]" deferArguments:YES error:nil];
+    XCTAssertNil(nameOnly.trailingStringArgument, @"只有事件名时没有偏移量");
+    RTCVPSocketPacket *number = [RTCVPSocketPacket packetFromString:@"2[\"chat\",7]" deferArguments:YES error:nil];
+    XCTAssertNil(number.trailingStringArgument, @"最后一个参数不是字符串时没有偏移量");
+}
+
 #pragma mark - 二进制消息测试
 
 - (void)testCreateBinaryEventPacket {
@@ -129,6 +333,26 @@
     XCTAssertTrue([packet.binary containsObject:binaryData], @"二进制ACK数据丢失");
 }
 
+- (void)testFillPlaceholdersAndKeepPlainItems {
+    // 测试收到附件后原地替换占位符，以及发送时没有二进制的数据不被复制
+    NSString *message = @"51-[\"upload\",{\"file\":{\"_placeholder\":true,\"num\":0},\"meta\":{\"name\":\"a.png\"}}]";
+    RTCVPSocketPacket *packet = [RTCVPSocketPacket packetFromString:message];
+    NSData *attachment = [@"PNG" dataUsingEncoding:NSUTF8StringEncoding];
+
+    XCTAssertTrue([packet addBinaryData:attachment], @"附件数量错误");
+    NSDictionary *payload = packet.args.firstObject;
+    XCTAssertEqualObjects(payload[@"file"], attachment, @"占位符未被替换");
+    XCTAssertEqualObjects(payload[@"meta"][@"name"], @"a.png", @"普通字段错误");
+
+    NSDictionary *plain = @{@"nested": @{@"list": @[@1, @2]}};
+    RTCVPSocketPacket *textPacket = [RTCVPSocketPacket eventPacketWithEvent:@"plain"
+                                                                     items:@[plain]
+                                                                  packetId:-1
+                                                                       nsp:@"/"
+                                                               requiresAck:NO];
+    XCTAssertTrue(textPacket.args.firstObject == plain, @"不含二进制的数据不应被复制");
+}
+
 #pragma mark - 消息构建测试
 
 - (void)testCreateTextEventPacket {
@@ -176,8 +400,816 @@
     XCTAssertEqual(packet.args, ackData, @"文本ACK数据错误");
 }
 
+- (void)testEncodeEngineMessageData {
+    // 测试直接编码为带Engine.IO前缀的UTF-8字节
+    RTCVPSocketPacket *packet = [RTCVPSocketPacket ackPacketWithId:5
+                                                             items:@[@"ok"]
+                                                               nsp:@"/chat"];
+
+    NSData *expected = [@"43/chat,5[\"ok\"]" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertEqualObjects(packet.engineMessageData, expected, @"编码字节错误");
+    XCTAssertEqualObjects(packet.packetString, @"3/chat,5[\"ok\"]", @"包字符串错误");
+}
+
+- (void)testMsgPackParserRoundTrip {
+    // 测试 MessagePack 编码与 socket.io-msgpack-parser 一致，二进制数据不拆附件
+    RTCVPSocketMsgPackParser *parser = [RTCVPSocketMsgPackParser parser];
+    XCTAssertTrue(parser.encodesToBinary, @"MessagePack应整包二进制发送");
+
+    RTCVPSocketPacket *ack = [RTCVPSocketPacket ackPacketWithId:1 items:@[@"ok"] nsp:@"/"];
+    NSMutableData *ackBytes = [NSMutableData data];
+    [parser encodePacket:ack intoBuffer:ackBytes];
+    const uint8_t expected[] = {0x84, 0xa4, 't', 'y', 'p', 'e', 0x03, 0xa3, 'n', 's', 'p', 0xa1, '/',
+                                0xa4, 'd', 'a', 't', 'a', 0x91, 0xa2, 'o', 'k', 0xa2, 'i', 'd', 0x01};
+    XCTAssertEqualObjects(ackBytes, [NSData dataWithBytes:expected length:sizeof(expected)], @"MessagePack编码字节错误");
+
+    NSData *binaryData = [@"binary" dataUsingEncoding:NSUTF8StringEncoding];
+    RTCVPSocketPacket *event = [RTCVPSocketPacket eventPacketWithEvent:@"file"
+                                                                 items:@[@"hi", binaryData]
+                                                              packetId:7
+                                                                   nsp:@"/chat"
+                                                           requiresAck:YES];
+    NSMutableData *eventBytes = [NSMutableData data];
+    [parser encodePacket:event intoBuffer:eventBytes];
+
+    NSError *error = nil;
+    RTCVPSocketPacket *decoded = [parser decodeData:eventBytes error:&error];
+    XCTAssertNotNil(decoded, @"MessagePack解析失败: %@", error);
+    XCTAssertEqual(decoded.type, RTCVPPacketTypeEvent, @"二进制事件应编码为普通事件");
+    XCTAssertEqualObjects(decoded.nsp, @"/chat", @"命名空间错误");
+    XCTAssertEqual(decoded.packetId, 7, @"ACK ID错误");
+    XCTAssertEqualObjects(decoded.event, @"file", @"事件名错误");
+    XCTAssertEqualObjects(decoded.args, (@[@"hi", binaryData]), @"二进制参数错误");
+}
+
+#pragma mark - 日志测试
+
+- (void)testLoggerLevelGate {
+    // 测试日志开关与级别判断，宏依赖它决定是否格式化消息
+    RTCVPSocketLogger *logger = [[RTCVPSocketLogger alloc] init];
+    XCTAssertFalse([logger isEnabledForLevel:RTCLogLevelError], @"未开启日志且无回调时不应输出");
+
+    [logger onLogMsgWithCB:^(NSString *message, NSString *type) {}];
+    logger.logLevel = RTCLogLevelInfo;
+    XCTAssertTrue([logger isEnabledForLevel:RTCLogLevelInfo], @"回调存在时Info级别应输出");
+    XCTAssertFalse([logger isEnabledForLevel:RTCLogLevelDebug], @"Debug级别高于当前级别不应输出");
+}
+
+- (void)testAsyncLoggerCountsDrops {
+    // 测试异步输出：缓冲区满时丢弃计数，输出条数 + 丢弃条数 = 记录条数
+    RTCVPSocketLogger *logger = [[RTCVPSocketLogger alloc] initWithBufferCapacity:16];
+    logger.asynchronous = YES;
+    __block NSInteger received = 0;
+    [logger onLogMsgWithCB:^(NSString *message, NSString *type) {
+        if (![type isEqualToString:@"SocketLogger"]) {
+            received++;
+        }
+    }];
+
+    for (NSInteger i = 0; i < 1000; i++) {
+        [logger log:[NSString stringWithFormat:@"message %ld", (long)i] type:@"Test"];
+    }
+    [logger flush];
+
+    XCTAssertEqual(logger.bufferCapacity, 16, @"缓冲区容量错误");
+    XCTAssertEqual(received + (NSInteger)logger.droppedCount, 1000, @"输出与丢弃计数不一致");
+}
+
+#pragma mark - WebSocket 写入测试
+
+- (void)testWebSocketWriteLanes {
+    // 测试写入通道：控制通道先于排队的数据消息，大消息按 fragmentSize 分片，close 留在数据通道排在已发出的数据之后
+    RTCJFRWebSocket *socket = [[RTCJFRWebSocket alloc] initWithURL:[NSURL URLWithString:@"ws://localhost:3000"] protocols:nil];
+    socket.fragmentSize = 16;
+    NSOutputStream *output = [NSOutputStream outputStreamToMemory];
+    [output open];
+    [socket setValue:output forKey:@"outputStream"];
+    [socket setValue:@YES forKey:@"isConnected"];
+    dispatch_queue_t writeQueue = [socket valueForKey:@"writeQueue"];
+
+    NSMutableData *large = [NSMutableData dataWithLength:40];
+    for (NSUInteger i = 0; i < large.length; i++) {
+        ((uint8_t *)large.mutableBytes)[i] = (uint8_t)i;
+    }
+    // 写队列暂停时入队，写入开始时两条通道都已排好
+    dispatch_suspend(writeQueue);
+    [socket writeData:large];
+    [socket writeString:@"42[\"b\"]"];
+    [socket writeError:1000];
+    [socket writeString:@"3" priority:RTCJFRWritePriorityControl];
+    [socket writePing:[NSData data]];
+    XCTAssertEqual(socket.bufferedAmount, 40 + 7 + 2 + 1, @"排队的字节应计入 bufferedAmount");
+    dispatch_resume(writeQueue);
+    dispatch_sync(writeQueue, ^{});
+    [socket setValue:@NO forKey:@"isConnected"];
+
+    NSArray<NSDictionary *> *frames = RTCVPTestDecodeClientFrames([output propertyForKey:NSStreamDataWrittenToMemoryStreamKey]);
+    NSArray *headers = [frames valueForKey:@"header"];
+    XCTAssertEqualObjects(headers, (@[@(0x81), @(0x89), @(0x02), @(0x00), @(0x80), @(0x81), @(0x88)]), @"帧顺序错误");
+    XCTAssertEqualObjects(frames[0][@"payload"], [@"3" dataUsingEncoding:NSUTF8StringEncoding], @"控制通道的文本帧应最先写出");
+    NSMutableData *fragments = [NSMutableData data];
+    for (NSUInteger i = 2; i < 5; i++) {
+        XCTAssertLessThanOrEqual([frames[i][@"payload"] length], 16, @"分片不应超过 fragmentSize");
+        [fragments appendData:frames[i][@"payload"]];
+    }
+    XCTAssertEqualObjects(fragments, large, @"分片拼接后应为原消息");
+    XCTAssertEqual(socket.bufferedAmount, 0, @"写出后 bufferedAmount 应归零");
+}
+
+- (void)testWebSocketControlFramesBetweenFragments {
+    // 测试分片之间的插队：只有 ping/pong/close 能插在分片之间，控制通道的文本帧（Engine.IO pong）要等当前消息写完
+    RTCJFRWebSocket *socket = [[RTCJFRWebSocket alloc] initWithURL:[NSURL URLWithString:@"ws://localhost:3000"] protocols:nil];
+    id (^writeItem)(NSData *, NSUInteger) = ^id(NSData *data, NSUInteger code) {
+        id item = [NSClassFromString(@"RTCJFRWriteItem") new];
+        [item setValue:data forKey:@"data"];
+        [item setValue:@(code) forKey:@"code"];
+        return item;
+    };
+    id large = writeItem([NSMutableData dataWithLength:40], 0x2);
+    id pong = writeItem([@"3" dataUsingEncoding:NSUTF8StringEncoding], 0x1);
+    id ping = writeItem([NSData data], 0x9);
+    [[socket valueForKey:@"dataLane"] addObject:large];
+    [[socket valueForKey:@"controlLane"] addObjectsFromArray:@[pong, ping]];
+
+    [large setValue:@(16) forKey:@"offset"];
+    XCTAssertEqual([socket nextWriteItem], ping, @"写到一半的消息只能让 ping/pong/close 插队");
+    [[socket valueForKey:@"controlLane"] removeObject:ping];
+    XCTAssertEqual([socket nextWriteItem], large, @"控制通道的文本帧应等当前消息写完");
+    [large setValue:@(0) forKey:@"offset"];
+    XCTAssertEqual([socket nextWriteItem], pong, @"没有写到一半的消息时控制通道优先");
+}
+
+#pragma mark - 发送缓冲测试
+
+- (void)testVolatileEmitDropsWhenNotConnected {
+    // 测试发送缓冲配置与 volatile 事件：未连接时直接丢弃，不进入缓存
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"highWaterMark": @(4096), @"lowWaterMark": @(1024)}];
+    XCTAssertEqual(config.highWaterMark, 4096, @"高水位解析错误");
+    XCTAssertEqual(config.lowWaterMark, 1024, @"低水位解析错误");
+
+    RTCVPSocketIOClient *client = [RTCVPSocketIOClient clientWithSocketURL:[NSURL URLWithString:@"http://localhost:3000"] config:config];
+    XCTAssertFalse([client emitVolatile:@"position" items:@[@1, @2]], @"未连接时volatile事件应被丢弃");
+    XCTAssertEqual(client.bufferedAmount, 0, @"丢弃的事件不应计入发送缓冲");
+}
+
+- (void)testEngineDrainIgnoresStaleSocketSnapshots {
+    // 测试 WebSocket 写队列回调乱序：先到写线程减后的 0，再到入队线程加后的旧值，发送缓冲不应被旧值撑住
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"highWaterMark": @(100), @"lowWaterMark": @(50)}];
+    RTCVPTestEngineClient *client = [RTCVPTestEngineClient new];
+    RTCVPSocketEngine *engine = [RTCVPSocketEngine engineWithClient:client url:[NSURL URLWithString:@"http://localhost:3000"] config:config];
+
+    [engine retainOutboundBytes:200];
+    XCTAssertEqual(engine.bufferedAmount, 200, @"计入的字节数错误");
+    [engine websocket:nil didUpdateBufferedAmount:0];
+    [engine websocket:nil didUpdateBufferedAmount:4096];
+    XCTAssertEqual(engine.bufferedAmount, 200, @"回调里的快照不应计入发送缓冲");
+    XCTAssertEqual(client.drainCount, 0, @"仍高于低水位时不应触发drain");
+
+    [engine releaseOutboundBytes:200];
+    XCTAssertEqual(engine.bufferedAmount, 0, @"释放后发送缓冲应为0");
+    XCTAssertEqual(client.drainCount, 1, @"回落到低水位以下应触发一次drain");
+    [engine websocket:nil didUpdateBufferedAmount:4096];
+    XCTAssertEqual(client.drainCount, 1, @"drain只应触发一次");
+}
+
+- (void)testEmitRejectedAboveMaxBufferedAmount {
+    // 测试发送缓冲硬上限：超过后普通事件丢弃、带ACK的事件以缓冲已满错误回调，回落后恢复发送
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"maxBufferedAmount": @(1024)}];
+    XCTAssertEqual(config.maxBufferedAmount, 1024, @"硬上限解析错误");
+    XCTAssertEqual([[RTCVPSocketIOConfig alloc] init].maxBufferedAmount, 16 * 1024 * 1024, @"默认硬上限错误");
+
+    RTCVPSocketIOClient *client = [RTCVPSocketIOClient clientWithSocketURL:[NSURL URLWithString:@"http://localhost:3000"] config:config];
+    RTCVPSocketEngine *engine = [RTCVPSocketEngine engineWithClient:(id<RTCVPSocketEngineClient>)client url:[NSURL URLWithString:@"http://localhost:3000"] config:config];
+    [client setValue:engine forKey:@"engine"];
+    [client setValue:@(RTCVPSocketIOClientStatusConnected) forKey:@"status"];
+    [engine retainOutboundBytes:2048];
+
+    XCTestExpectation *rejected = [self expectationWithDescription:@"ACK回调错误"];
+    rejected.expectedFulfillmentCount = 2;
+    void (^ackBlock)(NSArray *, NSError *) = ^(NSArray *data, NSError *error) {
+        XCTAssertEqualObjects(error.domain, RTCVPSocketIOErrorDomain, @"错误 domain 错误");
+        XCTAssertEqual(error.code, RTCVPSocketIOErrorCodeBufferFull, @"应回调发送缓冲已满错误");
+        [rejected fulfill];
+    };
+    [client emit:@"position" items:@[@1]];
+    [client emitWithAck:@"sync" items:@[@1] ackBlock:ackBlock];
+    [client emitBatch:@[[RTCVPSocketBatchEvent eventWithName:@"sync" items:@[@2] ackBlock:ackBlock],
+                        [RTCVPSocketBatchEvent eventWithName:@"position" items:@[@2]]]];
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+    XCTAssertEqual(client.bufferedAmount, 2048, @"超过上限的事件不应交给引擎");
+
+    // 暂停引擎队列，交给引擎的字节在处理前一直计入发送缓冲
+    [engine releaseOutboundBytes:2048];
+    dispatch_queue_t engineQueue = [engine valueForKey:@"engineQueue"];
+    dispatch_suspend(engineQueue);
+    [client emit:@"position" items:@[@3]];
+    XCTAssertGreaterThan(client.bufferedAmount, 0, @"回落后应恢复发送");
+    dispatch_resume(engineQueue);
+}
+
 #pragma mark - 数据包状态管理测试
 
+- (void)testEmitBatchWhenNotConnected {
+    // 测试批量发送：未连接时带ACK的事件逐个回调未连接错误，普通事件不计入发送缓冲
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] init];
+    RTCVPSocketIOClient *client = [RTCVPSocketIOClient clientWithSocketURL:[NSURL URLWithString:@"http://localhost:3000"] config:config];
+    XCTestExpectation *failed = [self expectationWithDescription:@"ACK回调错误"];
+    failed.expectedFulfillmentCount = 2;
+    void (^ackBlock)(NSArray *, NSError *) = ^(NSArray *data, NSError *error) {
+        XCTAssertEqual(error.code, -2, @"应回调未连接错误");
+        [failed fulfill];
+    };
+
+    [client emitBatch:@[[RTCVPSocketBatchEvent eventWithName:@"sync" items:@[@1] ackBlock:ackBlock],
+                        [RTCVPSocketBatchEvent eventWithName:@"position" items:@[@1, @2]],
+                        [RTCVPSocketBatchEvent eventWithName:@"sync" items:@[@2] ackBlock:ackBlock]]];
+
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+    XCTAssertEqual(client.bufferedAmount, 0, @"未连接时不应交给引擎");
+}
+
+- (void)testWebSocketBatchFrameLayout {
+    // 测试 WebSocket 批量写入：每条消息编码成一个完整的带掩码帧，按顺序拼进同一个缓冲区
+    RTCJFRWebSocket *socket = [[RTCJFRWebSocket alloc] initWithURL:[NSURL URLWithString:@"ws://localhost:3000"] protocols:nil];
+    NSData *text = [@"451-[\"sync\",{\"_placeholder\":true,\"num\":0}]" dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData *attachment = [NSMutableData dataWithLength:200];
+    ((uint8_t *)attachment.mutableBytes)[199] = 0xAB;
+    NSData *position = [@"42[\"position\",1]" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    id item = [socket batchItemWithMessages:@[text, attachment, position] binaryIndexes:[NSIndexSet indexSetWithIndex:1]];
+    NSData *buffer = [socket encodeBatchItem:item];
+    // 短帧头 2+4 字节，200 字节的附件需要 2 字节扩展长度
+    XCTAssertEqual(buffer.length, (2 + 4 + text.length) + (4 + 4 + attachment.length) + (2 + 4 + position.length), @"批量缓冲区长度错误");
+    XCTAssertEqual(((const uint8_t *)buffer.bytes)[2 + 4 + text.length + 1], 0x80 | 126, @"200 字节的帧应使用 16 位扩展长度");
+    
+    NSArray<NSDictionary *> *frames = RTCVPTestDecodeClientFrames(buffer);
+    XCTAssertEqual(frames.count, 3, @"每条消息应编码成一个帧");
+    XCTAssertEqualObjects(frames[0][@"header"], @(0x81), @"文本帧应为 FIN+text，且未压缩时不带 RSV1");
+    XCTAssertEqualObjects(frames[0][@"payload"], text, @"文本帧内容错误");
+    XCTAssertEqualObjects(frames[1][@"header"], @(0x82), @"附件应为 FIN+binary");
+    XCTAssertEqualObjects(frames[1][@"payload"], attachment, @"二进制帧内容错误");
+    XCTAssertEqualObjects(frames[2][@"header"], @(0x81), @"文本帧应为 FIN+text");
+    XCTAssertEqualObjects(frames[2][@"payload"], position, @"文本帧内容错误");
+}
+
+- (void)testPollingBatchPostBody {
+    // 测试轮询下的批量发送：整批（含附件）进 postWait，按顺序组装成一个 POST 体
+    NSData *sync = [@"451-[\"sync\",{\"_placeholder\":true,\"num\":0}]" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *position = [@"42[\"position\",1]" dataUsingEncoding:NSUTF8StringEncoding];
+    const uint8_t attachmentBytes[] = {0x01, 0x02, 0x03};
+    NSData *attachment = [NSData dataWithBytes:attachmentBytes length:sizeof(attachmentBytes)];
+    
+    NSString *syncString = [[NSString alloc] initWithData:sync encoding:NSUTF8StringEncoding];
+    NSString *positionString = [[NSString alloc] initWithData:position encoding:NSUTF8StringEncoding];
+    NSDictionary<NSNumber *, NSString *> *expectedBodies = @{
+        @(RTCVPSocketIOProtocolVersion2): [NSString stringWithFormat:@"%lu:%@6:b4AQID%lu:%@", (unsigned long)sync.length, syncString, (unsigned long)position.length, positionString],
+        @(RTCVPSocketIOProtocolVersion3): [NSString stringWithFormat:@"%@\x1e" @"bAQID\x1e%@", syncString, positionString],
+    };
+    
+    for (NSNumber *version in expectedBodies) {
+        RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"protocolVersion": version}];
+        RTCVPTestEngineClient *client = [RTCVPTestEngineClient new];
+        RTCVPSocketEngine *engine = [RTCVPSocketEngine engineWithClient:client url:[NSURL URLWithString:@"http://localhost:3000"] config:config];
+        NSMutableArray *postWait = [engine valueForKey:@"postWait"];
+        
+        // 模拟已有 POST 在途：整批留在 postWait，等这次 POST 结束后一起带走
+        [engine setValue:@YES forKey:@"connected"];
+        [engine setValue:@YES forKey:@"waitingForPost"];
+        [engine sendEncodedMessages:@[sync, position] binary:NO withData:@[@[attachment], @[]]];
+        dispatch_sync([engine valueForKey:@"engineQueue"], ^{});
+        XCTAssertEqual(postWait.count, 3, @"整批消息和附件应进入 postWait");
+        XCTAssertEqual(engine.bufferedAmount, sync.length + position.length + attachment.length, @"整批应计入发送缓冲");
+        [engine setValue:@NO forKey:@"waitingForPost"];
+        [engine setValue:@NO forKey:@"connected"];
+        
+        NSData *body = [engine createRequestForPostWithPostWait].HTTPBody;
+        XCTAssertEqual(postWait.count, 0, @"整批应合并成一个 POST");
+        XCTAssertEqualObjects([[NSString alloc] initWithData:body encoding:NSUTF8StringEncoding], expectedBodies[version], @"POST 体格式错误");
+    }
+}
+
+- (void)testPollingWriterConfig {
+    // 测试轮询合并窗口和单个 POST 负载上限的默认值与字典配置
+    RTCVPSocketIOConfig *defaults = [[RTCVPSocketIOConfig alloc] init];
+    XCTAssertEqual(defaults.maxPollingPayloadSize, 1000000, @"默认负载上限应与服务端 maxHttpBufferSize 一致");
+    XCTAssertGreaterThan(defaults.pollingCoalesceInterval, 0, @"默认应启用合并窗口");
+
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"pollingCoalesceInterval": @(0), @"maxPollingPayloadSize": @(65536)}];
+    XCTAssertEqual(config.pollingCoalesceInterval, 0, @"合并窗口解析错误");
+    XCTAssertEqual(config.maxPollingPayloadSize, 65536, @"负载上限解析错误");
+}
+
+- (void)testPollingWriterSplitsPostWait {
+    // 测试轮询写入：合并窗口内的消息等同一个 POST，超过负载上限时按顺序拆分，附件跟在所属消息后面
+    NSData *first = [@"42[\"aaaaaa\"]" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *second = [@"42[\"bbbbbb\"]" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *third = [@"42[\"cccccc\"]" dataUsingEncoding:NSUTF8StringEncoding];
+    const uint8_t attachmentBytes[] = {0x01, 0x02, 0x03};
+    NSData *attachment = [NSData dataWithBytes:attachmentBytes length:sizeof(attachmentBytes)];
+    
+    // 每条按 长度+8 估算：文本 20，附件 14；上限 45 时前两条一个 POST，附件和第三条一个 POST
+    NSDictionary<NSNumber *, NSArray *> *expected = @{
+        @(RTCVPSocketIOProtocolVersion2): @[@[@"42[\"aaaaaa\"]", @"42[\"bbbbbb\"]"], @[@"b4AQID", @"42[\"cccccc\"]"]],
+        @(RTCVPSocketIOProtocolVersion3): @[@[@"42[\"aaaaaa\"]", @"42[\"bbbbbb\"]"], @[@"bAQID", @"42[\"cccccc\"]"]],
+    };
+    NSDictionary<NSNumber *, NSArray *> *expectedBodies = @{
+        @(RTCVPSocketIOProtocolVersion2): @[@"12:42[\"aaaaaa\"]12:42[\"bbbbbb\"]", @"6:b4AQID12:42[\"cccccc\"]"],
+        @(RTCVPSocketIOProtocolVersion3): @[@"42[\"aaaaaa\"]\x1e" @"42[\"bbbbbb\"]", @"bAQID\x1e" @"42[\"cccccc\"]"],
+    };
+    
+    for (NSNumber *version in expected) {
+        RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"protocolVersion": version,
+                                                                                      @"maxPollingPayloadSize": @(45),
+                                                                                      @"pollingCoalesceInterval": @(10)}];
+        RTCVPTestEngineClient *client = [RTCVPTestEngineClient new];
+        RTCVPSocketEngine *engine = [RTCVPSocketEngine engineWithClient:client url:[NSURL URLWithString:@"http://localhost:3000"] config:config];
+        NSMutableArray *postWait = [engine valueForKey:@"postWait"];
+        
+        [engine sendPollEncodedMessage:first withData:nil];
+        [engine sendPollEncodedMessage:second withData:@[attachment]];
+        XCTAssertTrue([[engine valueForKey:@"postFlushScheduled"] boolValue], @"合并窗口内应等待同一次发送");
+        [engine sendPollEncodedMessage:third withData:nil];
+        XCTAssertEqual(postWait.count, 4, @"合并窗口内的消息和附件应留在 postWait");
+        
+        // 已有 POST 在途时不再发送新的 POST
+        [engine setValue:@YES forKey:@"connected"];
+        [engine setValue:@YES forKey:@"waitingForPost"];
+        [engine flushWaitingForPost];
+        XCTAssertEqual(postWait.count, 4, @"同时只应有一个 POST 在途");
+        [engine setValue:@NO forKey:@"waitingForPost"];
+        [engine setValue:@NO forKey:@"connected"];
+        
+        NSMutableArray<NSString *> *bodies = [NSMutableArray array];
+        NSMutableArray<NSArray *> *parts = [NSMutableArray array];
+        while (postWait.count > 0) {
+            NSData *body = [engine createRequestForPostWithPostWait].HTTPBody;
+            [bodies addObject:[[NSString alloc] initWithData:body encoding:NSUTF8StringEncoding]];
+            NSMutableArray<NSString *> *records = [NSMutableArray array];
+            BOOL complete = [RTCVPPollingPayloadDecoder enumerateRecordsInData:body protocolVersion:version.integerValue usingBlock:^(const uint8_t *bytes, NSUInteger length, BOOL *stop) {
+                [records addObject:[[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding]];
+            }];
+            XCTAssertTrue(complete, @"POST 体应能完整解码");
+            [parts addObject:records];
+        }
+        XCTAssertEqualObjects(bodies, expectedBodies[version], @"POST 体格式错误");
+        XCTAssertEqualObjects(parts, expected[version], @"拆分后每个 POST 的记录错误");
+    }
+}
+
+- (void)testPollingURLTemplateFollowsSid {
+    // 测试轮询 URL 模板：sid 变化时重建，每次请求只追加新的 t 参数
+    RTCVPTestEngineClient *client = [RTCVPTestEngineClient new];
+    RTCVPSocketEngine *engine = [RTCVPSocketEngine engineWithClient:client url:[NSURL URLWithString:@"http://localhost:3000"] config:[[RTCVPSocketIOConfig alloc] init]];
+    
+    [engine setValue:@"sid-a" forKey:@"sid"];
+    NSString *firstURL = [engine urlPollingWithSid].absoluteString;
+    NSString *secondURL = [engine urlPollingWithSid].absoluteString;
+    XCTAssertTrue([firstURL containsString:@"sid=sid-a"], @"URL 应带当前 sid");
+    XCTAssertEqualObjects([engine valueForKey:@"pollingURLTemplateSid"], @"sid-a", @"模板应记录生成时的 sid");
+    XCTAssertNotEqualObjects(firstURL, secondURL, @"每次请求应生成新的 t 参数");
+    
+    [engine setValue:@"sid-b" forKey:@"sid"];
+    NSString *rebuiltURL = [engine urlPollingWithSid].absoluteString;
+    XCTAssertTrue([rebuiltURL containsString:@"sid=sid-b"], @"sid 变化后应重建模板");
+    XCTAssertFalse([rebuiltURL containsString:@"sid-a"], @"重建后不应保留旧 sid");
+}
+
+- (void)testHeartbeatPongMeasuresRoundTrip {
+    // 测试 Engine.IO v3 心跳：pong 按发出 ping 的单调时钟计算往返时延，没有对应 ping 的 pong 不采样
+    RTCVPTestEngineClient *client = [RTCVPTestEngineClient new];
+    RTCVPSocketEngine *engine = [RTCVPSocketEngine engineWithClient:client url:[NSURL URLWithString:@"http://localhost:3000"] config:[[RTCVPSocketIOConfig alloc] init]];
+
+    [engine handlePong:@""];
+    XCTAssertEqual(client.roundTrips.count, 0, @"没有发出 ping 时不应采样");
+
+    uint64_t sentAt = RTCVPMonotonicNanoseconds() - 20 * NSEC_PER_MSEC;
+    [engine setValue:@(sentAt) forKey:@"pingSentAt"];
+    [engine handlePong:@""];
+    XCTAssertEqual(client.roundTrips.count, 1, @"pong 应记录一次往返采样");
+    XCTAssertGreaterThanOrEqual(client.roundTrips.firstObject.doubleValue, 0.02, @"往返时延应从发出 ping 开始计算");
+    XCTAssertEqualObjects([engine valueForKey:@"pingSentAt"], @0, @"采样后应清除 ping 时间");
+
+    [engine handlePong:@""];
+    XCTAssertEqual(client.roundTrips.count, 1, @"重复的 pong 不应再次采样");
+}
+
+- (void)testWebSocketFallbackDelayConfig {
+    // 测试自动模式下 WebSocket 直连领先时间的默认值与字典配置
+    RTCVPSocketIOConfig *defaults = [[RTCVPSocketIOConfig alloc] init];
+    XCTAssertEqual(defaults.transport, RTCVPSocketIOTransportAuto, @"默认应为自动模式");
+    XCTAssertGreaterThan(defaults.websocketFallbackDelay, 0, @"默认应给 WebSocket 直连领先时间");
+
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"websocketFallbackDelay": @(0.25)}];
+    XCTAssertEqual(config.websocketFallbackDelay, 0.25, @"领先时间解析错误");
+}
+
+- (void)testCompressionConfig {
+    // 测试 permessage-deflate 配置的默认值与字典配置，以及协议修复不再清掉 RSV1 压缩标记
+    RTCVPSocketIOConfig *defaults = [[RTCVPSocketIOConfig alloc] init];
+    XCTAssertFalse(defaults.compressionEnabled, @"默认不应协商压缩");
+    XCTAssertEqual(defaults.compressionThreshold, 1024, @"默认压缩阈值错误");
+    XCTAssertEqual(defaults.compressionClientMaxWindowBits, 15, @"默认客户端窗口错误");
+    XCTAssertEqual(defaults.compressionServerMaxWindowBits, 15, @"默认服务端窗口错误");
+
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"compress": @YES,
+                                                                                    @"compressionThreshold": @(256),
+                                                                                    @"compressionClientMaxWindowBits": @(12),
+                                                                                    @"compressionServerNoContextTakeover": @YES}];
+    XCTAssertTrue(config.compressionEnabled, @"压缩开关解析错误");
+    XCTAssertEqual(config.compressionThreshold, 256, @"压缩阈值解析错误");
+    XCTAssertEqual(config.compressionClientMaxWindowBits, 12, @"客户端窗口解析错误");
+    XCTAssertTrue(config.compressionServerNoContextTakeover, @"服务端上下文选项解析错误");
+    XCTAssertFalse(config.compressionClientNoContextTakeover, @"未设置的选项应保持默认值");
+
+    // FIN | RSV1 | Text，长度 1
+    uint8_t compressed[] = {0xC1, 0x01, 0x00};
+    NSData *frame = [NSData dataWithBytes:compressed length:sizeof(compressed)];
+    XCTAssertTrue([RTCVPWebSocketProtocolFixer isValidWebSocketFrame:frame], @"压缩文本帧应有效");
+    XCTAssertEqual(((const uint8_t *)[RTCVPWebSocketProtocolFixer fixWebSocketFrame:frame].bytes)[0], 0xC1, @"不应清除 RSV1");
+    // FIN | RSV1 | Ping
+    uint8_t ping[] = {0xC9, 0x00};
+    XCTAssertFalse([RTCVPWebSocketProtocolFixer isValidWebSocketFrame:[NSData dataWithBytes:ping length:sizeof(ping)]], @"控制帧不能带 RSV1");
+}
+
+- (void)testPermessageDeflateNegotiation {
+    // 测试 RFC 7692 协商：未提供的扩展或参数、重复参数、非法窗口都让握手失败；服务端要求 8 位窗口时退回不压缩
+    RTCJFRWebSocket *socket = [[RTCJFRWebSocket alloc] initWithURL:[NSURL URLWithString:@"ws://localhost:3000"] protocols:nil];
+    XCTAssertFalse([socket negotiateExtensions:@"permessage-deflate"], @"未开启压缩时不应接受服务端的扩展");
+    XCTAssertTrue([socket negotiateExtensions:nil], @"服务端不带扩展时握手应成功");
+    
+    socket.compressionEnabled = YES;
+    XCTAssertEqualObjects([socket compressionOffer], @"permessage-deflate; client_max_window_bits", @"默认提议错误");
+    socket.clientMaxWindowBits = 8;
+    socket.serverMaxWindowBits = 10;
+    socket.clientNoContextTakeover = YES;
+    XCTAssertEqualObjects([socket compressionOffer], @"permessage-deflate; client_max_window_bits=9; server_max_window_bits=10; client_no_context_takeover", @"客户端窗口不应低于 9");
+    
+    XCTAssertTrue([socket negotiateExtensions:@"permessage-deflate; server_no_context_takeover; client_max_window_bits=9; server_max_window_bits=10"], @"合法的应答应被接受");
+    XCTAssertTrue(socket.compressionNegotiated, @"接受后应标记已协商");
+    
+    NSArray<NSString *> *rejected = @[@"permessage-deflate; foo",
+                                      @"permessage-deflate; client_max_window_bits=10; client_max_window_bits=12",
+                                      @"permessage-deflate; server_no_context_takeover; server_no_context_takeover",
+                                      @"permessage-deflate; server_no_context_takeover=1",
+                                      @"permessage-deflate; server_max_window_bits=12",
+                                      @"permessage-deflate; client_max_window_bits=16",
+                                      @"permessage-deflate; client_max_window_bits",
+                                      @"permessage-deflate, permessage-deflate",
+                                      @"x-webkit-deflate-frame"];
+    for (NSString *extensions in rejected) {
+        XCTAssertFalse([socket negotiateExtensions:extensions], @"应拒绝应答：%@", extensions);
+        XCTAssertFalse(socket.compressionNegotiated, @"拒绝后不应保留上次的协商结果：%@", extensions);
+    }
+    
+    // 8 位窗口 zlib 无法生成原始 deflate：协商成功但消息不压缩，也不带 RSV1
+    XCTAssertTrue([socket negotiateExtensions:@"permessage-deflate; client_max_window_bits=8"], @"8 位窗口的应答应被接受");
+    socket.compressionThreshold = 0;
+    NSData *message = RTCVPTestCompressibleMessage(2000);
+    NSArray<NSDictionary *> *frames = RTCVPTestDecodeClientFrames([socket encodeBatchItem:[socket batchItemWithMessages:@[message] binaryIndexes:nil]]);
+    XCTAssertEqualObjects(frames.firstObject[@"header"], @(0x81), @"8 位窗口时不应设置 RSV1");
+    XCTAssertEqualObjects(frames.firstObject[@"payload"], message, @"8 位窗口时应原样发送");
+}
+
+- (void)testPermessageDeflateRoundTrip {
+    // 测试压缩往返：发送端去掉 00 00 ff ff 尾部，接收端补回；保留上下文时第二条引用前一条的窗口
+    NSData *message = RTCVPTestCompressibleMessage(2000);
+    const uint8_t tail[] = {0x00, 0x00, 0xff, 0xff};
+    
+    RTCJFRWebSocket *sender = RTCVPTestDeflateSocket(@"permessage-deflate");
+    RTCJFRWebSocket *receiver = RTCVPTestDeflateSocket(@"permessage-deflate");
+    NSData *first = [sender deflateMessage:message];
+    NSData *second = [sender deflateMessage:message];
+    XCTAssertGreaterThan(first.length, sizeof(tail), @"压缩结果为空");
+    XCTAssertNotEqual(memcmp((const uint8_t *)first.bytes + first.length - sizeof(tail), tail, sizeof(tail)), 0, @"应去掉同步刷新的尾部");
+    XCTAssertLessThan(second.length, first.length / 4, @"保留上下文时重复的消息应引用前一条");
+    
+    NSMutableData *payload = [first mutableCopy];
+    XCTAssertEqualObjects([receiver inflateMessage:payload], message, @"第一条解压错误");
+    XCTAssertEqual(payload.length, first.length + sizeof(tail), @"解压前应补回尾部");
+    XCTAssertEqualObjects([receiver inflateMessage:[second mutableCopy]], message, @"第二条解压错误");
+    XCTAssertNil([RTCVPTestDeflateSocket(@"permessage-deflate") inflateMessage:[second mutableCopy]], @"没有前一条的窗口时不应解压成功");
+    XCTAssertTrue([sender negotiateExtensions:@"permessage-deflate"], @"重新协商失败");
+    XCTAssertEqualObjects([sender deflateMessage:message], first, @"重新协商（重连）后应使用新的上下文");
+    
+    // client_no_context_takeover：每条都用新的上下文，同样的消息压缩结果相同，接收端也逐条重置
+    RTCJFRWebSocket *resetSender = RTCVPTestDeflateSocket(@"permessage-deflate; client_no_context_takeover");
+    RTCJFRWebSocket *resetReceiver = RTCVPTestDeflateSocket(@"permessage-deflate; server_no_context_takeover");
+    NSData *resetFirst = [resetSender deflateMessage:message];
+    NSData *resetSecond = [resetSender deflateMessage:message];
+    XCTAssertEqualObjects(resetFirst, resetSecond, @"不保留上下文时每条应独立压缩");
+    XCTAssertEqualObjects([resetReceiver inflateMessage:[resetFirst mutableCopy]], message, @"第一条解压错误");
+    XCTAssertEqualObjects([resetReceiver inflateMessage:[resetSecond mutableCopy]], message, @"第二条解压错误");
+    
+    // 空消息压缩成单个 0x00（RFC 7692 7.2.3.6）
+    const uint8_t emptyBlock[] = {0x00};
+    XCTAssertEqualObjects([resetSender deflateMessage:[NSData data]], [NSData dataWithBytes:emptyBlock length:sizeof(emptyBlock)], @"空消息压缩结果错误");
+    XCTAssertEqualObjects([resetReceiver inflateMessage:[NSMutableData dataWithBytes:emptyBlock length:sizeof(emptyBlock)]], [NSData data], @"空消息解压错误");
+}
+
+- (void)testPermessageDeflateFrames {
+    // 测试压缩帧：低于阈值的消息不压缩；压缩消息分片时只有第一个分片带 RSV1
+    RTCJFRWebSocket *sender = RTCVPTestDeflateSocket(@"permessage-deflate");
+    RTCJFRWebSocket *receiver = RTCVPTestDeflateSocket(@"permessage-deflate");
+    NSData *shortMessage = RTCVPTestCompressibleMessage(100);
+    NSData *longMessage = RTCVPTestCompressibleMessage(2000);
+    
+    NSArray<NSDictionary *> *frames = RTCVPTestDecodeClientFrames([sender encodeBatchItem:[sender batchItemWithMessages:@[shortMessage, longMessage] binaryIndexes:nil]]);
+    XCTAssertEqual(frames.count, 2, @"每条消息应编码成一个帧");
+    XCTAssertEqualObjects(frames[0][@"header"], @(0x81), @"低于阈值的消息不应压缩");
+    XCTAssertEqualObjects(frames[0][@"payload"], shortMessage, @"低于阈值的消息应原样发送");
+    XCTAssertEqualObjects(frames[1][@"header"], @(0xC1), @"压缩消息应为 FIN+RSV1+text");
+    XCTAssertEqualObjects([receiver inflateMessage:[frames[1][@"payload"] mutableCopy]], longMessage, @"压缩帧解压错误");
+    
+    // 新的上下文，压缩结果大于一个分片
+    sender = RTCVPTestDeflateSocket(@"permessage-deflate");
+    receiver = RTCVPTestDeflateSocket(@"permessage-deflate");
+    sender.fragmentSize = 512;
+    id item = [NSClassFromString(@"RTCJFRWriteItem") new];
+    NSData *compressed = [sender deflateMessage:longMessage];
+    XCTAssertGreaterThan(compressed.length, 1024, @"压缩结果应超过两个分片");
+    [item setValue:compressed forKey:@"data"];
+    [item setValue:@(0x1) forKey:@"code"];
+    [item setValue:@YES forKey:@"compressed"];
+    NSMutableData *fragments = [NSMutableData data];
+    while ([[item valueForKey:@"offset"] unsignedIntegerValue] < compressed.length) {
+        [fragments appendData:[sender encodeNextFrameOfItem:item control:NO]];
+    }
+    frames = RTCVPTestDecodeClientFrames(fragments);
+    XCTAssertEqual(frames.count, (compressed.length + 511) / 512, @"分片数量错误");
+    XCTAssertEqualObjects(frames.firstObject[@"header"], @(0x41), @"第一个分片应为 RSV1+text，不带 FIN");
+    for (NSUInteger i = 1; i + 1 < frames.count; i++) {
+        XCTAssertEqualObjects(frames[i][@"header"], @(0x00), @"中间分片应为不带 RSV1 的延续帧");
+    }
+    XCTAssertEqualObjects(frames.lastObject[@"header"], @(0x80), @"最后一个分片应为 FIN+延续帧，不带 RSV1");
+    
+    NSMutableData *payload = [NSMutableData data];
+    for (NSDictionary *frame in frames) {
+        [payload appendData:frame[@"payload"]];
+    }
+    XCTAssertEqualObjects([receiver inflateMessage:payload], longMessage, @"分片拼接后解压错误");
+}
+
+- (void)testReconnectSchedulerBackoff {
+    // 测试重连退避：抖动比例为 0 时是纯指数退避并受最大延迟限制，抖动时延迟落在 [base, max] 内
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] init];
+    config.reconnectionDelay = 1;
+    config.reconnectionDelayMax = 5;
+    config.randomizationFactor = 0;
+    RTCVPReconnectScheduler *scheduler = [RTCVPReconnectScheduler schedulerWithConfig:config queue:dispatch_get_main_queue()];
+    XCTAssertEqual([scheduler nextDelay], 1, @"第一次延迟应为基础延迟");
+    XCTAssertEqual([scheduler nextDelay], 2, @"第二次延迟应翻倍");
+    XCTAssertEqual([scheduler nextDelay], 4, @"第三次延迟应翻倍");
+    XCTAssertEqual([scheduler nextDelay], 5, @"延迟不应超过最大值");
+
+    scheduler.randomizationFactor = 1;
+    [scheduler reset];
+    for (int i = 0; i < 100; i++) {
+        NSTimeInterval delay = [scheduler nextDelay];
+        XCTAssertGreaterThanOrEqual(delay, 1, @"抖动后的延迟不应小于基础延迟");
+        XCTAssertLessThanOrEqual(delay, 5, @"抖动后的延迟不应超过最大值");
+    }
+}
+
+- (void)testReconnectDriverGivesUpAfterMaxAttempts {
+    // 测试重连状态机：每次尝试失败后按退避再试，次数用完时回调失败并结束本轮；baseDelay 可覆盖配置
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] init];
+    config.reconnectionDelay = 10;
+    config.randomizationFactor = 0;
+    config.reconnectionAttempts = 2;
+    RTCVPReconnectDriver *driver = [RTCVPReconnectDriver driverWithConfig:config queue:dispatch_get_main_queue()];
+    XCTAssertEqual(driver.maxAttempts, 2, @"最大尝试次数应取自配置");
+    driver.baseDelay = 0.01;
+
+    RTCVPTestReconnectDelegate *delegate = [RTCVPTestReconnectDelegate new];
+    delegate.attempts = [NSMutableArray array];
+    delegate.failed = [self expectationWithDescription:@"重连失败"];
+    driver.delegate = delegate;
+
+    [driver connectionDidClose:@"transport close"];
+    XCTAssertTrue(driver.isReconnecting, @"连接关闭后应开始重连");
+    [driver startWithReason:@"manual reconnect" immediately:YES];
+    XCTAssertEqual(delegate.startCount, 1, @"重连中再次开始应被忽略");
+
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqualObjects(delegate.attempts, (@[@1, @2]), @"尝试次数错误");
+    XCTAssertFalse(driver.isReconnecting, @"次数用完后应结束重连");
+}
+
+- (void)testManagerSocketForNamespace {
+    // 测试 manager：同一命名空间返回同一个 socket，不同命名空间各自独立
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] init];
+    config.enableNetworkMonitoring = NO;
+    RTCVPSocketManager *manager = [RTCVPSocketManager managerWithSocketURL:[NSURL URLWithString:@"http://localhost:3000"] config:config];
+    RTCVPSocketIOClient *chat = [manager socketForNamespace:@"/chat"];
+    XCTAssertEqual([manager socketForNamespace:@"chat"], chat, @"同一命名空间应返回同一个socket");
+    XCTAssertEqualObjects(chat.nsp, @"/chat", @"命名空间错误");
+    XCTAssertNotEqual([manager socketForNamespace:@"/"], chat, @"不同命名空间应返回不同socket");
+    XCTAssertFalse(manager.isOpen, @"未连接时引擎不应打开");
+}
+
+- (void)testConnectionTimeline {
+    // 测试连接时间线：每个阶段只记第一次，时间相对 start 计算，未到达的阶段不出现在字典里
+    RTCVPConnectionTimeline *timeline = [[RTCVPConnectionTimeline alloc] init];
+    uint64_t start = RTCVPMonotonicNanoseconds();
+    XCTAssertTrue([timeline markPhase:RTCVPConnectionPhaseStart atTime:start], @"首次记录应成功");
+    XCTAssertTrue([timeline markPhase:RTCVPConnectionPhaseEngineOpen atTime:start + 250 * NSEC_PER_MSEC], @"首次记录应成功");
+    XCTAssertFalse([timeline markPhase:RTCVPConnectionPhaseEngineOpen atTime:start + 500 * NSEC_PER_MSEC], @"重复记录应被忽略");
+
+    XCTAssertEqualWithAccuracy([timeline elapsedForPhase:RTCVPConnectionPhaseEngineOpen], 0.25, 0.0001, @"阶段耗时错误");
+    XCTAssertEqual([timeline elapsedForPhase:RTCVPConnectionPhaseFirstEvent], -1, @"未到达的阶段应为-1");
+
+    NSDictionary *dictionary = [[timeline copy] dictionaryRepresentation];
+    XCTAssertEqualObjects(dictionary[@"engineOpen"], @(250.0), @"字典中的毫秒数错误");
+    XCTAssertNil(dictionary[@"firstEvent"], @"未到达的阶段不应出现");
+}
+
+- (void)testRTTEstimator {
+    // 测试往返时延估算（RFC 6298）：首个采样初始化，之后按 1/8、1/4 增益平滑，超时受上下限约束
+    RTCVPRTTEstimator *estimator = [[RTCVPRTTEstimator alloc] init];
+    XCTAssertEqual([estimator timeoutWithFallback:10 minimum:1 maximum:60], 10, @"没有采样时应使用默认超时");
+
+    [estimator addSample:0.1];
+    XCTAssertEqualWithAccuracy(estimator.smoothedRTT, 0.1, 0.0001, @"首个采样应直接作为SRTT");
+    XCTAssertEqualWithAccuracy(estimator.rttVariance, 0.05, 0.0001, @"首个采样的RTTVAR应为一半");
+    XCTAssertEqualWithAccuracy([estimator timeoutWithFallback:10 minimum:0 maximum:60], 0.3, 0.0001, @"超时应为SRTT+4*RTTVAR");
+
+    [estimator addSample:0.1];
+    XCTAssertEqualWithAccuracy(estimator.rttVariance, 0.0375, 0.0001, @"稳定链路上RTTVAR应收敛");
+    XCTAssertEqualWithAccuracy([estimator timeoutWithFallback:10 minimum:0 maximum:60], 0.25, 0.0001, @"超时应随RTTVAR下降");
+    XCTAssertEqual([estimator timeoutWithFallback:10 minimum:1 maximum:60], 1, @"超时不应低于下限");
+
+    [estimator addSample:0];
+    XCTAssertEqual(estimator.sampleCount, 2, @"非正数采样应忽略");
+    [estimator reset];
+    XCTAssertEqual(estimator.smoothedRTT, 0, @"重置后应清空");
+}
+
+- (void)testAckTimingUsesMonotonicClock {
+    // 测试 ACK 计时：自适应超时的上下限可由字典配置，RTT 采样按包创建时的单调时钟计算
+    RTCVPSocketIOConfig *config = [[RTCVPSocketIOConfig alloc] initWithDictionary:@{@"adaptiveAckTimeout": @YES,
+                                                                                  @"minAckTimeout": @(0.5),
+                                                                                  @"maxAckTimeout": @(20)}];
+    XCTAssertEqual(config.minAckTimeout, 0.5, @"超时下限解析错误");
+    XCTAssertEqual(config.maxAckTimeout, 20, @"超时上限解析错误");
+
+    uint64_t before = RTCVPMonotonicNanoseconds();
+    RTCVPSocketPacket *packet = [RTCVPSocketPacket eventPacketWithEvent:@"sync" items:@[] packetId:1 nsp:@"/" requiresAck:YES];
+    XCTAssertGreaterThanOrEqual(packet.creationUptime, before, @"创建时间应取单调时钟");
+    XCTAssertLessThanOrEqual(packet.creationUptime, RTCVPMonotonicNanoseconds(), @"创建时间应取单调时钟");
+
+    RTCVPACKManager *manager = [[RTCVPACKManager alloc] initWithDefaultTimeout:10];
+    manager.rttEstimator = [[RTCVPRTTEstimator alloc] init];
+    XCTAssertEqual([manager registerPacket:packet send:nil], RTCVPACKRegistrationAccepted, @"登记失败");
+    XCTAssertTrue([manager acknowledgePacketWithId:1 data:nil], @"确认失败");
+    XCTAssertEqual(manager.rttEstimator.sampleCount, 1, @"确认后应记录一次RTT采样");
+    XCTAssertGreaterThan(manager.rttEstimator.smoothedRTT, 0, @"RTT采样应为正数");
+    XCTAssertLessThan(manager.rttEstimator.smoothedRTT, 1, @"RTT采样应为创建到确认的时间");
+}
+
+- (void)testTimingWheel {
+    // 测试时间轮：到期项在队列上回调，取消的项不回调，全部处理完后计数归零
+    dispatch_queue_t queue = dispatch_queue_create("test.timingwheel", DISPATCH_QUEUE_SERIAL);
+    RTCVPTimingWheel *wheel = [[RTCVPTimingWheel alloc] initWithQueue:queue tickInterval:0.01 slotCount:8];
+    XCTestExpectation *fired = [self expectationWithDescription:@"定时项到期"];
+    fired.expectedFulfillmentCount = 2;
+    __block RTCVPTimingWheelTimer *cancelled = nil;
+
+    dispatch_sync(queue, ^{
+        [wheel scheduleAfter:0.02 handler:^{ [fired fulfill]; }];
+        // 超过一圈（0.08 秒）的延迟跨圈到期
+        [wheel scheduleAfter:0.15 handler:^{ [fired fulfill]; }];
+        cancelled = [wheel scheduleAfter:0.05 handler:^{ XCTFail(@"已取消的定时项不应回调"); }];
+        [wheel cancelTimer:cancelled];
+        XCTAssertEqual(wheel.count, 2, @"取消后计数错误");
+    });
+
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    dispatch_sync(queue, ^{
+        XCTAssertEqual(wheel.count, 0, @"全部到期后计数应为0");
+        XCTAssertFalse(cancelled.isScheduled, @"取消后不应再挂在时间轮上");
+    });
+}
+
+- (void)testPendingAckTable {
+    // 测试等待ACK表：冲突的ID走线性探测，删除后后移不影响查找，扩容后数据完整
+    RTCVPPendingAckTable *table = [[RTCVPPendingAckTable alloc] initWithCapacity:4];
+    NSMutableArray<RTCVPSocketPacket *> *packets = [NSMutableArray array];
+    // 低位相同的 ID 落在同一个槽
+    uint32_t ids[] = {1, 17, 33, 2, 0xFFFFFFFF, 100000};
+    for (int i = 0; i < 6; i++) {
+        RTCVPSocketPacket *packet = [RTCVPSocketPacket eventPacketWithEvent:@"e" items:@[] packetId:ids[i] nsp:@"/" requiresAck:YES];
+        [packets addObject:packet];
+        XCTAssertTrue([table setPacket:packet deadline:@(i) forId:ids[i]], @"插入失败");
+    }
+    XCTAssertFalse([table setPacket:packets[0] deadline:nil forId:1], @"重复ID应插入失败");
+    XCTAssertEqual(table.count, 6, @"计数错误");
+
+    id deadline = nil;
+    XCTAssertEqual([table removePacketForId:17 deadline:&deadline], packets[1], @"删除返回的包错误");
+    XCTAssertEqualObjects(deadline, @1, @"超时项错误");
+    XCTAssertEqual([table packetForId:33], packets[2], @"删除后探测链上的包应仍可查到");
+    XCTAssertEqual([table packetForId:2], packets[3], @"删除后相邻槽的包应仍可查到");
+    XCTAssertNil([table packetForId:17], @"已删除的包不应查到");
+
+    for (uint32_t packetId = 1000; packetId < 1200; packetId++) {
+        [table setPacket:packets[0] deadline:nil forId:packetId];
+    }
+    XCTAssertEqual(table.count, 205, @"扩容后计数错误");
+    XCTAssertEqual([table packetForId:0xFFFFFFFF], packets[4], @"扩容后查找错误");
+    [table removeAllPackets];
+    XCTAssertEqual(table.count, 0, @"清空后计数应为0");
+}
+
+- (void)testACKOverflowPolicy {
+    // 测试容量已满：Reject 立即以容量错误失败，Wait 排队到有包确认后再发送
+    RTCVPACKManager *manager = [[RTCVPACKManager alloc] initWithDefaultTimeout:10];
+    manager.maxPendingPackets = 1;
+    RTCVPSocketPacket *first = [RTCVPSocketPacket eventPacketWithEvent:@"a" items:@[] packetId:1 nsp:@"/" requiresAck:YES];
+    XCTAssertEqual([manager registerPacket:first send:nil], RTCVPACKRegistrationAccepted, @"未满时应直接登记");
+
+    __block NSError *rejectError = nil;
+    RTCVPSocketPacket *rejected = [RTCVPSocketPacket eventPacketWithEvent:@"b" items:@[] packetId:2 nsp:@"/" requiresAck:YES];
+    [rejected setupAckCallbacksWithSuccess:nil error:^(NSError *error) { rejectError = error; } timeout:10];
+    XCTAssertEqual([manager registerPacket:rejected send:nil], RTCVPACKRegistrationRejected, @"已满时应拒绝");
+    XCTAssertEqual(rejectError.code, RTCVPACKErrorCodeOverflow, @"拒绝错误码错误");
+    XCTAssertEqual(first.state, RTCVPPacketStatePending, @"已登记的包不应被挤掉");
+
+    manager.overflowPolicy = RTCVPACKOverflowPolicyWait;
+    XCTestExpectation *sent = [self expectationWithDescription:@"排队的包发送"];
+    RTCVPSocketPacket *queued = [RTCVPSocketPacket eventPacketWithEvent:@"c" items:@[] packetId:3 nsp:@"/" requiresAck:YES];
+    XCTAssertEqual([manager registerPacket:queued send:^{ [sent fulfill]; }], RTCVPACKRegistrationQueued, @"已满时应排队");
+    XCTAssertEqual(manager.queuedPacketCount, 1, @"排队数错误");
+
+    XCTAssertTrue([manager acknowledgePacketWithId:1 data:nil], @"确认失败");
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+    XCTAssertEqual(manager.queuedPacketCount, 0, @"确认后排队的包应已发送");
+    XCTAssertNotNil([manager packetForId:3], @"排队的包应进入等待表");
+}
+
+- (void)testSocketMetrics {
+    // 测试延迟直方图：小值精确，大值落在所在桶的上界；快照合并多组计数器
+    RTCVPLatencyHistogram *histogram = [[RTCVPLatencyHistogram alloc] init];
+    XCTAssertEqual([histogram valueAtPercentile:99], 0, @"空直方图应为0");
+    for (uint64_t value = 1; value <= 1000; value++) {
+        [histogram recordValue:value];
+    }
+    XCTAssertEqual(histogram.count, 1000, @"记录数错误");
+    XCTAssertEqualWithAccuracy(histogram.mean, 500.5, 0.001, @"平均值错误");
+    XCTAssertEqual([histogram valueAtPercentile:1], 10, @"小值应精确");
+    XCTAssertEqual([histogram valueAtPercentile:50], 511, @"p50应为所在桶上界");
+    XCTAssertEqual([histogram valueAtPercentile:100], 1000, @"p100不应超过最大值");
+
+    RTCVPSocketMetrics *client = [[RTCVPSocketMetrics alloc] init];
+    RTCVPSocketMetrics *engine = [[RTCVPSocketMetrics alloc] init];
+    [client addValue:3 toCounter:RTCVPMetricEmits];
+    [engine addValue:128 toCounter:RTCVPMetricWebSocketBytesOut];
+    [engine addValue:2 toCounter:RTCVPMetricWebSocketFramesOut];
+    NSUInteger gauges[RTCVPMetricGaugeCount] = {0};
+    gauges[RTCVPMetricPendingAckDepth] = 4;
+
+    RTCVPSocketMetricsSnapshot *snapshot = [[RTCVPSocketMetricsSnapshot alloc] initWithMetrics:@[client, engine]
+                                                                                         gauges:gauges
+                                                                                       previous:nil];
+    XCTAssertEqual([snapshot valueForCounter:RTCVPMetricEmits], 3, @"客户端计数错误");
+    XCTAssertEqual([snapshot valueForCounter:RTCVPMetricWebSocketBytesOut], 128, @"引擎计数错误");
+    XCTAssertEqual([snapshot valueForGauge:RTCVPMetricPendingAckDepth], 4, @"队列深度错误");
+    XCTAssertEqualObjects(snapshot.dictionaryRepresentation[@"websocketFramesOut"], @2, @"字典内容错误");
+}
+
+- (void)testPollingPayloadDecoder {
+    // 测试轮询负载解码：v3 长度按 UTF-16 单元计算（emoji 占 2），v4 以 0x1e 分隔
+    NSData *v3 = [@"2:40" "5:4\"😀\"" "1:3" dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableArray<NSString *> *records = [NSMutableArray array];
+    BOOL complete = [RTCVPPollingPayloadDecoder enumerateRecordsInData:v3 protocolVersion:RTCVPSocketIOProtocolVersion2 usingBlock:^(const uint8_t *bytes, NSUInteger length, BOOL *stop) {
+        [records addObject:[[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding]];
+    }];
+    XCTAssertTrue(complete, @"v3负载应完整解码");
+    XCTAssertEqualObjects(records, (@[@"40", @"4\"😀\"", @"3"]), @"v3记录切分错误");
+
+    // 声明长度超出剩余数据：前面完整的记录照常给出，截断的记录不给出并报告失败
+    NSData *truncated = [@"2:40" "10:42[\"a\"" dataUsingEncoding:NSUTF8StringEncoding];
+    [records removeAllObjects];
+    complete = [RTCVPPollingPayloadDecoder enumerateRecordsInData:truncated protocolVersion:RTCVPSocketIOProtocolVersion2 usingBlock:^(const uint8_t *bytes, NSUInteger length, BOOL *stop) {
+        [records addObject:[[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding]];
+    }];
+    XCTAssertFalse(complete, @"截断的v3负载应报告失败");
+    XCTAssertEqualObjects(records, (@[@"40"]), @"截断的记录不应给出");
+
+    // 多字节字符被截断在中间
+    NSData *splitEmoji = [NSData dataWithBytes:"2:\xF0\x9F" length:4];
+    XCTAssertFalse([RTCVPPollingPayloadDecoder enumerateRecordsInData:splitEmoji protocolVersion:RTCVPSocketIOProtocolVersion2 usingBlock:^(const uint8_t *bytes, NSUInteger length, BOOL *stop) {
+        XCTFail(@"截断的字符不应给出记录");
+    }], @"截断在字符中间应报告失败");
+
+    NSData *v4 = [@"40\x1e" "42[\"a\"]\x1e" "bAQI=" dataUsingEncoding:NSUTF8StringEncoding];
+    [records removeAllObjects];
+    complete = [RTCVPPollingPayloadDecoder enumerateRecordsInData:v4 protocolVersion:RTCVPSocketIOProtocolVersion3 usingBlock:^(const uint8_t *bytes, NSUInteger length, BOOL *stop) {
+        [records addObject:[[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding]];
+    }];
+    XCTAssertTrue(complete, @"v4负载应完整解码");
+    XCTAssertEqualObjects(records, (@[@"40", @"42[\"a\"]", @"bAQI="]), @"v4记录切分错误");
+}
+
 - (void)testPacketStateTransitions {
     // 测试数据包状态转换
     
@@ -24,6 +24,18 @@
 
 @class RTCJFRWebSocket;
 
+/**
+ Which lane a frame is queued on.
+ Control frames go ahead of queued data messages; ping/pong frames are even written between the fragments of a large message.
+ A control lane text frame (such as the Engine.IO pong "3") is still a data frame on the wire: it skips queued messages,
+ but waits for the fragments of a message that is already being written. Fragmentation therefore only shortens the wait
+ for WebSocket-level ping/pong; an Engine.IO heartbeat can still be delayed by one large message in flight.
+ */
+typedef NS_ENUM(NSUInteger, RTCJFRWritePriority) {
+    RTCJFRWritePriorityNormal = 0,
+    RTCJFRWritePriorityControl
+};
+
 /**
  It is important to note that all the delegate methods are put back on the main thread.
  This means if you want to do some major process of the data, you need to create a background thread.
@@ -58,6 +70,21 @@
  */
 -(void)websocket:(nonnull RTCJFRWebSocket*)socket didReceiveData:(nullable NSData*)data;
 
+/**
+ The websocket got a pong, usually the answer to writePing:.
+ @param socket is the current socket object.
+ @param data   is the application data echoed back from the ping.
+ */
+-(void)websocket:(nonnull RTCJFRWebSocket*)socket didReceivePong:(nonnull NSData*)data;
+
+/**
+ The amount of queued but unwritten bytes changed.
+ Unlike the other delegate methods this is called directly on the thread that queued or wrote the frame.
+ @param socket         is the current socket object.
+ @param bufferedAmount is the number of payload bytes still waiting to be written.
+ */
+-(void)websocket:(nonnull RTCJFRWebSocket*)socket didUpdateBufferedAmount:(NSUInteger)bufferedAmount;
+
 @end
 
 @interface RTCJFRWebSocket : NSObject
@@ -95,6 +122,35 @@
  */
 - (void)writeString:(nonnull NSString*)string;
 
+/**
+ write text based data that is already UTF-8 encoded, skipping the NSString round trip.
+ @param data the UTF-8 bytes to send as a text frame.
+ */
+- (void)writeUTF8Data:(nonnull NSData*)data;
+
+/**
+ write text based data on the given lane.
+ A control lane text frame skips queued data messages, but still waits for a fragmented message that is already being written.
+ @param string   the string to write.
+ @param priority the lane to queue the frame on.
+ */
+- (void)writeString:(nonnull NSString*)string priority:(RTCJFRWritePriority)priority;
+
+/**
+ write UTF-8 encoded text on the given lane.
+ @param data     the UTF-8 bytes to send as a text frame.
+ @param priority the lane to queue the frame on.
+ */
+- (void)writeUTF8Data:(nonnull NSData*)data priority:(RTCJFRWritePriority)priority;
+
+/**
+ write several messages back to back as one data lane item.
+ Each message becomes one unfragmented frame, and all frames are encoded into one buffer and handed to the stream in a single write loop.
+ @param messages      the payloads, in order.
+ @param binaryIndexes indexes of the messages to send as binary frames, the rest are sent as text frames.
+ */
+- (void)writeBatch:(nonnull NSArray<NSData*>*)messages binaryIndexes:(nullable NSIndexSet*)binaryIndexes;
+
 /**
  write ping to the socket.
  @param data the binary data to write (if desired).
@@ -113,6 +169,66 @@
  */
 @property(nonatomic, assign, readonly)BOOL isConnected;
 
+/**
+ the number of payload bytes that have been queued with the write methods but not yet written to the stream.
+ */
+@property(nonatomic, assign, readonly)NSUInteger bufferedAmount;
+
+/**
+ monotonic timestamps (clock_gettime_nsec_np(CLOCK_UPTIME_RAW), in nanoseconds) of the connection phases.
+ They are reset by connect and stay 0 until the phase is reached; tlsCompletedAt stays 0 for ws:// urls.
+ */
+@property(nonatomic, assign, readonly)uint64_t tcpOpenedAt;
+@property(nonatomic, assign, readonly)uint64_t tlsCompletedAt;
+@property(nonatomic, assign, readonly)uint64_t upgradeCompletedAt;
+
+/**
+ data messages larger than this are sent as continuation fragments so control frames can be written in between.
+ Default is 16KB, 0 disables fragmentation.
+ */
+@property(nonatomic, assign)NSUInteger fragmentSize;
+
+/**
+ offer the permessage-deflate extension (RFC 7692) on connect.
+ Messages are only compressed when the server accepts the offer, see compressionNegotiated.
+ Default setting is No.
+ */
+@property(nonatomic, assign)BOOL compressionEnabled;
+
+/**
+ text and binary messages shorter than this are sent uncompressed even when compression was negotiated.
+ Default is 1024 bytes.
+ */
+@property(nonatomic, assign)NSUInteger compressionThreshold;
+
+/**
+ LZ77 window size (8-15) the client uses to compress, offered as client_max_window_bits.
+ The server may ask for a smaller one. Default is 15.
+ */
+@property(nonatomic, assign)NSUInteger clientMaxWindowBits;
+
+/**
+ LZ77 window size (8-15) the server is asked to compress with, offered as server_max_window_bits.
+ Default is 15.
+ */
+@property(nonatomic, assign)NSUInteger serverMaxWindowBits;
+
+/**
+ compress every message with a fresh context instead of keeping the window between messages.
+ Uses less memory per connection but compresses small similar messages worse. Default setting is No.
+ */
+@property(nonatomic, assign)BOOL clientNoContextTakeover;
+
+/**
+ ask the server to reset its compression context after every message. Default setting is No.
+ */
+@property(nonatomic, assign)BOOL serverNoContextTakeover;
+
+/**
+ returns if permessage-deflate was accepted by the server in the last handshake.
+ */
+@property(nonatomic, assign, readonly)BOOL compressionNegotiated;
+
 /**
  Enable VOIP support on the socket, so it can be used in the background for VOIP calls.
  Default setting is No.
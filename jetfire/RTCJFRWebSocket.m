@@ -20,6 +20,9 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
 #import "RTCJFRWebSocket.h"
+#import <stdatomic.h>
+#import <time.h>
+#import <zlib.h>
 
 //get the opCode from the packet
 typedef NS_ENUM(NSUInteger, RTCJFROpCode) {
@@ -61,15 +64,41 @@ typedef NS_ENUM(NSUInteger, RTCJFRInternalErrorCode) {
 @property(nonatomic, assign)NSInteger bytesLeft;
 @property(nonatomic, assign)NSInteger frameCount;
 @property(nonatomic, strong)NSMutableData *buffer;
+@property(nonatomic, assign)BOOL compressed;
 
 @end
 
-@interface RTCJFRWebSocket ()<NSStreamDelegate>
+//holds an outbound message while it is written, possibly as several fragments
+@interface RTCJFRWriteItem : NSObject
+
+@property(nonatomic, strong)NSData *data;
+@property(nonatomic, assign)RTCJFROpCode code;
+@property(nonatomic, assign)NSUInteger offset;
+@property(nonatomic, assign)BOOL compressed;
+//set for a batch: whole frames that are encoded into one buffer and written together, data is nil
+@property(nonatomic, strong)NSArray<RTCJFRWriteItem*> *batch;
+@property(nonatomic, assign)NSUInteger batchLength;
+
+@end
+
+@interface RTCJFRWebSocket ()<NSStreamDelegate> {
+    atomic_ulong _bufferedBytes;
+    //permessage-deflate contexts. The inflater is only used on the stream thread, the deflater only on the write queue.
+    z_stream _inflater;
+    z_stream _deflater;
+    BOOL _inflaterReady;
+    BOOL _deflaterReady;
+    BOOL _inflateResetPerMessage;
+    BOOL _deflateResetPerMessage;
+}
 
 @property(nonatomic, strong, nonnull)NSURL *url;
 @property(nonatomic, strong, null_unspecified)NSInputStream *inputStream;
 @property(nonatomic, strong, null_unspecified)NSOutputStream *outputStream;
-@property(nonatomic, strong, null_unspecified)NSOperationQueue *writeQueue;
+@property(nonatomic, strong, nonnull)dispatch_queue_t writeQueue;
+@property(nonatomic, strong, nonnull)NSMutableArray<RTCJFRWriteItem*> *controlLane;
+@property(nonatomic, strong, nonnull)NSMutableArray<RTCJFRWriteItem*> *dataLane;
+@property(nonatomic, assign)BOOL isWriting;
 @property(nonatomic, assign)BOOL isRunLoop;
 @property(nonatomic, strong, nonnull)NSMutableArray *readStack;
 @property(nonatomic, strong, nonnull)NSMutableArray *inputQueue;
@@ -79,6 +108,11 @@ typedef NS_ENUM(NSUInteger, RTCJFRInternalErrorCode) {
 @property(nonatomic, assign)BOOL isCreated;
 @property(nonatomic, assign)BOOL didDisconnect;
 @property(nonatomic, assign)BOOL certValidated;
+@property(nonatomic, assign)BOOL isSecure;
+@property(nonatomic, assign, readwrite)uint64_t tcpOpenedAt;
+@property(nonatomic, assign, readwrite)uint64_t tlsCompletedAt;
+@property(nonatomic, assign, readwrite)uint64_t upgradeCompletedAt;
+@property(nonatomic, assign, readwrite)BOOL compressionNegotiated;
 
 @end
 
@@ -95,6 +129,8 @@ static NSString *const headerWSVersionValue    = @"13";
 static NSString *const headerWSKeyName         = @"Sec-WebSocket-Key";
 static NSString *const headerOriginName        = @"Origin";
 static NSString *const headerWSAcceptName      = @"Sec-WebSocket-Accept";
+static NSString *const headerWSExtensionsName  = @"Sec-WebSocket-Extensions";
+static NSString *const extensionDeflateName    = @"permessage-deflate";
 NS_ASSUME_NONNULL_END
 
 //Class Constants
@@ -105,9 +141,25 @@ static int BUFFER_MAX = 4096;
 static const uint8_t RTCJFRFinMask             = 0x80;
 static const uint8_t RTCJFROpCodeMask          = 0x0F;
 static const uint8_t RTCJFRRSVMask             = 0x70;
+static const uint8_t RTCJFRRSV1Mask            = 0x40;
 static const uint8_t RTCJFRMaskMask            = 0x80;
 static const uint8_t RTCJFRPayloadLenMask      = 0x7F;
 static const size_t  RTCJFRMaxFrameSize        = 32;
+static const NSUInteger RTCJFRDefaultFragmentSize = 16 * 1024;
+static const NSUInteger RTCJFRDefaultCompressionThreshold = 1024;
+static const NSUInteger RTCJFRCompressionChunkSize = 4096;
+static const uint8_t RTCJFRDeflateTail[] = {0x00, 0x00, 0xff, 0xff};
+
+//window bits parameter value of permessage-deflate, 0 if it is not a number in 8-15
+static int RTCJFRWindowBits(NSString *value) {
+    NSString *bits = [value stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\""]];
+    if(bits.length == 0 || bits.length > 2 ||
+       [bits rangeOfCharacterFromSet:[[NSCharacterSet decimalDigitCharacterSet] invertedSet]].location != NSNotFound) {
+        return 0;
+    }
+    int windowBits = bits.intValue;
+    return (windowBits >= 8 && windowBits <= MAX_WBITS) ? windowBits : 0;
+}
 
 @implementation RTCJFRWebSocket
 
@@ -120,6 +172,13 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
         self.voipEnabled = NO;
         self.selfSignedSSL = NO;
         self.queue = dispatch_get_main_queue();
+        self.fragmentSize = RTCJFRDefaultFragmentSize;
+        self.compressionThreshold = RTCJFRDefaultCompressionThreshold;
+        self.clientMaxWindowBits = MAX_WBITS;
+        self.serverMaxWindowBits = MAX_WBITS;
+        self.writeQueue = dispatch_queue_create("com.vluxe.jetfire.write", DISPATCH_QUEUE_SERIAL);
+        self.controlLane = [NSMutableArray new];
+        self.dataLane = [NSMutableArray new];
         self.url = url;
         self.readStack = [NSMutableArray new];
         self.inputQueue = [NSMutableArray new];
@@ -143,6 +202,9 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
     //everything is on a background thread.
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
         self.isCreated = YES;
+        self.tcpOpenedAt = 0;
+        self.tlsCompletedAt = 0;
+        self.upgradeCompletedAt = 0;
         [self createHTTPRequest];
         self.isCreated = NO;
     });
@@ -153,18 +215,56 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
 }
 /////////////////////////////////////////////////////////////////////////////
 - (void)writeString:(NSString*)string {
+    [self writeString:string priority:RTCJFRWritePriorityNormal];
+}
+/////////////////////////////////////////////////////////////////////////////
+- (void)writeString:(NSString*)string priority:(RTCJFRWritePriority)priority {
     if(string) {
-        [self dequeueWrite:[string dataUsingEncoding:NSUTF8StringEncoding]
-                  withCode:RTCJFROpCodeTextFrame];
+        [self writeUTF8Data:[string dataUsingEncoding:NSUTF8StringEncoding] priority:priority];
+    }
+}
+/////////////////////////////////////////////////////////////////////////////
+- (void)writeUTF8Data:(NSData*)data {
+    [self writeUTF8Data:data priority:RTCJFRWritePriorityNormal];
+}
+/////////////////////////////////////////////////////////////////////////////
+- (void)writeUTF8Data:(NSData*)data priority:(RTCJFRWritePriority)priority {
+    if(data) {
+        [self dequeueWrite:data withCode:RTCJFROpCodeTextFrame control:(priority == RTCJFRWritePriorityControl)];
     }
 }
 /////////////////////////////////////////////////////////////////////////////
 - (void)writePing:(NSData*)data {
-    [self dequeueWrite:data withCode:RTCJFROpCodePing];
+    [self dequeueWrite:data withCode:RTCJFROpCodePing control:YES];
 }
 /////////////////////////////////////////////////////////////////////////////
 - (void)writeData:(NSData*)data {
-    [self dequeueWrite:data withCode:RTCJFROpCodeBinaryFrame];
+    [self dequeueWrite:data withCode:RTCJFROpCodeBinaryFrame control:NO];
+}
+/////////////////////////////////////////////////////////////////////////////
+- (void)writeBatch:(NSArray<NSData*>*)messages binaryIndexes:(NSIndexSet*)binaryIndexes {
+    if(!self.isConnected || messages.count == 0) {
+        return;
+    }
+    RTCJFRWriteItem *item = [self batchItemWithMessages:messages binaryIndexes:binaryIndexes];
+    [self enqueueWriteItem:item length:item.batchLength control:NO];
+}
+/////////////////////////////////////////////////////////////////////////////
+//every message of a batch becomes one whole frame, text unless its index is in binaryIndexes
+- (RTCJFRWriteItem*)batchItemWithMessages:(NSArray<NSData*>*)messages binaryIndexes:(NSIndexSet*)binaryIndexes {
+    NSMutableArray<RTCJFRWriteItem*> *frames = [NSMutableArray arrayWithCapacity:messages.count];
+    NSUInteger length = 0;
+    for(NSUInteger i = 0; i < messages.count; i++) {
+        RTCJFRWriteItem *frame = [RTCJFRWriteItem new];
+        frame.data = messages[i];
+        frame.code = [binaryIndexes containsIndex:i] ? RTCJFROpCodeBinaryFrame : RTCJFROpCodeTextFrame;
+        [frames addObject:frame];
+        length += frame.data.length;
+    }
+    RTCJFRWriteItem *item = [RTCJFRWriteItem new];
+    item.batch = frames;
+    item.batchLength = length;
+    return item;
 }
 /////////////////////////////////////////////////////////////////////////////
 - (void)addHeader:(NSString*)value forKey:(NSString*)key {
@@ -241,6 +341,11 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
                                          (__bridge CFStringRef)headerWSProtocolName,
                                          (__bridge CFStringRef)protocols);
     }
+    if (self.compressionEnabled) {
+        CFHTTPMessageSetHeaderFieldValue(urlRequest,
+                                         (__bridge CFStringRef)headerWSExtensionsName,
+                                         (__bridge CFStringRef)[self compressionOffer]);
+    }
    
     CFHTTPMessageSetHeaderFieldValue(urlRequest,
                                      (__bridge CFStringRef)headerOriginName,
@@ -261,6 +366,29 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
     CFRelease(requestMethod);
 }
 /////////////////////////////////////////////////////////////////////////////
+//The permessage-deflate offer. client_max_window_bits is always sent so the server knows it may shrink our window.
+//zlib can't produce raw deflate with an 8 bit window, so the client side never offers less than 9.
+- (NSString*)compressionOffer {
+    NSUInteger clientBits = MIN(MAX(self.clientMaxWindowBits, (NSUInteger)9), (NSUInteger)MAX_WBITS);
+    NSUInteger serverBits = MIN(MAX(self.serverMaxWindowBits, (NSUInteger)8), (NSUInteger)MAX_WBITS);
+    NSMutableString *offer = [NSMutableString stringWithString:extensionDeflateName];
+    if(clientBits < MAX_WBITS) {
+        [offer appendFormat:@"; client_max_window_bits=%lu", (unsigned long)clientBits];
+    } else {
+        [offer appendString:@"; client_max_window_bits"];
+    }
+    if(serverBits < MAX_WBITS) {
+        [offer appendFormat:@"; server_max_window_bits=%lu", (unsigned long)serverBits];
+    }
+    if(self.clientNoContextTakeover) {
+        [offer appendString:@"; client_no_context_takeover"];
+    }
+    if(self.serverNoContextTakeover) {
+        [offer appendString:@"; server_no_context_takeover"];
+    }
+    return offer;
+}
+/////////////////////////////////////////////////////////////////////////////
 //Random String of 16 lowercase chars, SHA1 and base64 encoded.
 - (NSString*)generateWebSocketKey {
     NSInteger seed = 16;
@@ -286,6 +414,7 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
     // 修改SSL配置部分
     if([self.url.scheme isEqualToString:@"wss"] || [self.url.scheme isEqualToString:@"https"]) {
         // 仅对wss/https设置SSL属性
+        self.isSecure = YES;
         [self.inputStream setProperty:NSStreamSocketSecurityLevelNegotiatedSSL forKey:NSStreamSocketSecurityLevelKey];
         [self.outputStream setProperty:NSStreamSocketSecurityLevelNegotiatedSSL forKey:NSStreamSocketSecurityLevelKey];
         
@@ -309,6 +438,7 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
            }
     } else {
         // 对于ws/http，明确设置不使用SSL
+        self.isSecure = NO;
         [self.inputStream setProperty:NSStreamSocketSecurityLevelNone forKey:NSStreamSocketSecurityLevelKey];
         [self.outputStream setProperty:NSStreamSocketSecurityLevelNone forKey:NSStreamSocketSecurityLevelKey];
         self.certValidated = YES; //not a https session, so no need to check SSL pinning
@@ -358,6 +488,10 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
             break;
             
         case NSStreamEventOpenCompleted:
+            //the TCP connection is up, TLS (if any) is negotiated afterwards
+            if(aStream == self.outputStream && self.tcpOpenedAt == 0) {
+                self.tcpOpenedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            }
             break;
             
         case NSStreamEventHasBytesAvailable:
@@ -367,6 +501,10 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
             break;
             
         case NSStreamEventHasSpaceAvailable:
+            //a secure stream only becomes writable once the TLS handshake is done
+            if(aStream == self.outputStream && self.isSecure && self.tlsCompletedAt == 0) {
+                self.tlsCompletedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            }
             break;
             
         case NSStreamEventErrorOccurred:
@@ -383,7 +521,8 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
 }
 /////////////////////////////////////////////////////////////////////////////
 - (void)disconnectStream:(NSError*)error {
-    [self.writeQueue waitUntilAllOperationsAreFinished];
+    //let the writer finish (or drop) what is queued before the streams go away
+    dispatch_sync(self.writeQueue, ^{});
     [self.inputStream removeFromRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
     [self.outputStream removeFromRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
     [self.outputStream close];
@@ -467,6 +606,7 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
     if(totalSize > 0) {
         BOOL status = [self validateResponse:buffer length:totalSize responseStatusCode:responseStatusCode];
         if (status == YES) {
+            self.upgradeCompletedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
             _isConnected = YES;
             __weak typeof(self) weakSelf = self;
             dispatch_async(self.queue,^{
@@ -500,13 +640,95 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
     }
     NSDictionary *headers = (__bridge_transfer NSDictionary *)(CFHTTPMessageCopyAllHeaderFields(response));
     NSString *acceptKey = headers[headerWSAcceptName];
+    NSString *extensions = (__bridge_transfer NSString *)(CFHTTPMessageCopyHeaderFieldValue(response, (__bridge CFStringRef)headerWSExtensionsName));
     CFRelease(response);
     if(acceptKey.length > 0) {
-        return YES;
+        return [self negotiateExtensions:extensions];
     }
     return NO;
 }
 /////////////////////////////////////////////////////////////////////////////
+//Checks the Sec-WebSocket-Extensions answer against our offer and sets up the compression contexts.
+//An extension or parameter we did not offer fails the handshake (RFC 6455 section 9.1, RFC 7692 section 7.1).
+- (BOOL)negotiateExtensions:(nullable NSString*)extensions {
+    [self resetCompression];
+    if(extensions.length == 0) {
+        return YES;
+    }
+    NSArray<NSString*> *accepted = [extensions componentsSeparatedByString:@","];
+    if(!self.compressionEnabled || accepted.count != 1) {
+        return NO;
+    }
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceCharacterSet];
+    NSArray<NSString*> *params = [accepted.firstObject componentsSeparatedByString:@";"];
+    if([[params.firstObject stringByTrimmingCharactersInSet:whitespace] caseInsensitiveCompare:extensionDeflateName] != NSOrderedSame) {
+        return NO;
+    }
+    
+    int clientBits = (int)MIN(MAX(self.clientMaxWindowBits, (NSUInteger)9), (NSUInteger)MAX_WBITS);
+    BOOL clientNoContextTakeover = self.clientNoContextTakeover;
+    BOOL serverNoContextTakeover = NO;
+    NSMutableSet<NSString*> *seen = [NSMutableSet set];
+    for(NSUInteger i = 1; i < params.count; i++) {
+        NSArray<NSString*> *pair = [params[i] componentsSeparatedByString:@"="];
+        NSString *name = [[pair.firstObject stringByTrimmingCharactersInSet:whitespace] lowercaseString];
+        NSString *value = (pair.count > 1) ? [pair[1] stringByTrimmingCharactersInSet:whitespace] : nil;
+        if(pair.count > 2 || [seen containsObject:name]) {
+            return NO;
+        }
+        [seen addObject:name];
+        if([name isEqualToString:@"server_no_context_takeover"] && !value) {
+            serverNoContextTakeover = YES;
+        } else if([name isEqualToString:@"client_no_context_takeover"] && !value) {
+            clientNoContextTakeover = YES;
+        } else if([name isEqualToString:@"server_max_window_bits"]) {
+            int bits = RTCJFRWindowBits(value);
+            if(bits == 0 || bits > (int)MIN(MAX(self.serverMaxWindowBits, (NSUInteger)8), (NSUInteger)MAX_WBITS)) {
+                return NO;
+            }
+        } else if([name isEqualToString:@"client_max_window_bits"]) {
+            int bits = RTCJFRWindowBits(value);
+            if(bits == 0) {
+                return NO;
+            }
+            clientBits = MIN(clientBits, bits);
+        } else {
+            return NO;
+        }
+    }
+    
+    //inflate always uses the largest window, it reads anything compressed with a smaller one
+    if(inflateInit2(&_inflater, -MAX_WBITS) != Z_OK) {
+        return NO;
+    }
+    _inflaterReady = YES;
+    _inflateResetPerMessage = serverNoContextTakeover;
+    dispatch_sync(self.writeQueue, ^{
+        //raw deflate has no 8 bit window; if the server insists on it we just send uncompressed
+        if(clientBits >= 9 && deflateInit2(&self->_deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -clientBits, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+            self->_deflaterReady = YES;
+            self->_deflateResetPerMessage = clientNoContextTakeover;
+        }
+    });
+    self.compressionNegotiated = YES;
+    return YES;
+}
+/////////////////////////////////////////////////////////////////////////////
+//Drops the compression contexts of the previous connection.
+- (void)resetCompression {
+    self.compressionNegotiated = NO;
+    if(_inflaterReady) {
+        inflateEnd(&_inflater);
+        _inflaterReady = NO;
+    }
+    dispatch_sync(self.writeQueue, ^{
+        if(self->_deflaterReady) {
+            deflateEnd(&self->_deflater);
+            self->_deflaterReady = NO;
+        }
+    });
+}
+/////////////////////////////////////////////////////////////////////////////
 -(void)processRawMessage:(uint8_t*)buffer length:(NSInteger)bufferLen {
     RTCJFRResponse *response = [self.readStack lastObject];
     if(response && bufferLen < 2) {
@@ -538,8 +760,13 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
         BOOL isMasked = (RTCJFRMaskMask & buffer[1]);
         uint8_t payloadLen = (RTCJFRPayloadLenMask & buffer[1]);
         NSInteger offset = 2; //how many bytes do we need to skip for the header
+        // 协商了 permessage-deflate 时 RSV1 标记压缩消息，不算违规
+        uint8_t rsv = (RTCJFRRSVMask & buffer[0]);
+        if(_inflaterReady) {
+            rsv &= ~RTCJFRRSV1Mask;
+        }
         // 宽容处理masked和RSV数据，不再断开连接
-        if((isMasked || (RTCJFRRSVMask & buffer[0])) && receivedOpcode != RTCJFROpCodePong) {
+        if((isMasked || rsv) && receivedOpcode != RTCJFROpCodePong) {
             NSLog(@"⚠️ 收到带有masked或RSV位的WebSocket帧，违反协议，但继续处理");
         }
         
@@ -637,6 +864,12 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
             data = [NSData dataWithBytes:(buffer+offset) length:len];
         }
         if(receivedOpcode == RTCJFROpCodePong) {
+            __weak typeof(self) weakSelf = self;
+            dispatch_async(self.queue,^{
+                if([weakSelf.delegate respondsToSelector:@selector(websocket:didReceivePong:)]) {
+                    [weakSelf.delegate websocket:weakSelf didReceivePong:data];
+                }
+            });
             NSInteger step = (offset+len);
             NSInteger extra = bufferLen-step;
             if(extra > 0) {
@@ -663,6 +896,7 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
             isNew = YES;
             response = [RTCJFRResponse new];
             response.code = receivedOpcode;
+            response.compressed = (_inflaterReady && !isControlFrame && (RTCJFRRSV1Mask & buffer[0]));
             response.bytesLeft = dataLength;
             response.buffer = [NSMutableData dataWithData:data];
         } else {
@@ -703,10 +937,18 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
 - (BOOL)processResponse:(RTCJFRResponse*)response {
     if(response.isFin && response.bytesLeft <= 0) {
         NSData *data = response.buffer;
+        if(response.compressed) {
+            data = [self inflateMessage:response.buffer];
+            if(!data) {
+                [self doDisconnect:[self errorWithDetail:@"invalid compressed message" code:RTCJFRCloseCodeProtocolError]];
+                [self writeError:RTCJFRCloseCodeProtocolError];
+                return NO;
+            }
+        }
         if(response.code == RTCJFROpCodePing) {
-            [self dequeueWrite:response.buffer withCode:RTCJFROpCodePong];
+            [self dequeueWrite:response.buffer withCode:RTCJFROpCodePong control:YES];
         } else if(response.code == RTCJFROpCodeTextFrame) {
-            NSString *str = [[NSString alloc] initWithData:response.buffer encoding:NSUTF8StringEncoding];
+            NSString *str = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
             if(!str) {
                 [self writeError:RTCJFRCloseCodeEncoding];
                 return NO;
@@ -737,76 +979,295 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
     return NO;
 }
 /////////////////////////////////////////////////////////////////////////////
--(void)dequeueWrite:(NSData*)data withCode:(RTCJFROpCode)code {
+//Inflates one permessage-deflate message. The sender drops the 0x00 0x00 0xff 0xff tail of its sync flush,
+//so it is put back before inflating (RFC 7692 section 7.2.2). Only called on the stream thread.
+- (nullable NSData*)inflateMessage:(NSMutableData*)payload {
+    [payload appendBytes:RTCJFRDeflateTail length:sizeof(RTCJFRDeflateTail)];
+    NSMutableData *output = [NSMutableData new];
+    _inflater.next_in = (Bytef*)payload.bytes;
+    _inflater.avail_in = (uInt)payload.length;
+    int status = Z_OK;
+    do {
+        NSUInteger start = output.length;
+        NSUInteger chunk = MAX(RTCJFRCompressionChunkSize, start);
+        [output increaseLengthBy:chunk];
+        _inflater.next_out = (Bytef*)output.mutableBytes + start;
+        _inflater.avail_out = (uInt)chunk;
+        status = inflate(&_inflater, Z_SYNC_FLUSH);
+        [output setLength:output.length - _inflater.avail_out];
+    } while(status == Z_OK && _inflater.avail_out == 0);
+    
+    BOOL ok = (status == Z_OK || status == Z_STREAM_END || (status == Z_BUF_ERROR && _inflater.avail_in == 0));
+    //a final deflate block ends the stream, the next message starts a new one
+    if(!ok || status == Z_STREAM_END || _inflateResetPerMessage) {
+        inflateReset(&_inflater);
+    }
+    return ok ? output : nil;
+}
+/////////////////////////////////////////////////////////////////////////////
+//Queues a frame on its lane and makes sure the writer is running.
+//Control lane: protocol frames that should not wait behind bulk data. Data lane: everything else, in order.
+-(void)dequeueWrite:(NSData*)data withCode:(RTCJFROpCode)code control:(BOOL)control {
     if(!self.isConnected) {
         return;
     }
-    if(!self.writeQueue) {
-        self.writeQueue = [[NSOperationQueue alloc] init];
-        self.writeQueue.maxConcurrentOperationCount = 1;
-    }
+    RTCJFRWriteItem *item = [RTCJFRWriteItem new];
+    item.data = data;
+    item.code = code;
+    [self enqueueWriteItem:item length:data.length control:control];
+}
+/////////////////////////////////////////////////////////////////////////////
+- (void)enqueueWriteItem:(RTCJFRWriteItem*)item length:(NSUInteger)length control:(BOOL)control {
+    // count before the item is visible to the writer so it can never report a smaller value first
+    [self updateBufferedAmount:length added:YES];
     
-    __weak typeof(self) weakSelf = self;
-    [self.writeQueue addOperationWithBlock:^{
-        if(!weakSelf || !weakSelf.isConnected) {
-            return;
+    BOOL startWriter = NO;
+    @synchronized(self.dataLane) {
+        [(control ? self.controlLane : self.dataLane) addObject:item];
+        if(!self.isWriting) {
+            self.isWriting = YES;
+            startWriter = YES;
         }
-        typeof(weakSelf) strongSelf = weakSelf;
-        uint64_t offset = 2; //how many bytes do we need to skip for the header
-        uint8_t *bytes = (uint8_t*)[data bytes];
-        uint64_t dataLength = data.length;
-        NSMutableData *frame = [[NSMutableData alloc] initWithLength:(NSInteger)(dataLength + RTCJFRMaxFrameSize)];
-        uint8_t *buffer = (uint8_t*)[frame mutableBytes];
-        buffer[0] = RTCJFRFinMask | code;
-        if(dataLength < 126) {
-            buffer[1] |= dataLength;
-        } else if(dataLength <= UINT16_MAX) {
-            buffer[1] |= 126;
-            *((uint16_t *)(buffer + offset)) = CFSwapInt16BigToHost((uint16_t)dataLength);
-            offset += sizeof(uint16_t);
-        } else {
-            buffer[1] |= 127;
-            *((uint64_t *)(buffer + offset)) = CFSwapInt64BigToHost((uint64_t)dataLength);
-            offset += sizeof(uint64_t);
+    }
+    if(startWriter) {
+        __weak typeof(self) weakSelf = self;
+        dispatch_async(self.writeQueue, ^{
+            [weakSelf drainWriteLanes];
+        });
+    }
+}
+/////////////////////////////////////////////////////////////////////////////
+//Picks the next frame to write. Real control frames (ping/pong/close) may go between the fragments
+//of a data message; control lane text frames have to wait for the current message to finish,
+//because data frames of different messages must never interleave.
+- (nullable RTCJFRWriteItem*)nextWriteItem {
+    RTCJFRWriteItem *current = self.dataLane.firstObject;
+    BOOL midMessage = (current && current.offset > 0);
+    for(RTCJFRWriteItem *item in self.controlLane) {
+        if(!midMessage || item.code >= RTCJFROpCodeConnectionClose) {
+            return item;
         }
-        BOOL isMask = YES;
-        if(isMask) {
-            buffer[1] |= RTCJFRMaskMask;
-            uint8_t *mask_key = (buffer + offset);
-            (void)SecRandomCopyBytes(kSecRandomDefault, sizeof(uint32_t), (uint8_t *)mask_key);
-            offset += sizeof(uint32_t);
-            
-            for (size_t i = 0; i < dataLength; i++) {
-                buffer[offset] = bytes[i] ^ mask_key[i % sizeof(uint32_t)];
-                offset += 1;
+    }
+    return current;
+}
+/////////////////////////////////////////////////////////////////////////////
+//only runs on the write queue
+- (void)drainWriteLanes {
+    while(true) {
+        RTCJFRWriteItem *item = nil;
+        BOOL control = NO;
+        @synchronized(self.dataLane) {
+            item = [self nextWriteItem];
+            if(!item) {
+                self.isWriting = NO;
+                return;
             }
-        } else {
-            for(size_t i = 0; i < dataLength; i++) {
-                buffer[offset] = bytes[i];
-                offset += 1;
+            control = ([self.controlLane indexOfObjectIdenticalTo:item] != NSNotFound);
+        }
+        
+        if(item.batch) {
+            if(self.isConnected) {
+                [self writeBuffer:[self encodeBatchItem:item]];
             }
+            @synchronized(self.dataLane) {
+                [self.dataLane removeObjectIdenticalTo:item];
+            }
+            [self updateBufferedAmount:item.batchLength added:NO];
+            continue;
         }
-        uint64_t total = 0;
-        while (true) {
-            if(!strongSelf.isConnected || !strongSelf.outputStream) {
-                break;
+        
+        //compress the whole message before it is fragmented, in write order so both sides keep the same context
+        if(item.offset == 0 && !item.compressed && [self shouldCompress:item]) {
+            [self compressWriteItem:item];
+        }
+        NSUInteger start = item.offset;
+        if(self.isConnected) {
+            [self writeBuffer:[self encodeNextFrameOfItem:item control:control]];
+        } else {
+            // the stream is gone, drop the rest of this message
+            item.offset = item.data.length;
+        }
+        NSUInteger length = item.offset - start;
+        
+        if(item.offset == item.data.length) {
+            @synchronized(self.dataLane) {
+                [(control ? self.controlLane : self.dataLane) removeObjectIdenticalTo:item];
             }
-            NSInteger len = [strongSelf.outputStream write:([frame bytes]+total) maxLength:(NSInteger)(offset-total)];
-            if(len < 0 || len == NSNotFound) {
-                NSError *error = strongSelf.outputStream.streamError;
-                if(!error) {
-                    error = [strongSelf errorWithDetail:@"output stream error during write" code:RTCJFROutputStreamWriteError];
-                }
-                [strongSelf doDisconnect:error];
-                break;
-            } else {
-                total += len;
+        }
+        [self updateBufferedAmount:length added:NO];
+    }
+}
+/////////////////////////////////////////////////////////////////////////////
+//only called on the write queue
+- (BOOL)shouldCompress:(RTCJFRWriteItem*)item {
+    return _deflaterReady && item.data.length >= self.compressionThreshold &&
+           (item.code == RTCJFROpCodeTextFrame || item.code == RTCJFROpCodeBinaryFrame);
+}
+/////////////////////////////////////////////////////////////////////////////
+//only called on the write queue. bufferedAmount follows the bytes that actually go on the wire.
+- (void)compressWriteItem:(RTCJFRWriteItem*)item {
+    NSData *compressed = [self deflateMessage:item.data];
+    if(!compressed) {
+        return;
+    }
+    NSUInteger length = item.data.length;
+    item.data = compressed;
+    item.compressed = YES;
+    if(compressed.length < length) {
+        [self updateBufferedAmount:length - compressed.length added:NO];
+    } else if(compressed.length > length) {
+        [self updateBufferedAmount:compressed.length - length added:YES];
+    }
+}
+/////////////////////////////////////////////////////////////////////////////
+//Compresses one message with the shared context and drops the 0x00 0x00 0xff 0xff tail of the sync flush
+//(RFC 7692 section 7.2.1). Returns nil if zlib fails, the message is then sent uncompressed. Only called on the write queue.
+- (nullable NSData*)deflateMessage:(NSData*)data {
+    NSMutableData *output = [NSMutableData new];
+    _deflater.next_in = (Bytef*)data.bytes;
+    _deflater.avail_in = (uInt)data.length;
+    int status = Z_OK;
+    do {
+        NSUInteger start = output.length;
+        NSUInteger chunk = MAX(RTCJFRCompressionChunkSize, MAX(start, data.length / 2));
+        [output increaseLengthBy:chunk];
+        _deflater.next_out = (Bytef*)output.mutableBytes + start;
+        _deflater.avail_out = (uInt)chunk;
+        status = deflate(&_deflater, Z_SYNC_FLUSH);
+        [output setLength:output.length - _deflater.avail_out];
+    } while(status == Z_OK && _deflater.avail_out == 0);
+    
+    //a fresh context is always safe for the reader, so a failed message just resets it
+    if((status != Z_OK && status != Z_BUF_ERROR) || _deflater.avail_in > 0) {
+        deflateReset(&_deflater);
+        return nil;
+    }
+    NSUInteger tailLength = sizeof(RTCJFRDeflateTail);
+    if(output.length >= tailLength &&
+       memcmp((const uint8_t*)output.bytes + output.length - tailLength, RTCJFRDeflateTail, tailLength) == 0) {
+        [output setLength:output.length - tailLength];
+    }
+    if(_deflateResetPerMessage) {
+        deflateReset(&_deflater);
+    }
+    return output;
+}
+/////////////////////////////////////////////////////////////////////////////
+- (NSUInteger)bufferedAmount {
+    return (NSUInteger)atomic_load_explicit(&_bufferedBytes, memory_order_relaxed);
+}
+/////////////////////////////////////////////////////////////////////////////
+- (void)updateBufferedAmount:(NSUInteger)length added:(BOOL)added {
+    unsigned long amount;
+    if(added) {
+        amount = atomic_fetch_add_explicit(&_bufferedBytes, length, memory_order_relaxed) + length;
+    } else {
+        amount = atomic_fetch_sub_explicit(&_bufferedBytes, length, memory_order_relaxed) - length;
+    }
+    id<RTCJFRWebSocketDelegate> delegate = self.delegate;
+    if([delegate respondsToSelector:@selector(websocket:didUpdateBufferedAmount:)]) {
+        [delegate websocket:self didUpdateBufferedAmount:(NSUInteger)amount];
+    }
+}
+/////////////////////////////////////////////////////////////////////////////
+//only called on the write queue. Encodes the next frame of the message and moves its offset past it.
+//Data messages longer than fragmentSize go out as a first frame and continuation frames.
+- (NSData*)encodeNextFrameOfItem:(RTCJFRWriteItem*)item control:(BOOL)control {
+    NSUInteger length = item.data.length - item.offset;
+    BOOL fragment = !control && self.fragmentSize > 0 && length > self.fragmentSize;
+    if(fragment) {
+        length = self.fragmentSize;
+    }
+    BOOL isFin = (item.offset + length == item.data.length);
+    RTCJFROpCode code = (item.offset == 0) ? item.code : RTCJFROpCodeContinueFrame;
+    
+    NSMutableData *frame = [[NSMutableData alloc] initWithCapacity:length + RTCJFRMaxFrameSize];
+    [self appendFrame:(const uint8_t*)item.data.bytes + item.offset length:length withCode:code isFin:isFin compressed:(item.compressed && item.offset == 0) toBuffer:frame];
+    item.offset += length;
+    return frame;
+}
+/////////////////////////////////////////////////////////////////////////////
+//only called on the write queue. Encodes every frame of the batch into one buffer so the whole
+//batch goes out in as few stream writes as the socket allows.
+- (NSData*)encodeBatchItem:(RTCJFRWriteItem*)item {
+    NSMutableData *buffer = [[NSMutableData alloc] initWithCapacity:item.batchLength + item.batch.count * RTCJFRMaxFrameSize];
+    for(RTCJFRWriteItem *frame in item.batch) {
+        NSData *data = frame.data;
+        BOOL compressed = NO;
+        if([self shouldCompress:frame]) {
+            NSData *deflated = [self deflateMessage:data];
+            if(deflated) {
+                data = deflated;
+                compressed = YES;
             }
-            if(total >= offset) {
-                break;
+        }
+        [self appendFrame:(const uint8_t*)data.bytes length:data.length withCode:frame.code isFin:YES compressed:compressed toBuffer:buffer];
+    }
+    return buffer;
+}
+/////////////////////////////////////////////////////////////////////////////
+//appends the header, mask and masked payload of one frame to the end of the buffer.
+//compressed sets RSV1, which belongs on the first frame of a compressed message only.
+- (void)appendFrame:(const uint8_t*)bytes length:(uint64_t)dataLength withCode:(RTCJFROpCode)code isFin:(BOOL)isFin compressed:(BOOL)compressed toBuffer:(NSMutableData*)frame {
+    NSUInteger start = frame.length;
+    uint64_t offset = 2; //how many bytes do we need to skip for the header
+    [frame increaseLengthBy:(NSUInteger)(dataLength + RTCJFRMaxFrameSize)];
+    uint8_t *buffer = (uint8_t*)[frame mutableBytes] + start;
+    buffer[0] = (isFin ? RTCJFRFinMask : 0) | (compressed ? RTCJFRRSV1Mask : 0) | code;
+    if(dataLength < 126) {
+        buffer[1] |= dataLength;
+    } else if(dataLength <= UINT16_MAX) {
+        buffer[1] |= 126;
+        *((uint16_t *)(buffer + offset)) = CFSwapInt16BigToHost((uint16_t)dataLength);
+        offset += sizeof(uint16_t);
+    } else {
+        buffer[1] |= 127;
+        *((uint64_t *)(buffer + offset)) = CFSwapInt64BigToHost((uint64_t)dataLength);
+        offset += sizeof(uint64_t);
+    }
+    BOOL isMask = YES;
+    if(isMask) {
+        buffer[1] |= RTCJFRMaskMask;
+        uint8_t *mask_key = (buffer + offset);
+        (void)SecRandomCopyBytes(kSecRandomDefault, sizeof(uint32_t), (uint8_t *)mask_key);
+        offset += sizeof(uint32_t);
+        
+        for (size_t i = 0; i < dataLength; i++) {
+            buffer[offset] = bytes[i] ^ mask_key[i % sizeof(uint32_t)];
+            offset += 1;
+        }
+    } else {
+        for(size_t i = 0; i < dataLength; i++) {
+            buffer[offset] = bytes[i];
+            offset += 1;
+        }
+    }
+    [frame setLength:start + (NSUInteger)offset];
+}
+/////////////////////////////////////////////////////////////////////////////
+//only called on the write queue
+- (void)writeBuffer:(NSData*)frame {
+    uint64_t offset = frame.length;
+    uint64_t total = 0;
+    while (true) {
+        if(!self.isConnected || !self.outputStream) {
+            break;
+        }
+        NSInteger len = [self.outputStream write:([frame bytes]+total) maxLength:(NSInteger)(offset-total)];
+        if(len < 0 || len == NSNotFound) {
+            NSError *error = self.outputStream.streamError;
+            if(!error) {
+                error = [self errorWithDetail:@"output stream error during write" code:RTCJFROutputStreamWriteError];
             }
+            [self doDisconnect:error];
+            break;
+        } else {
+            total += len;
+        }
+        if(total >= offset) {
+            break;
         }
-    }];
+    }
 }
 /////////////////////////////////////////////////////////////////////////////
 - (void)doDisconnect:(NSError*)error {
@@ -842,13 +1303,20 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
 - (void)writeError:(uint16_t)code {
     uint16_t buffer[1];
     buffer[0] = CFSwapInt16BigToHost(code);
-    [self dequeueWrite:[NSData dataWithBytes:buffer length:sizeof(uint16_t)] withCode:RTCJFROpCodeConnectionClose];
+    //close stays behind the queued data so a clean disconnect still flushes it
+    [self dequeueWrite:[NSData dataWithBytes:buffer length:sizeof(uint16_t)] withCode:RTCJFROpCodeConnectionClose control:NO];
 }
 /////////////////////////////////////////////////////////////////////////////
 - (void)dealloc {
     if(self.isConnected) {
         [self disconnect];
     }
+    if(_inflaterReady) {
+        inflateEnd(&_inflater);
+    }
+    if(_deflaterReady) {
+        deflateEnd(&_deflater);
+    }
 }
 /////////////////////////////////////////////////////////////////////////////
 @end
@@ -859,3 +1327,8 @@ static const size_t  RTCJFRMaxFrameSize        = 32;
 
 @end
 /////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+@implementation RTCJFRWriteItem
+
+@end
+/////////////////////////////////////////////////////////////////////////////